@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+// =============================================================
+// BENCH
+// Utilitários compartilhados pelos benchmarks de host: relógio monotônico,
+// execução repetida até um tempo mínimo e impressão do relatório num formato
+// estável (uma linha por medição) para facilitar comparações entre commits.
+// =============================================================
+
+#define BENCH_MIN_NS 200000000ull
+
+typedef void (*BenchFunction)(void* context);
+
+// valor usado pelos benchmarks para impedir que o compilador descarte o
+// trabalho medido
+static volatile uint64_t bench_sink;
+
+static inline uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+// executa function até que pelo menos min_ns tenham passado e retorna o tempo
+// médio por chamada em nanossegundos
+static inline double bench_run(BenchFunction function, void* context, uint64_t min_ns) {
+  uint64_t iterations = 0;
+  uint64_t batch = 1;
+  uint64_t start = bench_now_ns();
+  uint64_t elapsed = 0;
+
+  while (elapsed < min_ns) {
+    for (uint64_t i = 0; i < batch; i++) {
+      function(context);
+    }
+
+    iterations += batch;
+    batch *= 2;
+    elapsed = bench_now_ns() - start;
+  }
+
+  return (double) elapsed / (double) iterations;
+}
+
+// melhor (menor) tempo por chamada em runs execuções de bench_run, o que deixa
+// o relatório menos sensível a ruído do sistema
+static inline double bench_best_of(BenchFunction function, void* context, int runs, uint64_t min_ns) {
+  double best = bench_run(function, context, min_ns);
+
+  for (int i = 1; i < runs; i++) {
+    double ns = bench_run(function, context, min_ns);
+    best = ns < best ? ns : best;
+  }
+
+  return best;
+}
+
+static inline void bench_report_header(const char* title) {
+  printf("# %s\n", title);
+  printf("%-36s %12s %14s %14s\n", "case", "size", "ns/op", "bytes");
+}
+
+// bytes é a memória usada pelo caso medido, 0 quando não se aplica
+static inline void bench_report(const char* name, const char* size, double ns_per_op, size_t bytes) {
+  if (bytes == 0) {
+    printf("%-36s %12s %14.1f %14s\n", name, size, ns_per_op, "-");
+  } else {
+    printf("%-36s %12s %14.1f %14zu\n", name, size, ns_per_op, bytes);
+  }
+}
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "host_hal.h"
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/melody.h"
+#include "../inc/audio.h"
+
+// =============================================================
+// BENCH AUDIO
+// O sequenciador de src/audio.c contra o jeito antigo de tocar a mordida,
+// que segurava o core0 com sleep_ms até o fim de cada nota. Mede o tempo
+// que cada um tira do core0 por som pedido (no relógio manual do host, em
+// µs de jogo, e em ns de host para o novo).
+//
+// Depois confere, com o relógio manual e o registro de escritas no PWM do
+// HAL de host, que o buzzer é reprogramado exatamente no instante de cada
+// nota, com o wrap e o nível de tone_on: uma música atrás da outra, a
+// mordida interrompendo a melodia de derrota (que volta para o que faltava
+// da nota), efeitos na fila e um efeito cortando outro. E que a tabela
+// gerada por tools/gen_melodies.py toca as notas afinadas com o clk_sys do
+// host.
+// =============================================================
+
+#define RUNS 5
+#define MAX_WRITES 96
+
+// o play_bite de antes do sequenciador
+static void blocking_play_bite(uint pin) {
+  tone_on(pin, NOTE_G4);
+  sleep_ms(50);
+  tone_off(pin);
+}
+
+static void call_play_bite(void* context) {
+  (void) context;
+  play_bite(BUZZER_PIN);
+}
+
+typedef struct Expected {
+  HostPwmWrite writes[MAX_WRITES];
+  uint count;
+} Expected;
+
+static void expect_write(Expected* expected, uint64_t us, int channel, uint16_t value) {
+  expected->writes[expected->count++] = (HostPwmWrite) {
+    us, pwm_gpio_to_slice_num(BUZZER_PIN), channel, value,
+  };
+}
+
+// as escritas de tone_on: o divisor e o wrap da fatia, e o nível de 50%
+static void expect_tone(Expected* expected, uint64_t us, uint note) {
+  NotePwm pwm = note_pwm[note];
+  expect_write(expected, us, HOST_PWM_CLKDIV, (uint16_t) (pwm.div_int << 4 | pwm.div_frac));
+  expect_write(expected, us, HOST_PWM_WRAP, pwm.wrap);
+  expect_write(expected, us, (int) pwm_gpio_to_channel(BUZZER_PIN), (uint16_t) ((pwm.wrap + 1) / 2));
+}
+
+static void expect_off(Expected* expected, uint64_t us) {
+  expect_write(expected, us, (int) pwm_gpio_to_channel(BUZZER_PIN), 0);
+}
+
+// confere as escritas registradas desde start_us, e que o som acabou
+static bool writes_match(const char* name, const Expected* expected, uint64_t start_us) {
+  bool match = host_pwm_log_count() == expected->count && !audio_is_playing();
+
+  for (uint i = 0; i < expected->count && match; i++) {
+    HostPwmWrite write = host_pwm_log_get(i);
+    HostPwmWrite want = expected->writes[i];
+
+    if (write.us - start_us != want.us || write.slice != want.slice || write.channel != want.channel ||
+        write.value != want.value) {
+      printf("%s: write %u at %llu us, channel %i, value %u; expected %llu us, channel %i, value %u\n",
+          name, i, (unsigned long long) (write.us - start_us), write.channel, write.value,
+          (unsigned long long) want.us, want.channel, want.value);
+      match = false;
+    }
+  }
+
+  if (host_pwm_log_count() != expected->count) {
+    printf("%s: %u writes, expected %u\n", name, host_pwm_log_count(), expected->count);
+  }
+
+  return match;
+}
+
+// frequência que o PWM toca com a entrada da tabela
+static double played_hz(uint note) {
+  NotePwm pwm = note_pwm[note];
+  return clock_get_hz(clk_sys) * 16.0 / ((pwm.div_int * 16 + pwm.div_frac) * (pwm.wrap + 1.0));
+}
+
+static bool in_tune(uint note, double hz) {
+  return fabs(1200 * log2(played_hz(note) / hz)) < 1;
+}
+
+// A4 e C4 a menos de 1 cent da afinação, e uma oitava dobrando a frequência
+static bool table_in_tune(void) {
+  return MELODY_SYS_CLOCK_HZ == clock_get_hz(clk_sys) && in_tune(NOTE_A4, 440) && in_tune(NOTE_C4, 261.626) &&
+      in_tune(NOTE_C5, 2 * played_hz(NOTE_C4)) && in_tune(NOTE_G5, 2 * played_hz(NOTE_G4));
+}
+
+static uint64_t scenario_start(void) {
+  audio_stop();
+  host_pwm_log_clear();
+  return time_us_64();
+}
+
+// duas músicas na fila tocam uma depois da outra, sem silêncio no meio
+static bool music_queued(void) {
+  Expected expected = { .count = 0 };
+  uint64_t start = scenario_start();
+  MelodyStep first[] = { MELODY_STEP(NOTE_C5, 30), MELODY_STEP(NOTE_D5, 30) };
+  MelodyStep second[] = { MELODY_STEP(NOTE_G5, 30) };
+
+  play_melody(BUZZER_PIN, first, count_of(first));
+  host_clock_advance_us(100000);
+  play_melody(BUZZER_PIN, second, count_of(second));
+  host_clock_advance_us(1000000);
+
+  expect_tone(&expected, 0, NOTE_C5);
+  expect_tone(&expected, 300000, NOTE_D5);
+  expect_tone(&expected, 600000, NOTE_G5);
+  expect_off(&expected, 900000);
+
+  return writes_match("music queued", &expected, start);
+}
+
+// a mordida no meio do G4 da derrota: o G4 volta pelos 150 ms que faltavam
+static bool bite_over_music(void) {
+  Expected expected = { .count = 0 };
+  uint64_t start = scenario_start();
+
+  play_game_over(BUZZER_PIN);
+  host_clock_advance_us(450000);
+  play_bite(BUZZER_PIN);
+  host_clock_advance_us(2000000);
+
+  expect_tone(&expected, 0, NOTE_A4);
+  expect_tone(&expected, 300000, NOTE_G4);
+  expect_tone(&expected, 450000, NOTE_G4);
+  expect_tone(&expected, 500000, NOTE_G4);
+  expect_tone(&expected, 650000, NOTE_F4);
+  expect_tone(&expected, 1050000, NOTE_E4);
+  expect_off(&expected, 1650000);
+
+  return writes_match("bite over music", &expected, start);
+}
+
+// efeitos pedidos com AUDIO_QUEUE tocam em sequência
+static bool effects_queued(void) {
+  Expected expected = { .count = 0 };
+  uint64_t start = scenario_start();
+  MelodyStep bite[] = { MELODY_STEP(NOTE_G4, 5) };
+  MelodyStep move[] = { MELODY_STEP(NOTE_Cs4, 5) };
+
+  audio_play(BUZZER_PIN, AUDIO_EFFECTS, bite, count_of(bite), AUDIO_QUEUE);
+  audio_play(BUZZER_PIN, AUDIO_EFFECTS, move, count_of(move), AUDIO_QUEUE);
+  host_clock_advance_us(200000);
+
+  expect_tone(&expected, 0, NOTE_G4);
+  expect_tone(&expected, 50000, NOTE_Cs4);
+  expect_off(&expected, 100000);
+
+  return writes_match("effects queued", &expected, start);
+}
+
+// um efeito novo corta o anterior na hora
+static bool effect_over_effect(void) {
+  Expected expected = { .count = 0 };
+  uint64_t start = scenario_start();
+
+  play_bite(BUZZER_PIN);
+  host_clock_advance_us(20000);
+  play_selection_move(BUZZER_PIN);
+  host_clock_advance_us(200000);
+
+  expect_tone(&expected, 0, NOTE_G4);
+  expect_tone(&expected, 20000, NOTE_Cs4);
+  expect_off(&expected, 70000);
+
+  return writes_match("effect over effect", &expected, start);
+}
+
+int main() {
+  pwm_init_buzzer(BUZZER_PIN);
+
+  double play_ns = bench_best_of(call_play_bite, NULL, RUNS, BENCH_MIN_NS);
+  audio_stop();
+
+  host_clock_set_manual(true);
+
+  uint64_t start = time_us_64();
+  blocking_play_bite(BUZZER_PIN);
+  uint64_t blocking_us = time_us_64() - start;
+
+  start = time_us_64();
+  play_bite(BUZZER_PIN);
+  uint64_t sequenced_us = time_us_64() - start;
+  audio_stop();
+
+  printf("# core0 time per bite\n");
+  printf("%-36s %12s %14s\n", "path", "game us", "host ns");
+  printf("%-36s %12llu %14s\n", "tone_on + sleep_ms + tone_off", (unsigned long long) blocking_us, "-");
+  printf("%-36s %12llu %14.1f\n", "audio_play (alarm sequencer)", (unsigned long long) sequenced_us, play_ns);
+
+  // o formato antigo guardava { frequência, ms } em dois uint
+  printf("%-36s %12zu B\n", "melody step, uint[2]", 2 * sizeof(uint));
+  printf("%-36s %12zu B\n", "melody step, packed", sizeof(MelodyStep));
+  printf("%-36s %12.2f Hz\n", "bite (G4) plays", played_hz(NOTE_G4));
+
+  bool tuned = table_in_tune();
+  bool queued = music_queued();
+  bool preempted = bite_over_music();
+  bool effects = effects_queued();
+  bool cut = effect_over_effect();
+
+  printf("note table is in tune for clk_sys: %s\n", tuned ? "yes" : "no");
+  printf("queued music plays back to back: %s\n", queued ? "yes" : "no");
+  printf("bite pauses the music, which resumes the interrupted note: %s\n", preempted ? "yes" : "no");
+  printf("queued effects play in order: %s\n", effects ? "yes" : "no");
+  printf("a new effect cuts the previous one: %s\n", cut ? "yes" : "no");
+
+  bool returns = sequenced_us == 0;
+  printf("play_bite returns without waiting for the note: %s\n", returns ? "yes" : "no");
+
+  return tuned && queued && preempted && effects && cut && returns ? EXIT_SUCCESS : EXIT_FAILURE;
+}
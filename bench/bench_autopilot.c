@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/game_engine.h"
+#include "../inc/autopilot.h"
+
+// =============================================================
+// BENCH AUTOPILOT
+// Joga jogos inteiros com o piloto automático em vários tamanhos de canvas e
+// mede o tempo de cada decisão (médio, p99 e máximo, que é o que precisa caber
+// no tick) e a taxa de solução (jogos que terminam com o canvas cheio).
+// =============================================================
+
+// um jogo que não termina em 100 ticks por célula é contado como não resolvido
+#define MAX_TICKS_PER_CELL 100
+
+// histograma dos tempos de decisão, em faixas de 100 ns até 1 ms (o que passa
+// disso cai na última faixa)
+#define HISTOGRAM_BUCKET_NS 100
+#define HISTOGRAM_BUCKETS 10000
+
+static unsigned long histogram[HISTOGRAM_BUCKETS];
+
+static double histogram_percentile_us(unsigned long count, double percentile) {
+  unsigned long wanted = (unsigned long) (count * percentile);
+  unsigned long seen = 0;
+
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    seen += histogram[i];
+
+    if (seen > wanted) {
+      return (i + 1) * HISTOGRAM_BUCKET_NS / 1e3;
+    }
+  }
+
+  return HISTOGRAM_BUCKETS * HISTOGRAM_BUCKET_NS / 1e3;
+}
+
+typedef struct AutopilotCase {
+  int size;
+  int games;
+} AutopilotCase;
+
+int main() {
+  AutopilotCase cases[] = {
+    { 5, 2000 },
+    { 8, 500 },
+    { 16, 50 },
+    { 32, 5 },
+  };
+
+  printf("# autopilot (games played to the end, seeds 1..games)\n");
+  printf("%-8s %7s %8s %9s %12s %9s %9s %28s\n", "size", "games", "solved", "length", "us/decision", "p99 us", "max us", "food/tail/cycle/area/stuck %");
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    int n = cases[i].size;
+    int cells = n * n;
+    GameState* state = game_state_init(n, n, 1);
+    Autopilot* autopilot = autopilot_init(n, n);
+    unsigned long wins = 0;
+    unsigned long long lengths = 0;
+    uint64_t total_ns = 0, max_ns = 0;
+    memset(histogram, 0, sizeof(histogram));
+
+    for (int game = 1; game <= cases[i].games; game++) {
+      game_state_reset(state, game);
+
+      while (!state->over && state->ticks < (unsigned long) MAX_TICKS_PER_CELL * cells) {
+        uint64_t start = bench_now_ns();
+        Direction direction = autopilot_decide(autopilot, state);
+        uint64_t elapsed = bench_now_ns() - start;
+
+        total_ns += elapsed;
+        max_ns = elapsed > max_ns ? elapsed : max_ns;
+        histogram[elapsed / HISTOGRAM_BUCKET_NS < HISTOGRAM_BUCKETS ? elapsed / HISTOGRAM_BUCKET_NS : HISTOGRAM_BUCKETS - 1]++;
+
+        game_step(state, (GameInput) { .direction = direction });
+      }
+
+      wins += state->won;
+      lengths += state->snake->size;
+    }
+
+    AutopilotStats* stats = &autopilot->stats;
+    double decisions = (double) stats->decisions;
+    char label[32], strategies[64];
+    snprintf(label, sizeof(label), "%ix%i", n, n);
+    snprintf(strategies, sizeof(strategies), "%.1f/%.1f/%.1f/%.1f/%.1f",
+        100.0 * stats->food_paths / decisions, 100.0 * stats->tail_paths / decisions,
+        100.0 * stats->cycle_moves / decisions, 100.0 * stats->area_moves / decisions,
+        100.0 * stats->stuck / decisions);
+
+    printf("%-8s %7i %7.1f%% %8.1f%% %12.2f %9.1f %9.1f %28s\n", label, cases[i].games,
+        100.0 * wins / cases[i].games, 100.0 * lengths / ((double) cases[i].games * cells),
+        total_ns / decisions / 1e3, histogram_percentile_us(stats->decisions, 0.99), max_ns / 1e3, strategies);
+
+    autopilot_free(autopilot);
+    game_state_free(state);
+  }
+
+  return 0;
+}
@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/canvas.h"
+
+// =============================================================
+// BENCH CANVAS
+// Compara o layout atual das células (um bloco contíguo de um byte por
+// célula) com o layout anterior (um calloc de ints por linha atrás de um
+// int**), e as consultas de posições livres por varredura completa (como eram
+// feitas antes) com o conjunto de células livres mantido pelo canvas.
+// =============================================================
+
+#if defined(CANVAS_BACKEND_BITBOARD)
+#error "bench_canvas measures the matrix backend internals, build it with CANVAS_BACKEND=matrix"
+#endif
+
+typedef struct LegacyMatrix {
+  int rows;
+  int cols;
+  int** data;
+} LegacyMatrix;
+
+typedef struct BenchContext {
+  Canvas* canvas;
+  LegacyMatrix* legacy;
+  Position* positions;
+} BenchContext;
+
+static LegacyMatrix* legacy_init(int rows, int cols) {
+  LegacyMatrix* matrix = malloc(sizeof(LegacyMatrix));
+  matrix->rows = rows;
+  matrix->cols = cols;
+  matrix->data = malloc(sizeof(int*) * rows);
+
+  for (int i = 0; i < rows; i++) {
+    matrix->data[i] = calloc(cols, sizeof(int));
+  }
+
+  return matrix;
+}
+
+static void legacy_free(LegacyMatrix* matrix) {
+  for (int i = 0; i < matrix->rows; i++) {
+    free(matrix->data[i]);
+  }
+
+  free(matrix->data);
+  free(matrix);
+}
+
+static size_t legacy_bytes(LegacyMatrix* matrix) {
+  return sizeof(LegacyMatrix) + matrix->rows * sizeof(int*) + (size_t) matrix->rows * matrix->cols * sizeof(int);
+}
+
+static size_t matrix_bytes(Matrix* matrix) {
+  return sizeof(Matrix) + matrix_size(matrix) * sizeof(MatrixDataType);
+}
+
+static size_t canvas_bytes(Canvas* canvas) {
+  return sizeof(Canvas) + matrix_bytes(canvas->cells) + 2 * matrix_size(canvas->cells) * sizeof(int);
+}
+
+// ocupa uma a cada sete células, para que as contagens não sejam triviais
+static void fill_pattern(BenchContext* context) {
+  Canvas* canvas = context->canvas;
+
+  for (int row = 0; row < canvas->rows; row++) {
+    for (int col = 0; col < canvas->cols; col++) {
+      int cell = (row * canvas->cols + col) % 7 == 0 ? CELL_SNAKE_BODY : CELL_UNUSED;
+      canvas_put(canvas, cell, (int [2]){ row, col });
+      context->legacy->data[row][col] = cell;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// layout das células
+// ---------------------------------------------------------------------------
+
+static void bench_legacy_clear(void* context) {
+  LegacyMatrix* matrix = ((BenchContext*) context)->legacy;
+
+  for (int row = 0; row < matrix->rows; row++) {
+    for (int col = 0; col < matrix->cols; col++) {
+      matrix->data[row][col] = CELL_UNUSED;
+    }
+  }
+}
+
+static void bench_matrix_clear(void* context) {
+  matrix_fill(((BenchContext*) context)->canvas->cells, CELL_UNUSED);
+}
+
+static void bench_legacy_count(void* context) {
+  LegacyMatrix* matrix = ((BenchContext*) context)->legacy;
+  int count = 0;
+
+  for (int row = 0; row < matrix->rows; row++) {
+    for (int col = 0; col < matrix->cols; col++) {
+      if (matrix->data[row][col] == CELL_UNUSED) {
+        count++;
+      }
+    }
+  }
+
+  bench_sink += count;
+}
+
+// contagem linear sobre as células contíguas, em blocos com acumulador de um
+// byte para que o compilador possa vetorizar
+static int matrix_count_unused(Matrix* matrix) {
+  int count = 0;
+  size_t size = matrix_size(matrix);
+  const MatrixDataType* cells = matrix->data;
+  size_t i = 0;
+
+  for (; i + 64 <= size; i += 64) {
+    uint8_t block_count = 0;
+
+    for (int j = 0; j < 64; j++) {
+      block_count += cells[i + j] == CELL_UNUSED;
+    }
+
+    count += block_count;
+  }
+
+  for (; i < size; i++) {
+    count += cells[i] == CELL_UNUSED;
+  }
+
+  return count;
+}
+
+static void bench_matrix_count(void* context) {
+  bench_sink += matrix_count_unused(((BenchContext*) context)->canvas->cells);
+}
+
+// a varredura completa coleta as posições livres num buffer já alocado
+static void bench_legacy_scan(void* context) {
+  LegacyMatrix* matrix = ((BenchContext*) context)->legacy;
+  Position* positions = ((BenchContext*) context)->positions;
+  size_t size = 0;
+
+  for (int row = 0; row < matrix->rows; row++) {
+    for (int col = 0; col < matrix->cols; col++) {
+      if (matrix->data[row][col] == CELL_UNUSED) {
+        positions[size][0] = row;
+        positions[size][1] = col;
+        size++;
+      }
+    }
+  }
+
+  bench_sink += size;
+}
+
+static void bench_matrix_scan(void* context) {
+  Matrix* matrix = ((BenchContext*) context)->canvas->cells;
+  Position* positions = ((BenchContext*) context)->positions;
+  size_t size = 0;
+
+  for (int row = 0; row < matrix->rows; row++) {
+    const MatrixDataType* cells = &matrix->data[matrix_index(matrix, row, 0)];
+
+    for (int col = 0; col < matrix->cols; col++) {
+      if (cells[col] == CELL_UNUSED) {
+        positions[size][0] = row;
+        positions[size][1] = col;
+        size++;
+      }
+    }
+  }
+
+  bench_sink += size;
+}
+
+// ---------------------------------------------------------------------------
+// consultas de posições livres
+// ---------------------------------------------------------------------------
+
+// sorteio como era feito antes do conjunto de células livres: varre o canvas
+// inteiro realocando o resultado a cada célula livre encontrada
+static void bench_scan_random_free(void* context) {
+  Matrix* matrix = ((BenchContext*) context)->canvas->cells;
+  size_t size = 0;
+  Position* positions = NULL;
+
+  for (int row = 0; row < matrix->rows; row++) {
+    for (int col = 0; col < matrix->cols; col++) {
+      if (matrix->data[matrix_index(matrix, row, col)] == CELL_UNUSED) {
+        size++;
+        positions = realloc(positions, size * sizeof(Position));
+        copy_position((int [2]){ row, col }, positions[size - 1]);
+      }
+    }
+  }
+
+  int index = randint(0, (int) size - 1);
+  bench_sink += positions[index][0] + positions[index][1];
+  free(positions);
+}
+
+static void bench_indexed_random_free(void* context) {
+  Position position;
+  canvas_get_random_free_position(((BenchContext*) context)->canvas, position);
+  bench_sink += position[0] + position[1];
+}
+
+static void bench_indexed_count(void* context) {
+  bench_sink += canvas_count_free_positions(((BenchContext*) context)->canvas);
+}
+
+// ocupa e libera uma mesma célula, o custo de manter o conjunto atualizado
+static void bench_indexed_put(void* context) {
+  Canvas* canvas = ((BenchContext*) context)->canvas;
+  canvas_put(canvas, CELL_FOOD, (int [2]){ 1, 1 });
+  canvas_put(canvas, CELL_UNUSED, (int [2]){ 1, 1 });
+}
+
+int main() {
+  int sizes[] = { 5, 64, 256, 1024 };
+
+  bench_report_header("canvas cells: legacy int** rows vs contiguous uint8_t");
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    int n = sizes[i];
+    char label[32];
+    snprintf(label, sizeof(label), "%ix%i", n, n);
+
+    BenchContext context = {
+      .canvas = canvas_init(n, n),
+      .legacy = legacy_init(n, n),
+      .positions = malloc(sizeof(Position) * n * n),
+    };
+
+    size_t legacy_size = legacy_bytes(context.legacy);
+    size_t matrix_size = matrix_bytes(context.canvas->cells);
+
+    bench_report("clear/legacy", label, bench_run(bench_legacy_clear, &context, BENCH_MIN_NS), legacy_size);
+    bench_report("clear/contiguous", label, bench_run(bench_matrix_clear, &context, BENCH_MIN_NS), matrix_size);
+
+    canvas_clear(context.canvas);
+    fill_pattern(&context);
+
+    bench_report("count_free/legacy", label, bench_run(bench_legacy_count, &context, BENCH_MIN_NS), legacy_size);
+    bench_report("count_free/contiguous", label, bench_run(bench_matrix_count, &context, BENCH_MIN_NS), matrix_size);
+    bench_report("scan/legacy", label, bench_run(bench_legacy_scan, &context, BENCH_MIN_NS), legacy_size);
+    bench_report("scan/contiguous", label, bench_run(bench_matrix_scan, &context, BENCH_MIN_NS), matrix_size);
+
+    free(context.positions);
+    legacy_free(context.legacy);
+    canvas_free(context.canvas);
+  }
+
+  printf("\n");
+  bench_report_header("free positions: full scan vs free-cell set");
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    int n = sizes[i];
+    char label[32];
+    snprintf(label, sizeof(label), "%ix%i", n, n);
+
+    BenchContext context = {
+      .canvas = canvas_init(n, n),
+      .legacy = legacy_init(1, 1),
+    };
+
+    for (int row = 0; row < n; row++) {
+      for (int col = 0; col < n; col++) {
+        if ((row * n + col) % 7 == 0) {
+          canvas_put(context.canvas, CELL_SNAKE_BODY, (int [2]){ row, col });
+        }
+      }
+    }
+
+    size_t matrix_size = matrix_bytes(context.canvas->cells);
+    size_t canvas_size = canvas_bytes(context.canvas);
+
+    bench_report("random_free/scan", label, bench_run(bench_scan_random_free, &context, BENCH_MIN_NS), matrix_size);
+    bench_report("random_free/indexed", label, bench_run(bench_indexed_random_free, &context, BENCH_MIN_NS), canvas_size);
+    bench_report("count_free/scan", label, bench_run(bench_matrix_count, &context, BENCH_MIN_NS), matrix_size);
+    bench_report("count_free/indexed", label, bench_run(bench_indexed_count, &context, BENCH_MIN_NS), canvas_size);
+    bench_report("put/indexed", label, bench_run(bench_indexed_put, &context, BENCH_MIN_NS), canvas_size);
+
+    legacy_free(context.legacy);
+    canvas_free(context.canvas);
+  }
+
+  return 0;
+}
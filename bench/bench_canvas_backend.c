@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/canvas.h"
+
+// =============================================================
+// BENCH CANVAS BACKEND
+// Mede a API pública do canvas (canvas_get, canvas_put, contagem e sorteio
+// de posições livres, canvas_clear) usando apenas as funções do header, para
+// que o mesmo programa possa ser compilado com cada backend
+// (CANVAS_BACKEND=matrix ou bitboard) e os relatórios comparados lado a lado.
+// =============================================================
+
+typedef struct BenchContext {
+  Canvas* canvas;
+  int cursor;
+} BenchContext;
+
+static size_t canvas_bytes(Canvas* canvas) {
+#if defined(CANVAS_BACKEND_BITBOARD)
+  return sizeof(Canvas) + (size_t) (CANVAS_PLANES + 1) * canvas->words * sizeof(uint64_t);
+#else
+  size_t size = (size_t) canvas->rows * canvas->cols;
+  return sizeof(Canvas) + sizeof(Matrix) + size * sizeof(CanvasCell) + 2 * size * sizeof(int);
+#endif
+}
+
+// ocupa cerca de metade do canvas com corpo de cobra, alguns obstáculos e uma
+// comida, como num jogo avançado
+static void fill_pattern(Canvas* canvas) {
+  canvas_clear(canvas);
+
+  for (int row = 0; row < canvas->rows; row++) {
+    for (int col = 0; col < canvas->cols; col++) {
+      int index = row * canvas->cols + col;
+      int cell = CELL_UNUSED;
+
+      if (index % 2 == 0) {
+        cell = CELL_SNAKE_BODY;
+      } else if (index % 11 == 0) {
+        cell = CELL_OBSTACLE;
+      }
+
+      canvas_put(canvas, cell, (int [2]){ row, col });
+    }
+  }
+
+  canvas_put(canvas, CELL_SNAKE_HEAD, (int [2]){ 0, 0 });
+  canvas_put(canvas, CELL_FOOD, (int [2]){ canvas->rows - 1, canvas->cols - 1 });
+}
+
+// avança um cursor pelas células, para que get e put não repitam sempre a
+// mesma posição
+static void next_position(BenchContext* context, Position position) {
+  Canvas* canvas = context->canvas;
+  context->cursor = (context->cursor + 7919) % (canvas->rows * canvas->cols);
+  position[0] = context->cursor / canvas->cols;
+  position[1] = context->cursor % canvas->cols;
+}
+
+static void bench_get(void* context) {
+  Position position;
+  next_position(context, position);
+  bench_sink += canvas_get(((BenchContext*) context)->canvas, position);
+}
+
+static void bench_put(void* context) {
+  Canvas* canvas = ((BenchContext*) context)->canvas;
+  Position position;
+  next_position(context, position);
+  CanvasCell cell = canvas_get(canvas, position);
+  canvas_put(canvas, CELL_FOOD, position);
+  canvas_put(canvas, cell, position);
+}
+
+static void bench_count_free(void* context) {
+  bench_sink += canvas_count_free_positions(((BenchContext*) context)->canvas);
+}
+
+static void bench_random_free(void* context) {
+  Position position;
+  canvas_get_random_free_position(((BenchContext*) context)->canvas, position);
+  bench_sink += position[0] + position[1];
+}
+
+static void bench_clear(void* context) {
+  canvas_clear(((BenchContext*) context)->canvas);
+}
+
+int main() {
+  int sizes[] = { 5, 32, 256 };
+  char title[64];
+
+  snprintf(title, sizeof(title), "canvas backend: %s", CANVAS_BACKEND);
+  bench_report_header(title);
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    int n = sizes[i];
+    char label[32];
+    snprintf(label, sizeof(label), "%ix%i", n, n);
+
+    BenchContext context = { .canvas = canvas_init(n, n) };
+    size_t bytes = canvas_bytes(context.canvas);
+
+    fill_pattern(context.canvas);
+
+    bench_report("get", label, bench_run(bench_get, &context, BENCH_MIN_NS), bytes);
+    bench_report("put", label, bench_run(bench_put, &context, BENCH_MIN_NS), bytes);
+    bench_report("count_free", label, bench_run(bench_count_free, &context, BENCH_MIN_NS), bytes);
+    bench_report("random_free", label, bench_run(bench_random_free, &context, BENCH_MIN_NS), bytes);
+    bench_report("clear", label, bench_run(bench_clear, &context, BENCH_MIN_NS), bytes);
+
+    canvas_free(context.canvas);
+  }
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/random.h"
+#include "../inc/game_engine.h"
+#include "../inc/snake_env.h"
+
+// =============================================================
+// BENCH ENV
+// Vazão do ambiente vetorizado (src/snake_env.c) com 1, 64 e 4096 ambientes
+// e ações aleatórias, em passos de ambiente por segundo, só com step e com
+// step mais a exportação das observações. Antes, confere que o ambiente joga
+// exatamente os mesmos jogos que game_step com o backend bitboard.
+// =============================================================
+
+#define ACTION_VECTORS 16
+#define CHECK_ENVS 64
+#define CHECK_STEPS 20000
+#define CHECK_SEED 1000
+
+typedef struct EnvContext {
+  SnakeEnv* env;
+  uint8_t* actions;
+  float* rewards;
+  uint8_t* dones;
+  uint64_t* planes;
+  int count;
+  int cursor;
+} EnvContext;
+
+static void bench_step(void* context) {
+  EnvContext* c = context;
+  c->cursor = (c->cursor + 1) % ACTION_VECTORS;
+  snake_env_step(c->env, c->actions + (size_t) c->cursor * c->count, c->rewards, c->dones);
+}
+
+static void bench_step_observe(void* context) {
+  EnvContext* c = context;
+  bench_step(context);
+  snake_env_observe(c->env, c->planes);
+}
+
+static int find_bit(const uint64_t* plane, int words) {
+  for (int w = 0; w < words; w++) {
+    if (plane[w] != 0) {
+      return w * 64 + __builtin_ctzll(plane[w]);
+    }
+  }
+
+  return -1;
+}
+
+// joga CHECK_ENVS jogos lado a lado no ambiente e em GameStates, com as
+// mesmas ações, e compara cabeça, comida, tamanho e fim a cada passo
+static bool matches_game_step(int n) {
+  SnakeEnv* env = snake_env_create(CHECK_ENVS, n, n);
+  int words = snake_env_plane_words(env);
+  uint64_t* planes = malloc(sizeof(uint64_t) * CHECK_ENVS * SNAKE_ENV_PLANES * words);
+  uint8_t actions[CHECK_ENVS], dones[CHECK_ENVS];
+  float rewards[CHECK_ENVS];
+  GameState* games[CHECK_ENVS];
+  Random random;
+  bool matches = true;
+
+  random_seed(&random, 7);
+  snake_env_reset(env, CHECK_SEED);
+
+  for (int i = 0; i < CHECK_ENVS; i++) {
+    games[i] = game_state_init(n, n, CHECK_SEED + i);
+  }
+
+  for (int step = 0; step < CHECK_STEPS && matches; step++) {
+    for (int i = 0; i < CHECK_ENVS; i++) {
+      actions[i] = (uint8_t) random_bounded(&random, SNAKE_ENV_ACTION_KEEP + 1);
+    }
+
+    snake_env_step(env, actions, rewards, dones);
+    snake_env_observe(env, planes);
+
+    for (int i = 0; i < CHECK_ENVS && matches; i++) {
+      Direction direction = actions[i] < SNAKE_ENV_ACTION_KEEP ? DIRECTION_NORTH + actions[i] : DIRECTION_NONE;
+      GameEvents events = game_step(games[i], (GameInput) { .direction = direction });
+
+      uint8_t expected = events & GAME_EVENT_LOST ? SNAKE_ENV_LOST : events & GAME_EVENT_WON ? SNAKE_ENV_WON : SNAKE_ENV_RUNNING;
+      matches = dones[i] == expected;
+
+      if (!matches || dones[i] != SNAKE_ENV_RUNNING) {
+        game_state_reset(games[i], snake_env_seeds(env)[i]);
+      }
+
+      uint64_t* env_planes = planes + (size_t) i * SNAKE_ENV_PLANES * words;
+      Position head;
+      snake_get_head_position(games[i]->snake, head);
+      Food* food = games[i]->food;
+
+      matches = matches &&
+          snake_env_lengths(env)[i] == games[i]->snake->size &&
+          find_bit(env_planes + SNAKE_ENV_PLANE_HEAD * words, words) == head[0] * n + head[1] &&
+          find_bit(env_planes + SNAKE_ENV_PLANE_FOOD * words, words) == (food->in_canvas ? food->position[0] * n + food->position[1] : -1);
+    }
+  }
+
+  for (int i = 0; i < CHECK_ENVS; i++) {
+    game_state_free(games[i]);
+  }
+
+  free(planes);
+  snake_env_destroy(env);
+
+  return matches;
+}
+
+int main() {
+  int counts[] = { 1, 64, 4096 };
+  int sizes[] = { 5, 16 };
+
+  bench_report_header("snake env (ns/op is per environment step, random actions)");
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    int n = sizes[s];
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+      int count = counts[i];
+      SnakeEnv* env = snake_env_create(count, n, n);
+      Random random;
+      random_seed(&random, 1);
+
+      EnvContext context = {
+        .env = env,
+        .actions = malloc((size_t) ACTION_VECTORS * count),
+        .rewards = malloc(sizeof(float) * count),
+        .dones = malloc(count),
+        .planes = malloc(sizeof(uint64_t) * count * SNAKE_ENV_PLANES * snake_env_plane_words(env)),
+        .count = count,
+      };
+
+      for (size_t a = 0; a < (size_t) ACTION_VECTORS * count; a++) {
+        context.actions[a] = (uint8_t) random_bounded(&random, SNAKE_ENV_ACTION_KEEP + 1);
+      }
+
+      snake_env_reset(env, 1);
+
+      char name[64], size[32];
+      snprintf(size, sizeof(size), "%ix%i", n, n);
+
+      double ns = bench_run(bench_step, &context, BENCH_MIN_NS) / count;
+      snprintf(name, sizeof(name), "step x%i (%.1fM steps/s)", count, 1e3 / ns);
+      bench_report(name, size, ns, 0);
+
+      ns = bench_run(bench_step_observe, &context, BENCH_MIN_NS) / count;
+      snprintf(name, sizeof(name), "step+observe x%i (%.1fM steps/s)", count, 1e3 / ns);
+      bench_report(name, size, ns, 0);
+
+      free(context.actions);
+      free(context.rewards);
+      free(context.dones);
+      free(context.planes);
+      snake_env_destroy(env);
+    }
+  }
+
+  bool matches = matches_game_step(5) && matches_game_step(8);
+  printf("matches game_step (bitboard backend): %s\n", matches ? "yes" : "no");
+
+  return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/game_engine.h"
+#include "../inc/random.h"
+
+// =============================================================
+// BENCH GAME STEP
+// Roda o motor de regras (game_step) sem nenhum hardware, o mais rápido
+// possível, para medir a vazão das regras. As entradas vêm de uma política
+// aleatória que evita colisões imediatas quando pode, para que os jogos não
+// acabem logo no começo. Quando um jogo acaba, outro começa no mesmo estado.
+// =============================================================
+
+#define STEPS_PER_CASE 5000000
+
+static const Direction directions[] = { DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST };
+
+// gerador da política, separado do gerador usado pelo jogo
+static Random policy_random;
+
+// escolhe uma direção aleatória entre as que não levam a uma colisão no
+// próximo passo (ou qualquer uma, se todas levarem)
+static Direction random_safe_direction(GameState* state) {
+  Snake* snake = state->snake;
+  Direction current = snake->direction;
+  int start = (int) random_bounded(&policy_random, 4);
+
+  for (int i = 0; i < 4; i++) {
+    Direction direction = directions[(start + i) % 4];
+
+    if (!game_direction_is_valid(state, direction)) {
+      continue;
+    }
+
+    snake->direction = direction;
+    bool collides = snake_next_move_collides(snake, state->canvas);
+    snake->direction = current;
+
+    if (!collides) {
+      return direction;
+    }
+  }
+
+  return current;
+}
+
+int main() {
+  int sizes[] = { 5, 16, 64 };
+
+  printf("# game_step throughput (random safe policy)\n");
+  printf("%-12s %14s %10s %10s %14s\n", "size", "steps", "games", "wins", "steps/s");
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    int n = sizes[i];
+    random_seed(&policy_random, 1);
+    GameState* state = game_state_init(n, n, 0);
+    unsigned long games = 0, wins = 0;
+
+    uint64_t start = bench_now_ns();
+
+    for (long step = 0; step < STEPS_PER_CASE; step++) {
+      GameEvents events = game_step(state, (GameInput) { .direction = random_safe_direction(state) });
+
+      if (events & (GAME_EVENT_LOST | GAME_EVENT_WON)) {
+        games++;
+        wins += (events & GAME_EVENT_WON) != 0;
+        game_state_reset(state, games);
+      }
+    }
+
+    double seconds = (bench_now_ns() - start) / 1e9;
+    char label[32];
+    snprintf(label, sizeof(label), "%ix%i", n, n);
+    printf("%-12s %14d %10lu %10lu %14.0f\n", label, STEPS_PER_CASE, games, wins, STEPS_PER_CASE / seconds);
+
+    game_state_free(state);
+  }
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/canvas.h"
+#include "../inc/snake.h"
+#include "../inc/food.h"
+#include "../inc/joystick.h"
+#include "../inc/menu_text.h"
+#include "../inc/game_engine.h"
+
+// =============================================================
+// BENCH HOT PATHS
+// Mede, no canvas 5x5 do jogo, cada função que roda a cada tick (ou a cada
+// poll de entrada) e imprime um relatório estável: sempre a mesma ordem e o
+// mesmo formato, com o melhor tempo de várias execuções, para ser comparado
+// entre commits.
+// =============================================================
+
+#define BOARD_ROWS 5
+#define BOARD_COLS 5
+#define RUNS 5
+#define RUN_MIN_NS 40000000ull
+
+typedef struct BenchContext {
+  GameState* game;
+  Matrix* matrix;
+  MenuText* menu_text;
+  int cursor;
+} BenchContext;
+
+static void next_position(BenchContext* context, Position position) {
+  context->cursor = (context->cursor + 1) % (BOARD_ROWS * BOARD_COLS);
+  position[0] = context->cursor / BOARD_COLS;
+  position[1] = context->cursor % BOARD_COLS;
+}
+
+// recomeça o jogo quando ele acaba, para que os passos continuem medindo um
+// jogo em andamento
+static void keep_playing(BenchContext* context) {
+  if (context->game->over) {
+    game_state_reset(context->game, context->game->seed + 1);
+  }
+}
+
+static void bench_matrix_get(void* context) {
+  Position position;
+  next_position(context, position);
+  bench_sink += matrix_get(((BenchContext*) context)->matrix, position);
+}
+
+static void bench_matrix_put(void* context) {
+  Position position;
+  next_position(context, position);
+  matrix_put(((BenchContext*) context)->matrix, position, CELL_FOOD);
+}
+
+static void bench_canvas_get(void* context) {
+  Position position;
+  next_position(context, position);
+  bench_sink += canvas_get(((BenchContext*) context)->game->canvas, position);
+}
+
+static void bench_canvas_put(void* context) {
+  Canvas* canvas = ((BenchContext*) context)->game->canvas;
+  Position position;
+  next_position(context, position);
+  CanvasCell cell = canvas_get(canvas, position);
+  canvas_put(canvas, cell, position);
+}
+
+static void bench_canvas_count_free_positions(void* context) {
+  bench_sink += canvas_count_free_positions(((BenchContext*) context)->game->canvas);
+}
+
+static void bench_canvas_get_random_free_position(void* context) {
+  Position position;
+  canvas_get_random_free_position(((BenchContext*) context)->game->canvas, position);
+  bench_sink += position[0];
+}
+
+static void bench_canvas_render(void* context) {
+  canvas_render(((BenchContext*) context)->game->canvas);
+}
+
+static void bench_snake_next_move_collides(void* context) {
+  GameState* game = ((BenchContext*) context)->game;
+  bench_sink += snake_next_move_collides(game->snake, game->canvas);
+}
+
+static void bench_snake_move(void* context) {
+  GameState* game = ((BenchContext*) context)->game;
+  snake_move(game->snake, game->canvas);
+  game->over = snake_self_collides(game->snake);
+  keep_playing(context);
+}
+
+static void bench_food_move(void* context) {
+  GameState* game = ((BenchContext*) context)->game;
+  food_move(game->food, game->canvas);
+}
+
+static void bench_game_step(void* context) {
+  GameState* game = ((BenchContext*) context)->game;
+  Direction direction = ((BenchContext*) context)->cursor++ % 3 == 0 ? DIRECTION_SOUTH : DIRECTION_EAST;
+  bench_sink += game_step(game, (GameInput) { .direction = direction });
+  keep_playing(context);
+}
+
+static void bench_joystick_get_info(void* context) {
+  bench_sink += joystick_get_info().direction;
+}
+
+static void bench_randint(void* context) {
+  bench_sink += randint(0, BOARD_ROWS * BOARD_COLS - 1);
+}
+
+static void bench_wrap(void* context) {
+  bench_sink += wrap(((BenchContext*) context)->cursor++ % 7 - 1, 0, 4);
+}
+
+static void bench_positions_collide(void* context) {
+  Position position;
+  next_position(context, position);
+  bench_sink += positions_collide(position, (int [2]){ 2, 2 });
+}
+
+static void bench_get_opposite_direction(void* context) {
+  bench_sink += get_opposite_direction(DIRECTION_NORTH + ((BenchContext*) context)->cursor++ % 4);
+}
+
+static void bench_menu_text_view_create(void* context) {
+  MenuTextView* view = menu_text_view_create(*((BenchContext*) context)->menu_text);
+  bench_sink += view->lines_size;
+  menu_text_view_free(view);
+}
+
+typedef struct BenchCase {
+  const char* name;
+  BenchFunction function;
+} BenchCase;
+
+static const BenchCase cases[] = {
+  { "matrix_get", bench_matrix_get },
+  { "matrix_put", bench_matrix_put },
+  { "canvas_get", bench_canvas_get },
+  { "canvas_put", bench_canvas_put },
+  { "canvas_count_free_positions", bench_canvas_count_free_positions },
+  { "canvas_get_random_free_position", bench_canvas_get_random_free_position },
+  { "canvas_render", bench_canvas_render },
+  { "snake_next_move_collides", bench_snake_next_move_collides },
+  { "snake_move", bench_snake_move },
+  { "food_move", bench_food_move },
+  { "game_step", bench_game_step },
+  { "joystick_get_info", bench_joystick_get_info },
+  { "randint", bench_randint },
+  { "wrap", bench_wrap },
+  { "positions_collide", bench_positions_collide },
+  { "get_opposite_direction", bench_get_opposite_direction },
+  { "menu_text_view_create", bench_menu_text_view_create },
+};
+
+int main() {
+  MenuOption* options = malloc(sizeof(MenuOption) * 2);
+  options[0] = (MenuOption) { .action = ACTION_RESTART, .label = "Play again", .selected = true };
+  options[1] = (MenuOption) { .action = ACTION_QUIT, .label = "Quit" };
+
+  BenchContext context = {
+    .game = game_state_init(BOARD_ROWS, BOARD_COLS, 0),
+    .matrix = matrix_init(BOARD_ROWS, BOARD_COLS),
+    .menu_text = menu_text_create(options, 2),
+  };
+
+  char size[32];
+  snprintf(size, sizeof(size), "%ix%i", BOARD_ROWS, BOARD_COLS);
+
+  char title[64];
+  snprintf(title, sizeof(title), "hot paths (canvas backend: %s, best of %i)", CANVAS_BACKEND, RUNS);
+  bench_report_header(title);
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    double ns = bench_best_of(cases[i].function, &context, RUNS, RUN_MIN_NS);
+    bench_report(cases[i].name, size, ns, 0);
+  }
+
+  menu_text_free(context.menu_text);
+  matrix_free(context.matrix);
+  game_state_free(context.game);
+
+  return 0;
+}
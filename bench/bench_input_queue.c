@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/joystick.h"
+#include "../inc/game_engine.h"
+#include "../inc/input_queue.h"
+
+// =============================================================
+// BENCH INPUT QUEUE
+// Um "cima e depois esquerda" feito dentro de um tick, com a cobra indo para
+// a direita, no loop antigo (uma direção por tick, lida pelo próprio loop e
+// validada contra a direção atual) e com a fila de direções enchida pelo
+// amostrador (src/input_queue.c), com o relógio manual do HAL de host e o
+// joystick movido pelos eixos do ADC. O gesto é feito uma vez com o loop
+// livre e outra com o loop ocupado tocando o som da mordida, quando o loop
+// antigo não lê nada. Mede também o custo de uma amostra na interrupção.
+// =============================================================
+
+// um tick mais curto que o atual, como os que queremos usar
+#define TICK_US 100000
+#define POLL_US 1000
+// o som da mordida (50 ms) mais a renderização, depois do tick
+#define BUSY_US 60000
+#define SIZE 8
+
+typedef struct Segment {
+  uint32_t us;
+  Direction direction;
+} Segment;
+
+// o gesto com o loop livre: cima por 20 ms e esquerda por 40 ms
+static const Segment quick_turn[] = {
+  { 30000, DIRECTION_NONE },
+  { 20000, DIRECTION_NORTH },
+  { 40000, DIRECTION_WEST },
+  { 10000, DIRECTION_NONE },
+};
+
+// o mesmo gesto, mais rápido, enquanto o loop toca o som da mordida
+static const Segment busy_turn[] = {
+  { 10000, DIRECTION_NONE },
+  { 15000, DIRECTION_NORTH },
+  { 20000, DIRECTION_WEST },
+  { 55000, DIRECTION_NONE },
+};
+
+static void set_joystick(Direction direction) {
+  uint16_t x = 2047, y = 2047;
+
+  switch (direction) {
+    case DIRECTION_NORTH: y = 4095; break;
+    case DIRECTION_SOUTH: y = 0; break;
+    case DIRECTION_EAST: x = 4095; break;
+    case DIRECTION_WEST: x = 0; break;
+  }
+
+  // o canal 0 é o eixo y e o 1 o eixo x
+  host_adc_set_value(0, y);
+  host_adc_set_value(1, x);
+}
+
+// loop antigo: lê o joystick a cada POLL_US quando não está ocupado e fica
+// com a última direção válida em relação à atual; devolve as direções da
+// cobra depois do tick do gesto e do tick seguinte
+static void old_loop(const Segment* segments, size_t count, uint32_t busy_us, Direction directions[2]) {
+  GameState* state = game_state_init(SIZE, SIZE, 1);
+  Direction new_direction = state->snake->direction;
+  uint32_t elapsed = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    set_joystick(segments[i].direction);
+
+    for (uint32_t t = 0; t < segments[i].us; t += POLL_US, elapsed += POLL_US) {
+      Direction direction = elapsed >= busy_us ? joystick_get_info().direction : DIRECTION_NONE;
+
+      if (game_direction_is_valid(state, direction)) {
+        new_direction = direction;
+      }
+
+      host_clock_advance_us(POLL_US);
+    }
+  }
+
+  game_step(state, (GameInput) { .direction = new_direction });
+  directions[0] = state->snake->direction;
+  game_step(state, (GameInput) { .direction = state->snake->direction });
+  directions[1] = state->snake->direction;
+
+  game_state_free(state);
+}
+
+// loop novo: o amostrador enche a fila durante o tick e o loop tira uma
+// direção em cada tick
+static void queued_loop(const Segment* segments, size_t count, Direction directions[2]) {
+  GameState* state = game_state_init(SIZE, SIZE, 1);
+  DirectionQueue queue;
+  InputSampler sampler;
+
+  direction_queue_reset(&queue, state->snake->direction);
+  input_sampler_start(&sampler, &queue, INPUT_SAMPLE_US);
+
+  for (size_t i = 0; i < count; i++) {
+    set_joystick(segments[i].direction);
+    host_clock_advance_us(segments[i].us);
+  }
+
+  for (int tick = 0; tick < 2; tick++) {
+    Direction direction = state->snake->direction;
+    direction_queue_pop(&queue, &direction);
+    game_step(state, (GameInput) { .direction = direction });
+    directions[tick] = state->snake->direction;
+  }
+
+  input_sampler_stop(&sampler);
+  game_state_free(state);
+}
+
+static const char* direction_name(Direction direction) {
+  switch (direction) {
+    case DIRECTION_NORTH: return "north";
+    case DIRECTION_EAST: return "east";
+    case DIRECTION_SOUTH: return "south";
+    case DIRECTION_WEST: return "west";
+  }
+
+  return "none";
+}
+
+// meia volta e repetição são recusadas, e a fila cheia descarta o excesso
+static bool queue_rules_hold(void) {
+  DirectionQueue queue;
+  direction_queue_reset(&queue, DIRECTION_EAST);
+
+  bool holds = !direction_queue_push(&queue, DIRECTION_EAST) &&
+      !direction_queue_push(&queue, DIRECTION_WEST) &&
+      !direction_queue_push(&queue, DIRECTION_NONE) &&
+      direction_queue_push(&queue, DIRECTION_NORTH) &&
+      !direction_queue_push(&queue, DIRECTION_NORTH) &&
+      !direction_queue_push(&queue, DIRECTION_SOUTH) &&
+      direction_queue_push(&queue, DIRECTION_WEST) &&
+      direction_queue_push(&queue, DIRECTION_SOUTH) &&
+      direction_queue_push(&queue, DIRECTION_EAST) &&
+      !direction_queue_push(&queue, DIRECTION_NORTH) &&
+      queue.dropped == 1;
+
+  Direction expected[] = { DIRECTION_NORTH, DIRECTION_WEST, DIRECTION_SOUTH, DIRECTION_EAST };
+  Direction direction;
+
+  for (int i = 0; i < 4; i++) {
+    holds = holds && direction_queue_pop(&queue, &direction) && direction == expected[i];
+  }
+
+  return holds && !direction_queue_pop(&queue, &direction) && direction_queue_is_empty(&queue);
+}
+
+typedef struct SampleContext {
+  DirectionQueue queue;
+  int flip;
+} SampleContext;
+
+// o que a interrupção do amostrador faz a cada amostra, com o joystick
+// mudando de direção a cada chamada
+static void bench_sample(void* context) {
+  SampleContext* c = context;
+  Direction direction;
+
+  c->flip ^= 1;
+  set_joystick(c->flip ? DIRECTION_NORTH : DIRECTION_EAST);
+  direction_queue_push(&c->queue, joystick_get_info().direction);
+  direction_queue_pop(&c->queue, &direction);
+  bench_sink += (uint64_t) direction;
+}
+
+int main() {
+  host_clock_set_manual(true);
+
+  struct {
+    const char* name;
+    const Segment* segments;
+    size_t count;
+    uint32_t busy_us;
+  } cases[] = {
+    { "loop free", quick_turn, count_of(quick_turn), 0 },
+    { "loop busy 60 ms", busy_turn, count_of(busy_turn), BUSY_US },
+  };
+
+  bool kept = true;
+
+  printf("# up then left within one %i ms tick, heading east\n", TICK_US / 1000);
+  printf("%-18s %-24s %-24s\n", "case", "old loop (tick 1/2)", "queue (tick 1/2)");
+
+  for (size_t i = 0; i < count_of(cases); i++) {
+    Direction old[2], queued[2];
+    old_loop(cases[i].segments, cases[i].count, cases[i].busy_us, old);
+    queued_loop(cases[i].segments, cases[i].count, queued);
+
+    char old_text[32], queued_text[32];
+    snprintf(old_text, sizeof(old_text), "%s/%s", direction_name(old[0]), direction_name(old[1]));
+    snprintf(queued_text, sizeof(queued_text), "%s/%s", direction_name(queued[0]), direction_name(queued[1]));
+    printf("%-18s %-24s %-24s\n", cases[i].name, old_text, queued_text);
+
+    kept = kept && queued[0] == DIRECTION_NORTH && queued[1] == DIRECTION_WEST;
+  }
+
+  host_clock_set_manual(false);
+
+  SampleContext context = { .flip = 0 };
+  direction_queue_reset(&context.queue, DIRECTION_EAST);
+
+  bench_report_header("input sampler");
+  bench_report("sample + push + pop", "joystick", bench_run(bench_sample, &context, BENCH_MIN_NS), 0);
+
+  bool rules = queue_rules_hold();
+  printf("both turns kept, one per tick: %s\n", kept ? "yes" : "no");
+  printf("reversals, repeats and overflow rejected: %s\n", rules ? "yes" : "no");
+
+  return kept && rules ? EXIT_SUCCESS : EXIT_FAILURE;
+}
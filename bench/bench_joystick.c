@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/random.h"
+#include "../inc/joystick.h"
+#include "../inc/joystick_filter.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLES 1
+#else
+#define HAVE_CYCLES 0
+#endif
+
+// =============================================================
+// BENCH JOYSTICK
+// A leitura antiga do joystick (joystick_get_info: duas conversões do ADC,
+// pow, sqrt e divisões em float) contra joystick_get_direction, que soma o
+// anel preenchido pelo DMA e passa a média pelo filtro, pela calibração e
+// pelo classificador (src/joystick_filter.c), com contas inteiras. Mede ns
+// e ciclos (o contador de tempo da CPU do host) por chamada; no RP2040, sem
+// FPU, cada operação em float é uma rotina de software, e a diferença é
+// maior que a do host.
+//
+// Depois confere que o classificador inteiro escolhe o mesmo que o antigo em
+// todas as 4096 x 4096 leituras possíveis, que o anel guarda cada eixo no
+// seu lugar e quantas vezes cada caminho troca de direção quando o joystick
+// passa devagar pelo limiar com ruído, lido a cada INPUT_SAMPLE_US como no
+// jogo.
+// =============================================================
+
+#define CALLS 2000000
+#define RUNS 5
+// o joystick vai do centro até o fim para a direita e volta em RAMP_US, com
+// ruído de até NOISE para cada lado em cada eixo, trocado a cada NOISE_US
+#define RAMP_US 2000000
+#define NOISE 200
+#define NOISE_US 250
+
+typedef struct Cost {
+  double ns;
+  double cycles;
+} Cost;
+
+static uint64_t cycles_now(void) {
+#if HAVE_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static void call_get_info(void) {
+  bench_sink += joystick_get_info().direction;
+}
+
+static void call_get_direction(void) {
+  bench_sink += joystick_get_direction();
+}
+
+static void call_classify(void) {
+  bench_sink += joystick_classify_hysteresis(DIRECTION_EAST, 3500, 2200);
+}
+
+static JoystickFilter bench_filter;
+static uint64_t bench_filter_us;
+
+static void call_filter(void) {
+  bench_filter_us += INPUT_SAMPLE_US;
+  bench_sink += joystick_filter_update(&bench_filter, 3500, 2200, bench_filter_us);
+}
+
+// melhor de RUNS execuções de CALLS chamadas
+static Cost measure(void (*function)(void)) {
+  Cost best = { 0, 0 };
+
+  for (int run = 0; run < RUNS; run++) {
+    uint64_t start_ns = bench_now_ns();
+    uint64_t start_cycles = cycles_now();
+
+    for (int i = 0; i < CALLS; i++) {
+      function();
+    }
+
+    Cost cost = {
+      (double) (bench_now_ns() - start_ns) / CALLS,
+      (double) (cycles_now() - start_cycles) / CALLS,
+    };
+
+    if (run == 0 || cost.ns < best.ns) {
+      best = cost;
+    }
+  }
+
+  return best;
+}
+
+static void report(const char* name, Cost cost) {
+  if (HAVE_CYCLES) {
+    printf("%-36s %12.1f %12.1f\n", name, cost.ns, cost.cycles);
+  } else {
+    printf("%-36s %12.1f %12s\n", name, cost.ns, "-");
+  }
+}
+
+// o classificador inteiro sem histerese contra joystick_get_info em todas as
+// leituras
+static bool classifiers_agree(void) {
+  for (uint y = 0; y <= JOYSTICK_MAX; y++) {
+    host_adc_set_value(0, (uint16_t) y);
+
+    for (uint x = 0; x <= JOYSTICK_MAX; x++) {
+      host_adc_set_value(1, (uint16_t) x);
+
+      if (joystick_get_info().direction != joystick_classify(x, y)) {
+        printf("x %u y %u: float %i, integer %i\n", x, y, joystick_get_info().direction, joystick_classify(x, y));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// com o amostrador rodando, a média do anel segue os dois eixos sem trocá-los
+static bool ring_follows_axes(void) {
+  uint16_t positions[][2] = { { 4095, 2047 }, { 2047, 4095 }, { 100, 3000 }, { 2047, 2047 } };
+  Direction expected[] = { DIRECTION_EAST, DIRECTION_NORTH, DIRECTION_WEST, DIRECTION_NONE };
+  bool follows = true;
+
+  joystick_sampler_start();
+
+  for (size_t i = 0; i < count_of(positions); i++) {
+    host_adc_set_value(1, positions[i][0]);
+    host_adc_set_value(0, positions[i][1]);
+    host_clock_advance_us(10000);
+
+    uint x, y;
+    joystick_read_raw(&x, &y);
+    follows = follows && x == positions[i][0] && y == positions[i][1] && joystick_get_direction() == expected[i];
+  }
+
+  joystick_sampler_stop();
+
+  // e, parado, o ADC volta a ser lido na hora
+  host_adc_set_value(1, 4095);
+  host_adc_set_value(0, 2047);
+
+  return follows && joystick_get_info().direction == DIRECTION_EAST;
+}
+
+typedef struct Sweep {
+  Random random;
+  uint64_t start_us;
+} Sweep;
+
+static bool sweep_alarm(repeating_timer_t* timer) {
+  Sweep* sweep = timer->user_data;
+  uint64_t t = time_us_64() - sweep->start_us;
+  uint64_t half = RAMP_US / 2;
+  int distance = (int) ((t < half ? t : RAMP_US - (t < RAMP_US ? t : RAMP_US)) * JOYSTICK_CENTER / half);
+  int x = JOYSTICK_CENTER + distance + (int) random_bounded(&sweep->random, 2 * NOISE + 1) - NOISE;
+  int y = JOYSTICK_CENTER + (int) random_bounded(&sweep->random, 2 * NOISE + 1) - NOISE;
+
+  host_adc_set_value(1, (uint16_t) (x < 0 ? 0 : x > JOYSTICK_MAX ? JOYSTICK_MAX : x));
+  host_adc_set_value(0, (uint16_t) (y < 0 ? 0 : y > JOYSTICK_MAX ? JOYSTICK_MAX : y));
+
+  return true;
+}
+
+// trocas de direção vistas lendo a cada INPUT_SAMPLE_US durante a rampa
+static int sweep_changes(bool sampler) {
+  Sweep sweep;
+  repeating_timer_t timer;
+  Direction last = DIRECTION_NONE;
+  int changes = 0;
+
+  random_seed(&sweep.random, 7);
+  sweep.start_us = time_us_64();
+  host_adc_set_value(0, JOYSTICK_CENTER);
+  host_adc_set_value(1, JOYSTICK_CENTER);
+  add_repeating_timer_us(-NOISE_US, sweep_alarm, &sweep, &timer);
+
+  if (sampler) {
+    joystick_sampler_start();
+  }
+
+  for (uint64_t t = 0; t < RAMP_US + 100000; t += INPUT_SAMPLE_US) {
+    host_clock_advance_us(INPUT_SAMPLE_US);
+    Direction direction = sampler ? joystick_get_direction() : joystick_get_info().direction;
+    changes += direction != last;
+    last = direction;
+  }
+
+  joystick_sampler_stop();
+  cancel_repeating_timer(&timer);
+
+  return changes;
+}
+
+int main() {
+  // uma leitura no meio da inclinação, sem trocar de direção entre chamadas
+  host_adc_set_value(0, 2200);
+  host_adc_set_value(1, 3500);
+
+  printf("# joystick read, best of %i x %i calls (host cycles from the time stamp counter)\n", RUNS, CALLS);
+  printf("%-36s %12s %12s\n", "path", "ns/op", "cycles/op");
+  report("float: joystick_get_info", measure(call_get_info));
+  report("integer: adc_read + filter", measure(call_get_direction));
+
+  host_clock_set_manual(true);
+  joystick_sampler_start();
+  host_clock_advance_us(10000);
+  report("integer: dma ring average + filter", measure(call_get_direction));
+  joystick_sampler_stop();
+
+  JoystickConfig config = JOYSTICK_CONFIG_DEFAULT;
+  joystick_filter_init(&bench_filter, &config);
+  report("integer: filter + classify only", measure(call_filter));
+  report("integer: classify only", measure(call_classify));
+
+  bool agree = classifiers_agree();
+  bool ring = ring_follows_axes();
+  int old_changes = sweep_changes(false);
+  int new_changes = sweep_changes(true);
+
+  printf("# direction changes while tilting east and back, noise +-%i\n", NOISE);
+  printf("%-36s %12i\n", "float, one reading", old_changes);
+  printf("%-36s %12i\n", "integer, ring average + filter", new_changes);
+
+  // entrar e sair uma vez
+  bool steady = new_changes == 2 && old_changes > new_changes;
+
+  printf("integer classifier matches joystick_get_info on every reading: %s\n", agree ? "yes" : "no");
+  printf("ring keeps y on even and x on odd samples: %s\n", ring ? "yes" : "no");
+  printf("one change in and one out with noise: %s\n", steady ? "yes" : "no");
+
+  return agree && ring && steady ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "../inc/constants.h"
+#include "../inc/random.h"
+#include "../inc/joystick.h"
+#include "../inc/melody.h"
+#include "../inc/game_engine.h"
+#include "../inc/autopilot.h"
+#include "../inc/scheduler.h"
+#include "../inc/latency.h"
+
+// =============================================================
+// BENCH LATENCY (só com -DSNAKE_LATENCY_PROBES=ON)
+// Reproduz o loop do jogo com o relógio manual do HAL de host: a cada tick o
+// "jogador" inclina o joystick para a direção que o piloto automático
+// escolheria, num instante sorteado dentro do tick, e o loop lê o joystick a
+// cada POLL_US até aplicar a mudança. Imprime os histogramas das sondas de
+// latência (os mesmos que o jogo imprime pela serial) lendo o joystick a cada
+// 10 ms, como o loop antigo, e a cada 50 us, perto da leitura contínua do
+// loop atual.
+// =============================================================
+
+#define TICKS 2000
+
+// inclina o joystick para a direção (ou o solta, com DIRECTION_NONE)
+static void tilt_joystick(Direction direction) {
+  host_adc_set_value(0, direction == DIRECTION_NORTH ? JOYSTICK_MAX : direction == DIRECTION_SOUTH ? 0 : JOYSTICK_CENTER);
+  host_adc_set_value(1, direction == DIRECTION_EAST ? JOYSTICK_MAX : direction == DIRECTION_WEST ? 0 : JOYSTICK_CENTER);
+}
+
+// joga TICKS ticks lendo o joystick a cada poll_us e imprime quanto tempo se
+// passou entre inclinar o joystick e o loop ler a direção nova, que as sondas
+// não enxergam (elas começam na leitura)
+static void play(uint32_t poll_us) {
+  GameState* state = game_state_init(5, 5, 1);
+  Autopilot* autopilot = autopilot_init(5, 5);
+  Random random;
+  TickScheduler scheduler;
+  uint64_t games = 1;
+  uint64_t polling_total_us = 0, polling_max_us = 0, polled = 0;
+
+  random_seed(&random, 1);
+  latency_reset();
+  tick_scheduler_start(&scheduler, GAME_TICK_US);
+
+  for (int tick = 0; tick < TICKS; tick++) {
+    Snake* snake = state->snake;
+    Direction wanted = autopilot_decide(autopilot, state);
+    uint64_t tilt_at = time_us_64() + random_bounded(&random, GAME_TICK_US);
+    Direction new_direction = snake->direction;
+    bool step_early = false;
+
+    tilt_joystick(DIRECTION_NONE);
+    joystick_get_info();
+
+    while (!tick_scheduler_take(&scheduler)) {
+      if (time_us_64() >= tilt_at) {
+        tilt_joystick(wanted);
+      }
+
+      Direction joystick_direction = joystick_get_info().direction;
+
+      if (joystick_direction != snake->direction && game_direction_is_valid(state, joystick_direction)) {
+        uint64_t polling_us = time_us_64() - tilt_at;
+        polling_total_us += polling_us;
+        polling_max_us = polling_us > polling_max_us ? polling_us : polling_max_us;
+        polled++;
+        new_direction = joystick_direction;
+        step_early = true;
+        break;
+      }
+
+      sleep_us(poll_us);
+    }
+
+    if (step_early) {
+      tick_scheduler_restart(&scheduler);
+    }
+
+    Direction previous_direction = snake->direction;
+    GameEvents events = game_step(state, (GameInput) { .direction = new_direction });
+
+    if (snake->direction != previous_direction) {
+      LATENCY_SPAN(LATENCY_INPUT_TO_TICK, LATENCY_MARK_INPUT);
+    } else {
+      LATENCY_CLEAR(LATENCY_MARK_INPUT);
+    }
+
+    LATENCY_MARK(LATENCY_MARK_TICK);
+
+    if (events & GAME_EVENT_ATE) {
+      play_bite(BUZZER_PIN);
+    }
+
+    canvas_render(state->canvas);
+
+    if (state->over) {
+      game_state_reset(state, ++games);
+    }
+  }
+
+  tick_scheduler_stop(&scheduler);
+  printf("tilt -> read (polling): mean %.0f us, max %llu us\n", (double) polling_total_us / polled, (unsigned long long) polling_max_us);
+  autopilot_free(autopilot);
+  game_state_free(state);
+}
+
+int main() {
+  host_clock_set_manual(true);
+
+  printf("# joystick read every 10 ms (old loop), %i ticks\n", TICKS);
+  play(10000);
+  latency_dump();
+
+  printf("# joystick read every 50 us (continuous), %i ticks\n", TICKS);
+  play(50);
+  latency_dump();
+
+  return 0;
+}
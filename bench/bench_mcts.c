@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/random.h"
+#include "../inc/game_engine.h"
+#include "../inc/mcts.h"
+
+// =============================================================
+// BENCH MCTS
+// Joga jogos inteiros com a busca em árvore de Monte Carlo (src/mcts.c), com
+// o tempo padrão de cada decisão no host, e com uma política gulosa (a
+// direção segura mais perto da comida) como referência. Mostra a taxa de
+// vitórias, o tamanho final médio e as simulações por segundo. Antes, confere
+// que com um limite de simulações no lugar do limite de tempo o mesmo jogo
+// sempre dá as mesmas decisões.
+// =============================================================
+
+// um jogo que não termina em 20 ticks por célula é contado como não resolvido
+#define MAX_TICKS_PER_CELL 20
+#define CHECK_ROLLOUTS 200
+
+typedef struct MctsCase {
+  int size;
+  int games;
+} MctsCase;
+
+typedef struct GameResults {
+  unsigned long wins;
+  unsigned long long lengths;
+  unsigned long long ticks;
+} GameResults;
+
+static const Direction directions[] = { DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST };
+
+static int wrapped_distance(int from, int to, int size) {
+  int distance = abs(from - to);
+  return distance < size - distance ? distance : size - distance;
+}
+
+// entre as direções que não colidem no próximo movimento, a que deixa a
+// cabeça mais perto da comida (a primeira, nos empates)
+static Direction greedy_direction(GameState* state) {
+  Canvas* canvas = state->canvas;
+  Snake* snake = state->snake;
+  Direction current = snake->direction;
+  Direction best = current;
+  int best_distance = -1;
+
+  for (int i = 0; i < 4; i++) {
+    Direction direction = directions[i];
+
+    if (!game_direction_is_valid(state, direction)) {
+      continue;
+    }
+
+    Position next;
+    snake->direction = direction;
+    bool collides = snake_next_move_collides(snake, canvas);
+    get_next_node_position(snake, canvas, 0, next);
+    snake->direction = current;
+
+    if (collides) {
+      continue;
+    }
+
+    int distance = !state->food->in_canvas ? 0 :
+        wrapped_distance(next[0], state->food->position[0], canvas->rows) +
+        wrapped_distance(next[1], state->food->position[1], canvas->cols);
+
+    if (best_distance < 0 || distance < best_distance) {
+      best = direction;
+      best_distance = distance;
+    }
+  }
+
+  return best;
+}
+
+// joga um jogo até o fim (ou até o limite de ticks) com a MCTS, ou com a
+// política gulosa se mcts for NULL
+static void play(GameState* state, Mcts* mcts, GameResults* results) {
+  unsigned long max_ticks = (unsigned long) MAX_TICKS_PER_CELL * state->canvas->rows * state->canvas->cols;
+
+  while (!state->over && state->ticks < max_ticks) {
+    Direction direction = mcts != NULL ? mcts_decide(mcts, state) : greedy_direction(state);
+    game_step(state, (GameInput) { .direction = direction });
+  }
+
+  results->wins += state->won;
+  results->lengths += state->snake->size;
+  results->ticks += state->ticks;
+}
+
+// joga o mesmo jogo duas vezes com a mesma semente da busca e um número fixo
+// de simulações, e compara as decisões
+static bool deterministic(int n) {
+  MctsConfig config = mcts_default_config(n, n);
+  config.budget_us = 0;
+  config.max_rollouts = CHECK_ROLLOUTS;
+  config.seed = 3;
+
+  Mcts* first = mcts_init(n, n, config);
+  Mcts* second = mcts_init(n, n, config);
+  GameState* a = game_state_init(n, n, 9);
+  GameState* b = game_state_init(n, n, 9);
+  bool same = true;
+
+  while (same && !a->over && a->ticks < 200) {
+    Direction direction = mcts_decide(first, a);
+    same = direction == mcts_decide(second, b);
+    game_step(a, (GameInput) { .direction = direction });
+    game_step(b, (GameInput) { .direction = direction });
+  }
+
+  mcts_free(first);
+  mcts_free(second);
+  game_state_free(a);
+  game_state_free(b);
+
+  return same;
+}
+
+int main() {
+  MctsCase cases[] = {
+    { 5, 40 },
+    { 8, 10 },
+  };
+
+  bool same = deterministic(5);
+
+  printf("# mcts vs greedy (games played to the end, seeds 1..games, %u us per decision)\n", (unsigned) MCTS_DEFAULT_BUDGET_US);
+  printf("%-8s %-8s %7s %8s %9s %12s %14s %10s\n", "size", "policy", "games", "wins", "length", "rollouts/s", "rollouts/move", "arena full");
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    int n = cases[i].size;
+    int games = cases[i].games;
+    double cells = n * n;
+    MctsConfig config = mcts_default_config(n, n);
+    config.seed = 1;
+    Mcts* mcts = mcts_init(n, n, config);
+    GameState* state = game_state_init(n, n, 1);
+    GameResults greedy = { 0 }, searched = { 0 };
+    char label[32];
+    snprintf(label, sizeof(label), "%ix%i", n, n);
+
+    for (int game = 1; game <= games; game++) {
+      game_state_reset(state, game);
+      play(state, NULL, &greedy);
+      game_state_reset(state, game);
+      play(state, mcts, &searched);
+    }
+
+    MctsStats* stats = &mcts->stats;
+
+    printf("%-8s %-8s %7i %7.1f%% %8.1f%% %12s %14s %10s\n", label, "greedy", games,
+        100.0 * greedy.wins / games, 100.0 * greedy.lengths / (games * cells), "-", "-", "-");
+    printf("%-8s %-8s %7i %7.1f%% %8.1f%% %12.0f %14.1f %9.1f%%\n", label, "mcts", games,
+        100.0 * searched.wins / games, 100.0 * searched.lengths / (games * cells),
+        stats->rollouts / (stats->elapsed_us / 1e6), (double) stats->rollouts / stats->decisions,
+        100.0 * stats->arena_full / stats->decisions);
+
+    game_state_free(state);
+    mcts_free(mcts);
+  }
+
+  printf("deterministic with a rollout limit: %s\n", same ? "yes" : "no");
+
+  return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "../inc/constants.h"
+#include "../inc/random.h"
+#include "../inc/joystick.h"
+#include "../inc/utils.h"
+#include "../inc/settings.h"
+#include "../inc/menu_text.h"
+#include "../inc/input_events.h"
+#include "../inc/display_oled/ssd1306.h"
+
+// =============================================================
+// BENCH MENU INPUT
+// O mesmo roteiro de entradas tocado no menu antigo (acorda a cada 50 ms,
+// lê o joystick a cada 150 ms e espera o botão ser solto olhando o pino a
+// cada 150 ms) e em wait_menu_text_choice, que dorme até um evento de
+// src/input_events.c, com o relógio manual do HAL de host. O roteiro deixa
+// o menu parado, faz TILTS toques curtos no joystick, para cima e para
+// baixo, e escolhe com o botão B.
+//
+// Mede quantas vezes o loop acorda por segundo com o menu parado e durante
+// a navegação, o tempo entre inclinar o joystick e o OLED terminar de ser
+// redesenhado (toques que o menu não vê contam como perdidos) e entre
+// soltar o botão e o menu retornar. O som da seleção fica mudo, para que a
+// medida seja só a da entrada.
+// =============================================================
+
+#define IDLE_SETTLE_US 5000000
+#define IDLE_US 30000000
+#define TILTS 40
+#define TILT_HOLD_US 120000
+#define TILT_GAP_MIN_US 400000
+#define TILT_GAP_SPREAD_US 500000
+#define BUTTON_HOLD_US 100000
+#define MAX_ACTIONS (2 * TILTS + 8)
+
+#define ACTION_MARK 0
+#define ACTION_TILT 1
+#define ACTION_BUTTON 2
+
+typedef struct ScriptAction {
+  uint64_t at_us;
+  int kind;
+  // direção do joystick ou nível do botão B (true solto)
+  int value;
+} ScriptAction;
+
+typedef struct ScriptResult {
+  uint32_t marks[2];
+  uint64_t mark_us[2];
+  uint64_t tilt_us;
+  uint64_t latency_total_us;
+  uint64_t latency_max_us;
+  int redraws;
+  int missed;
+  uint64_t release_us;
+} ScriptResult;
+
+static ScriptAction script[MAX_ACTIONS];
+static int script_length;
+static int script_next;
+static ScriptResult result;
+static repeating_timer_t script_timer;
+
+// contador de vezes que o loop acordou no modelo em uso
+static uint32_t* wakeups;
+static uint32_t old_wakeups;
+
+static void build_script(uint64_t start) {
+  Random random;
+  random_seed(&random, 3);
+  uint64_t at = start + IDLE_SETTLE_US;
+  int n = 0;
+
+  script[n++] = (ScriptAction) { at, ACTION_MARK, 0 };
+  at += IDLE_US;
+  script[n++] = (ScriptAction) { at, ACTION_MARK, 1 };
+
+  for (int i = 0; i < TILTS; i++) {
+    at += TILT_GAP_MIN_US + random_bounded(&random, TILT_GAP_SPREAD_US);
+    script[n++] = (ScriptAction) { at, ACTION_TILT, i % 3 == 2 ? DIRECTION_NORTH : DIRECTION_SOUTH };
+    at += TILT_HOLD_US;
+    script[n++] = (ScriptAction) { at, ACTION_TILT, DIRECTION_NONE };
+  }
+
+  at += TILT_GAP_MIN_US + random_bounded(&random, TILT_GAP_SPREAD_US);
+  script[n++] = (ScriptAction) { at, ACTION_BUTTON, false };
+  at += BUTTON_HOLD_US;
+  script[n++] = (ScriptAction) { at, ACTION_BUTTON, true };
+
+  script_length = n;
+}
+
+static void set_joystick(Direction direction) {
+  host_adc_set_value(0, direction == DIRECTION_NORTH ? 4095 : direction == DIRECTION_SOUTH ? 0 : 2047);
+  host_adc_set_value(1, 2047);
+}
+
+static void apply(const ScriptAction* action) {
+  switch (action->kind) {
+    case ACTION_MARK: {
+      result.marks[action->value] = *wakeups;
+      result.mark_us[action->value] = action->at_us;
+      break;
+    } case ACTION_TILT: {
+      if (action->value != DIRECTION_NONE) {
+        result.tilt_us = action->at_us;
+      } else {
+        // o redesenho desse toque, se houve, terminou antes de o soltar
+        uint64_t redraw = host_i2c_last_write_us();
+
+        if (redraw >= result.tilt_us) {
+          uint64_t latency = redraw - result.tilt_us;
+          result.latency_total_us += latency;
+          result.latency_max_us = latency > result.latency_max_us ? latency : result.latency_max_us;
+          result.redraws++;
+        } else {
+          result.missed++;
+        }
+      }
+
+      set_joystick(action->value);
+      break;
+    } case ACTION_BUTTON: {
+      host_gpio_set_input(BUTTON_B, action->value);
+
+      if (action->value) {
+        result.release_us = action->at_us;
+      }
+
+      break;
+    }
+  }
+}
+
+// aplica as ações vencidas e arma o timer para a próxima
+static bool script_alarm(repeating_timer_t* timer) {
+  uint64_t now = time_us_64();
+
+  while (script_next < script_length && script[script_next].at_us <= now) {
+    apply(&script[script_next++]);
+  }
+
+  if (script_next == script_length) {
+    return false;
+  }
+
+  timer->delay_us = (int64_t) (script[script_next].at_us - now);
+  return true;
+}
+
+static void start_script(void) {
+  result = (ScriptResult) { 0 };
+  script_next = 0;
+  build_script(time_us_64());
+  add_repeating_timer_us((int64_t) (script[0].at_us - time_us_64()), script_alarm, NULL, &script_timer);
+}
+
+// o menu de antes desta mudança, com um contador de vezes que acorda
+static uint old_wait_menu_text_choice(MenuText* menu_text, uint8_t* ssd, RenderArea render_area) {
+  int joystick_wait = 150;
+  int button_wait = 50;
+
+  display_menu_text(*menu_text, ssd, render_area);
+
+  for (int i = 0; true; i = (i + 1) * button_wait >= joystick_wait ? 0 : i + 1) {
+    if ((i + 1) * button_wait >= joystick_wait) {
+      Direction joystick_direction = joystick_get_info().direction;
+
+      if (joystick_direction == DIRECTION_SOUTH || joystick_direction == DIRECTION_NORTH) {
+        if (joystick_direction == DIRECTION_SOUTH) {
+          menu_text_move_selection_down(menu_text);
+        } else {
+          menu_text_move_selection_up(menu_text);
+        }
+
+        display_menu_text(*menu_text, ssd, render_area);
+      }
+    }
+
+    if (is_button_down(BUTTON_B)) {
+      uint selected_action = menu_text_get_selected_option(*menu_text).action;
+
+      while (is_button_down(BUTTON_B)) {
+        sleep_ms(150);
+        old_wakeups++;
+      }
+
+      return selected_action;
+    }
+
+    sleep_ms(button_wait);
+    old_wakeups++;
+  }
+}
+
+static MenuText* create_menu(void) {
+  MenuOption* options = malloc(sizeof(MenuOption) * 3);
+  options[0] = (MenuOption) { .action = ACTION_START, .label = "Play", .selected = true };
+  options[1] = (MenuOption) { .action = ACTION_SETTINGS, .label = "Settings" };
+  options[2] = (MenuOption) { .action = ACTION_QUIT, .label = "Quit" };
+
+  return menu_text_create(options, 3);
+}
+
+// desde o início das navegações até o fim do roteiro
+static double active_seconds(void) {
+  return (script[script_length - 1].at_us - result.mark_us[1]) / 1e6;
+}
+
+static void print_result(const char* name, uint32_t idle_wakeups, uint32_t active_wakeups, uint64_t return_us, uint action) {
+  double idle_s = (result.mark_us[1] - result.mark_us[0]) / 1e6;
+
+  printf("%-24s %10.1f %12.1f %12.1f %12.1f %8i %12.1f %8u\n", name,
+      idle_wakeups / idle_s, active_wakeups / active_seconds(),
+      result.redraws > 0 ? result.latency_total_us / (double) result.redraws / 1e3 : 0.0,
+      result.latency_max_us / 1e3, result.missed, return_us / 1e3, action);
+}
+
+int main() {
+  host_clock_set_manual(true);
+  game_settings_get()->sound.sound_effects.mute = true;
+
+  gpio_init(BUTTON_B);
+  input_events_init();
+
+  RenderArea area = ssd1306_init();
+  uint8_t ssd[ssd1306_buffer_length];
+
+  printf("# menu input, %i short joystick tilts and a button press (manual clock)\n", TILTS);
+  printf("%-24s %10s %12s %12s %12s %8s %12s %8s\n", "menu", "idle wk/s", "active wk/s", "redraw ms", "max ms", "missed", "return ms", "action");
+
+  MenuText* menu = create_menu();
+  wakeups = &old_wakeups;
+  start_script();
+  uint action = old_wait_menu_text_choice(menu, ssd, area);
+  uint64_t return_us = time_us_64() - result.release_us;
+  uint32_t active = old_wakeups - result.marks[1];
+  print_result("polling (50/150 ms)", result.marks[1] - result.marks[0], active, return_us, action);
+  ScriptResult old_result = result;
+  uint old_action = action;
+  menu_text_free(menu);
+
+  menu = create_menu();
+  input_stats = (InputStats) { 0 };
+  wakeups = &input_stats.wakeups;
+  start_script();
+  action = wait_menu_text_choice(menu, ssd, area);
+  return_us = time_us_64() - result.release_us;
+  active = input_stats.wakeups - result.marks[1];
+  print_result("events + wfe", result.marks[1] - result.marks[0], active, return_us, action);
+  menu_text_free(menu);
+
+  printf("input events: %u, bounces %u, dropped %u\n", (unsigned) input_stats.events, (unsigned) input_stats.bounces, (unsigned) input_stats.dropped);
+
+  // a escolha esperada se todos os toques forem vistos
+  MenuText* expected = create_menu();
+
+  for (int i = 0; i < script_length; i++) {
+    if (script[i].kind == ACTION_TILT && script[i].value == DIRECTION_SOUTH) {
+      menu_text_move_selection_down(expected);
+    } else if (script[i].kind == ACTION_TILT && script[i].value == DIRECTION_NORTH) {
+      menu_text_move_selection_up(expected);
+    }
+  }
+
+  uint expected_action = menu_text_get_selected_option(*expected).action;
+  menu_text_free(expected);
+
+  bool none_missed = result.missed == 0 && result.redraws == TILTS;
+  bool right_choice = action == expected_action;
+  bool fewer_idle = result.marks[1] - result.marks[0] < old_result.marks[1] - old_result.marks[0];
+
+  printf("every tilt redrawn: %s\n", none_missed ? "yes" : "no");
+  printf("choice matches every tilt applied: %s (polling menu: %s)\n", right_choice ? "yes" : "no", old_action == expected_action ? "yes" : "no");
+  printf("fewer idle wakeups: %s\n", fewer_idle ? "yes" : "no");
+
+  return none_missed && right_choice && fewer_idle ? EXIT_SUCCESS : EXIT_FAILURE;
+}
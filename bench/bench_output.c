@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/pwm.h"
+#include "host_hal.h"
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/melody.h"
+#include "../inc/neopixel.h"
+#include "../inc/game_engine.h"
+#include "../inc/display_oled/ssd1306.h"
+#include "../inc/output.h"
+
+// =============================================================
+// BENCH OUTPUT
+// O core de saída (src/output.c) no host, onde cada core é uma thread.
+// Primeiro a fila sozinha: o core0 publica STRESS_COMMANDS comandos
+// numerados, com o conteúdo derivado do número, e o core1 confere que todos
+// chegam em ordem e inteiros. Depois o que o core0 gasta por tick para
+// renderizar a matriz, enviar o OLED e tocar o som da mordida (que vai para
+// o sequenciador de src/audio.c, no core0), escrevendo na hora e pelo core
+// de saída, e se tudo chega aos periféricos.
+// =============================================================
+
+#define STRESS_COMMANDS 2000000
+#define TICKS 20
+#define TICK_US 100000
+
+static OutputQueue stress_queue;
+static uint32_t stress_received;
+static uint32_t stress_errors;
+
+static uint8_t stress_byte(uint32_t sequence, int index) {
+  return (uint8_t) (sequence * 31 + (uint32_t) index * 7);
+}
+
+static void stress_consumer(void) {
+  while (true) {
+    OutputCommand* command = output_queue_peek(&stress_queue);
+
+    if (command == NULL) {
+      tight_loop_contents();
+      continue;
+    }
+
+    if (command->type == OUTPUT_STOP) {
+      output_queue_release(&stress_queue);
+      return;
+    }
+
+    uint32_t sequence;
+    memcpy(&sequence, command->oled_buffer, sizeof(sequence));
+    bool intact = sequence == stress_received && command->length == (uint16_t) sequence;
+
+    for (int i = sizeof(sequence); i < 64 && intact; i++) {
+      intact = command->oled_buffer[i] == stress_byte(sequence, i);
+    }
+
+    stress_errors += !intact;
+    stress_received++;
+    output_queue_release(&stress_queue);
+  }
+}
+
+static OutputCommand* stress_reserve(void) {
+  OutputCommand* command;
+
+  while ((command = output_queue_reserve(&stress_queue)) == NULL) {
+    tight_loop_contents();
+  }
+
+  return command;
+}
+
+// ns por comando publicado e consumido
+static double stress_queue_ns(void) {
+  output_queue_init(&stress_queue);
+  multicore_launch_core1(stress_consumer);
+
+  uint64_t start = bench_now_ns();
+
+  for (uint32_t sequence = 0; sequence < STRESS_COMMANDS; sequence++) {
+    OutputCommand* command = stress_reserve();
+    command->type = OUTPUT_OLED_BUFFER;
+    command->length = (uint16_t) sequence;
+    memcpy(command->oled_buffer, &sequence, sizeof(sequence));
+
+    for (int i = sizeof(sequence); i < 64; i++) {
+      command->oled_buffer[i] = stress_byte(sequence, i);
+    }
+
+    output_queue_publish(&stress_queue);
+  }
+
+  stress_reserve()->type = OUTPUT_STOP;
+  output_queue_publish(&stress_queue);
+  multicore_reset_core1();
+
+  return (double) (bench_now_ns() - start) / STRESS_COMMANDS;
+}
+
+typedef struct TickCost {
+  double mean_us;
+  double max_us;
+} TickCost;
+
+// o trabalho de saída de TICKS ticks com mordida, um a cada TICK_US, medido
+// no core0
+static TickCost tick_cost(GameState* state, uint8_t* ssd, RenderArea area) {
+  TickCost cost = { 0, 0 };
+  uint64_t next = time_us_64();
+
+  for (int tick = 0; tick < TICKS; tick++) {
+    uint64_t start = bench_now_ns();
+
+    play_bite(BUZZER_PIN);
+    canvas_render(state->canvas);
+    render_on_display(ssd, &area);
+
+    double us = (bench_now_ns() - start) / 1e3;
+    cost.mean_us += us / TICKS;
+    cost.max_us = us > cost.max_us ? us : cost.max_us;
+
+    next += TICK_US;
+    uint64_t now = time_us_64();
+
+    if (next > now) {
+      sleep_us(next - now);
+    }
+  }
+
+  return cost;
+}
+
+int main() {
+  double queue_ns = stress_queue_ns();
+  bool ordered = stress_received == STRESS_COMMANDS && stress_errors == 0;
+
+  bench_report_header("output queue (core0 -> core1 threads)");
+  bench_report("publish + consume", "64 B", queue_ns, 0);
+
+  npInit(LED_PIN);
+  pwm_init_buzzer(BUZZER_PIN);
+
+  GameState* state = game_state_init(5, 5, 1);
+  RenderArea area = ssd1306_init();
+  uint8_t ssd[ssd1306_buffer_length];
+  memset(ssd, 0x55, sizeof(ssd));
+
+  TickCost inline_cost = tick_cost(state, ssd, area);
+
+  output_start();
+  uint64_t pio_before = host_pio_words_written();
+  uint64_t i2c_before = host_i2c_bytes_written();
+  TickCost core1_cost = tick_cost(state, ssd, area);
+  output_flush();
+  uint64_t pio_words = host_pio_words_written() - pio_before;
+  uint64_t i2c_bytes = host_i2c_bytes_written() - i2c_before;
+
+  // a última mordida acaba 50 ms depois de publicada
+  sleep_ms(100);
+  uint slice = pwm_gpio_to_slice_num(BUZZER_PIN);
+  bool silent = host_pwm_get_slice(slice).level[pwm_gpio_to_channel(BUZZER_PIN)] == 0;
+  output_stop();
+
+  printf("# core0 time per tick (bite + leds + oled), %i ticks\n", TICKS);
+  printf("%-24s %12s %12s\n", "outputs", "mean us", "max us");
+  printf("%-24s %12.1f %12.1f\n", "written on core0", inline_cost.mean_us, inline_cost.max_us);
+  printf("%-24s %12.1f %12.1f\n", "posted to core1", core1_cost.mean_us, core1_cost.max_us);
+
+  // por tick: 3 palavras por LED, e 6 comandos de 2 bytes mais o buffer com
+  // o byte de controle no OLED
+  bool delivered = pio_words == (uint64_t) TICKS * LED_COUNT * 3 &&
+      i2c_bytes == (uint64_t) TICKS * (6 * 2 + area.buffer_length + 1);
+
+  printf("commands arrive in order and intact: %s\n", ordered ? "yes" : "no");
+  printf("every frame reaches the devices after output_flush: %s\n", delivered ? "yes" : "no");
+  printf("buzzer silent after the last melody: %s\n", silent ? "yes" : "no");
+
+  game_state_free(state);
+
+  return ordered && delivered && silent ? EXIT_SUCCESS : EXIT_FAILURE;
+}
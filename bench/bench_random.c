@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/random.h"
+#include "../inc/game_engine.h"
+
+// =============================================================
+// BENCH RANDOM
+// Vazão do gerador (sorteios por segundo) comparada ao rand() % n com
+// srand(time(NULL)) a cada chamada, como o randint antigo fazia, e uma
+// verificação de reprodutibilidade: a mesma semente com as mesmas jogadas
+// deve produzir a mesma sequência de comidas.
+// =============================================================
+
+#define BOUND 25
+#define REPLAY_STEPS 2000
+#define REPLAY_FOODS 64
+
+static const Direction directions[] = { DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST };
+
+static void bench_random_next(void* context) {
+  bench_sink += random_next(context);
+}
+
+static void bench_random_bounded(void* context) {
+  bench_sink += random_bounded(context, BOUND);
+}
+
+static void bench_random_range(void* context) {
+  bench_sink += random_range(context, 0, BOUND - 1);
+}
+
+static void bench_randint(void* context) {
+  bench_sink += randint(0, BOUND - 1);
+}
+
+static void bench_legacy_rand(void* context) {
+  srand(time(NULL));
+  bench_sink += rand() % BOUND;
+}
+
+// joga com uma política aleatória que desvia de colisões, com semente própria
+// e fixa, e guarda as posições das comidas na ordem em que aparecem (recomeça
+// com a semente seguinte quando o jogo acaba); retorna quantas foram guardadas
+static int record_foods(uint64_t seed, Position foods[REPLAY_FOODS]) {
+  GameState* state = game_state_init(5, 5, seed);
+  Random policy;
+  random_seed(&policy, 7);
+  int count = 0;
+
+  copy_position(state->food->position, foods[count++]);
+
+  for (int step = 0; step < REPLAY_STEPS && count < REPLAY_FOODS; step++) {
+    Snake* snake = state->snake;
+    Direction current = snake->direction;
+    Direction direction = current;
+    int start = (int) random_bounded(&policy, 4);
+
+    for (int i = 0; i < 4; i++) {
+      Direction candidate = directions[(start + i) % 4];
+
+      if (!game_direction_is_valid(state, candidate)) {
+        continue;
+      }
+
+      snake->direction = candidate;
+      bool collides = snake_next_move_collides(snake, state->canvas);
+      snake->direction = current;
+
+      if (!collides) {
+        direction = candidate;
+        break;
+      }
+    }
+
+    GameEvents events = game_step(state, (GameInput) { .direction = direction });
+
+    if (events & (GAME_EVENT_LOST | GAME_EVENT_WON)) {
+      game_state_reset(state, state->seed + 1);
+      copy_position(state->food->position, foods[count++]);
+    } else if ((events & GAME_EVENT_ATE) && state->food->in_canvas) {
+      copy_position(state->food->position, foods[count++]);
+    }
+  }
+
+  game_state_free(state);
+
+  return count;
+}
+
+static bool same_foods(Position* a, int a_count, Position* b, int b_count) {
+  return a_count == b_count && memcmp(a, b, sizeof(Position) * a_count) == 0;
+}
+
+int main() {
+  Random random;
+  random_seed(&random, 42);
+
+  bench_report_header("random draws");
+
+  struct {
+    const char* name;
+    BenchFunction function;
+    void* context;
+  } cases[] = {
+    { "random_next", bench_random_next, &random },
+    { "random_bounded", bench_random_bounded, &random },
+    { "random_range", bench_random_range, &random },
+    { "randint", bench_randint, NULL },
+    { "legacy rand % n + srand(time)", bench_legacy_rand, NULL },
+  };
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    double ns = bench_run(cases[i].function, cases[i].context, BENCH_MIN_NS);
+    char size[32];
+    snprintf(size, sizeof(size), "%.1fM/s", 1e3 / ns);
+    bench_report(cases[i].name, size, ns, 0);
+  }
+
+  Position first[REPLAY_FOODS], second[REPLAY_FOODS], other[REPLAY_FOODS];
+  int first_count = record_foods(1234, first);
+  int second_count = record_foods(1234, second);
+  int other_count = record_foods(4321, other);
+
+  bool reproducible = same_foods(first, first_count, second, second_count);
+  bool seed_matters = !same_foods(first, first_count, other, other_count);
+
+  printf("# food sequence (5x5, %i foods)\n", first_count);
+  printf("seed 1234:");
+
+  for (int i = 0; i < first_count && i < 16; i++) {
+    printf(" (%i,%i)", first[i][0], first[i][1]);
+  }
+
+  printf("%s\n", first_count > 16 ? " ..." : "");
+  printf("reproducible: %s\n", reproducible ? "yes" : "no");
+  printf("differs for another seed: %s\n", seed_matters ? "yes" : "no");
+
+  return reproducible && seed_matters ? EXIT_SUCCESS : EXIT_FAILURE;
+}
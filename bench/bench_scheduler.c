@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "host_hal.h"
+#include "../inc/constants.h"
+#include "../inc/scheduler.h"
+
+// =============================================================
+// BENCH SCHEDULER
+// Compara o ritmo dos ticks do scheduler (src/scheduler.c) com o do loop
+// antigo (50 esperas de 10 ms por tick) quando cada tick gasta alguns
+// milissegundos renderizando e tocando sons, com o relógio manual do HAL de
+// host, em que o tempo só anda quando o programa manda. Confere também a
+// mudança de intervalo e o descarte de ticks atrasados, e mede o atraso dos
+// disparos com o relógio de verdade (que no host depende do sistema).
+// =============================================================
+
+#define TICKS 20
+#define WORK_US 3000
+#define POLL_US 1000
+#define OLD_STEP_DELAY_US 10000
+#define OLD_STEPS 50
+#define REAL_TICKS 200
+#define REAL_INTERVAL_US 5000
+
+// espera a próxima fronteira lendo as entradas a cada POLL_US e retorna o
+// instante em que ela foi vista
+static uint64_t wait_tick(TickScheduler* scheduler) {
+  while (!tick_scheduler_take(scheduler)) {
+    sleep_us(POLL_US);
+  }
+
+  return time_us_64();
+}
+
+// período médio dos ticks, em microssegundos, com o scheduler
+static double scheduler_period_us(void) {
+  TickScheduler scheduler;
+  tick_scheduler_start(&scheduler, GAME_TICK_US);
+  uint64_t first = wait_tick(&scheduler);
+  uint64_t last = first;
+
+  for (int i = 1; i < TICKS; i++) {
+    sleep_us(WORK_US);
+    last = wait_tick(&scheduler);
+  }
+
+  tick_scheduler_stop(&scheduler);
+
+  return (double) (last - first) / (TICKS - 1);
+}
+
+// período médio dos ticks, em microssegundos, com o loop antigo
+static double sleep_loop_period_us(void) {
+  uint64_t first = time_us_64();
+
+  for (int i = 0; i < TICKS; i++) {
+    for (int step = 0; step < OLD_STEPS; step++) {
+      sleep_us(OLD_STEP_DELAY_US);
+    }
+
+    sleep_us(WORK_US);
+  }
+
+  return (double) (time_us_64() - first) / TICKS;
+}
+
+// depois de uma mudança de intervalo, o tick seguinte ainda vem com o
+// intervalo anterior e os demais com o novo
+static bool interval_change_applies(void) {
+  TickScheduler scheduler;
+  tick_scheduler_start(&scheduler, GAME_TICK_US);
+  uint64_t previous = wait_tick(&scheduler);
+  bool applies = true;
+
+  tick_scheduler_set_interval(&scheduler, GAME_TICK_US / 2);
+
+  for (int i = 0; i < 5; i++) {
+    uint64_t now = wait_tick(&scheduler);
+    uint64_t expected = i == 0 ? GAME_TICK_US : GAME_TICK_US / 2;
+    applies = applies && now - previous == expected;
+    previous = now;
+  }
+
+  tick_scheduler_stop(&scheduler);
+
+  return applies;
+}
+
+// um loop que não olha o scheduler por 3.2 intervalos vê um tick só, e os
+// outros dois são contados como perdidos
+static bool late_ticks_coalesce(void) {
+  TickScheduler scheduler;
+  tick_scheduler_start(&scheduler, GAME_TICK_US);
+  host_clock_advance_us(GAME_TICK_US * 16 / 5);
+
+  bool coalesced = tick_scheduler_take(&scheduler) && !tick_scheduler_take(&scheduler) && scheduler.missed == 2;
+  tick_scheduler_stop(&scheduler);
+
+  return coalesced;
+}
+
+int main() {
+  host_clock_set_manual(true);
+
+  double scheduler_us = scheduler_period_us();
+  double sleep_loop_us = sleep_loop_period_us();
+  bool applies = interval_change_applies();
+  bool coalesced = late_ticks_coalesce();
+
+  printf("# tick period with %i us of work per tick (manual clock)\n", WORK_US);
+  printf("%-28s %12s %18s\n", "loop", "ms/tick", "drift over 1 min");
+  printf("%-28s %12.3f %16.0f ms\n", "sleep_ms(10) x 50", sleep_loop_us / 1e3, (sleep_loop_us - GAME_TICK_US) * 60e6 / GAME_TICK_US / 1e3);
+  printf("%-28s %12.3f %16.0f ms\n", "tick scheduler", scheduler_us / 1e3, (scheduler_us - GAME_TICK_US) * 60e6 / GAME_TICK_US / 1e3);
+
+  // relógio de verdade: espera ativa, como no loop do jogo
+  host_clock_set_manual(false);
+
+  TickScheduler scheduler;
+  tick_scheduler_start(&scheduler, REAL_INTERVAL_US);
+
+  for (int i = 0; i < REAL_TICKS; i++) {
+    while (!tick_scheduler_take(&scheduler)) {
+      tight_loop_contents();
+    }
+  }
+
+  tick_scheduler_stop(&scheduler);
+
+  printf("real clock: %i ticks of %i us, max jitter %u us, %u missed\n", REAL_TICKS, REAL_INTERVAL_US,
+      (unsigned) scheduler.max_jitter_us, (unsigned) scheduler.missed);
+
+  bool fixed_rate = scheduler_us == GAME_TICK_US;
+  printf("fixed-rate ticks under manual clock: %s\n", fixed_rate ? "yes" : "no");
+  printf("interval change applies from the next tick: %s\n", applies ? "yes" : "no");
+  printf("late ticks coalesced: %s\n", coalesced ? "yes" : "no");
+
+  return fixed_rate && applies && coalesced ? EXIT_SUCCESS : EXIT_FAILURE;
+}
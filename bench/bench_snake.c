@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/canvas.h"
+#include "../inc/snake.h"
+
+// =============================================================
+// BENCH SNAKE
+// Mede o custo de um passo da cobra (snake_move) e da checagem de colisão
+// conforme o comprimento cresce, num canvas grande. A checagem linear (como
+// era feita antes, comparando a cabeça com cada node) é medida para
+// comparação com a consulta à ocupação do canvas. A cobra percorre o canvas em zigue-zague (leste
+// nas linhas pares, oeste nas ímpares, descendo no fim de cada linha), um
+// ciclo que passa por todas as células, então ela nunca colide consigo mesma.
+// =============================================================
+
+#define BOARD_SIZE 1024
+
+typedef struct BenchContext {
+  Canvas* canvas;
+  Snake* snake;
+} BenchContext;
+
+// direção do zigue-zague para a posição atual da cabeça (BOARD_SIZE é par,
+// então descer da última linha volta ao início do ciclo)
+static Direction zigzag_direction(Snake* snake, Canvas* canvas) {
+  Position head;
+  snake_get_head_position(snake, head);
+  int row = head[0], col = head[1];
+
+  if (row % 2 == 0) {
+    return col < canvas->cols - 1 ? DIRECTION_EAST : DIRECTION_SOUTH;
+  } else {
+    return col > 0 ? DIRECTION_WEST : DIRECTION_SOUTH;
+  }
+}
+
+static void step(BenchContext* context) {
+  context->snake->direction = zigzag_direction(context->snake, context->canvas);
+  snake_move(context->snake, context->canvas);
+}
+
+static void bench_move(void* context) {
+  step(context);
+}
+
+// checagem de colisão percorrendo o corpo inteiro
+static bool linear_self_collides(Snake* snake) {
+  Position head, node;
+  snake_get_head_position(snake, head);
+
+  for (int i = 1; i < snake->size; i++) {
+    snake_get_node_position(snake, i, node);
+
+    if (positions_collide(head, node)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void bench_tick_linear(void* context) {
+  step(context);
+  bench_sink += linear_self_collides(((BenchContext*) context)->snake);
+}
+
+static void bench_tick_occupancy(void* context) {
+  step(context);
+  bench_sink += snake_self_collides(((BenchContext*) context)->snake);
+}
+
+int main() {
+  int lengths[] = { 2, 1000, 10000, 100000, 500000 };
+  char size[32];
+
+  snprintf(size, sizeof(size), "%ix%i", BOARD_SIZE, BOARD_SIZE);
+  bench_report_header("snake tick (move + self collision) by snake length");
+
+  BenchContext context = { .canvas = canvas_init(BOARD_SIZE, BOARD_SIZE) };
+  context.snake = snake_init(context.canvas, (int [2]){ 0, 1 }, DIRECTION_EAST, 2);
+
+  for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    while (context.snake->size < lengths[i]) {
+      snake_grow(context.snake, context.canvas);
+      step(&context);
+    }
+
+    char name[64];
+    size_t bytes = sizeof(Snake) + (size_t) context.snake->capacity * sizeof(Position);
+
+    snprintf(name, sizeof(name), "move/length=%i", lengths[i]);
+    bench_report(name, size, bench_run(bench_move, &context, BENCH_MIN_NS), bytes);
+    snprintf(name, sizeof(name), "tick_linear/length=%i", lengths[i]);
+    bench_report(name, size, bench_run(bench_tick_linear, &context, BENCH_MIN_NS), bytes);
+    snprintf(name, sizeof(name), "tick_occupancy/length=%i", lengths[i]);
+    bench_report(name, size, bench_run(bench_tick_occupancy, &context, BENCH_MIN_NS), bytes);
+  }
+
+  snake_free(context.snake);
+  canvas_free(context.canvas);
+
+  return 0;
+}
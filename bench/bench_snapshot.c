@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/game_engine.h"
+#include "../inc/autopilot.h"
+#include "../inc/snapshot.h"
+
+// =============================================================
+// BENCH SNAPSHOT
+// Custo de salvar e restaurar um jogo pelo meio (src/snapshot.c) e de clonar
+// um jogo copiando o snapshot, comparado com criar um jogo novo e restaurar
+// nele. Antes, confere que salvar, restaurar e salvar de novo dá os mesmos
+// bytes, que o clone joga exatamente o mesmo jogo que o original e que
+// snapshots corrompidos são recusados sem mexer no jogo.
+// =============================================================
+
+#define CHECK_TICKS 2000
+#define CORRUPTIONS 15
+
+typedef struct SnapshotContext {
+  GameState* state;
+  GameState* clone;
+  GameSnapshot snapshot;
+  GameSnapshot copy;
+} SnapshotContext;
+
+static void bench_save(void* context) {
+  SnapshotContext* c = context;
+  game_snapshot_save(c->state, &c->snapshot);
+  bench_sink += c->snapshot.free_count;
+}
+
+static void bench_copy(void* context) {
+  SnapshotContext* c = context;
+  memcpy(&c->copy, &c->snapshot, sizeof(GameSnapshot));
+  bench_sink += c->copy.free_count;
+}
+
+static void bench_load(void* context) {
+  SnapshotContext* c = context;
+  game_snapshot_load(c->clone, &c->snapshot);
+  bench_sink += c->clone->snake->size;
+}
+
+static void bench_clone(void* context) {
+  SnapshotContext* c = context;
+  game_snapshot_save(c->state, &c->snapshot);
+  game_snapshot_load(c->clone, &c->snapshot);
+  bench_sink += c->clone->snake->size;
+}
+
+static void bench_allocate_and_load(void* context) {
+  SnapshotContext* c = context;
+  GameState* clone = game_state_init(c->state->canvas->rows, c->state->canvas->cols, 0);
+  game_snapshot_load(clone, &c->snapshot);
+  bench_sink += clone->snake->size;
+  game_state_free(clone);
+}
+
+// joga com o piloto automático até a cobra ocupar metade do canvas
+static GameState* mid_game(Autopilot* autopilot, int n, uint64_t seed) {
+  GameState* state = game_state_init(n, n, seed);
+
+  while (!state->over && state->snake->size < n * n / 2) {
+    game_step(state, (GameInput) { .direction = autopilot_decide(autopilot, state) });
+  }
+
+  return state;
+}
+
+// salva, restaura num outro jogo e salva de novo: os dois snapshots devem ser
+// iguais byte a byte
+static bool round_trip_identical(GameState* state, GameState* clone) {
+  static GameSnapshot first, second;
+
+  return game_snapshot_save(state, &first) &&
+      game_snapshot_load(clone, &first) &&
+      game_snapshot_save(clone, &second) &&
+      memcmp(&first, &second, sizeof(GameSnapshot)) == 0;
+}
+
+// avança o original e o clone com as mesmas entradas e compara os snapshots
+// a cada tick, incluindo as comidas sorteadas
+static bool clone_plays_identically(Autopilot* autopilot, GameState* state, GameState* clone) {
+  static GameSnapshot original, copy;
+  bool identical = game_snapshot_save(state, &original) && game_snapshot_load(clone, &original);
+
+  for (int tick = 0; tick < CHECK_TICKS && identical && !state->over; tick++) {
+    GameInput input = { .direction = autopilot_decide(autopilot, state) };
+    GameEvents events = game_step(state, input);
+    identical = game_step(clone, input) == events;
+
+    game_snapshot_save(state, &original);
+    game_snapshot_save(clone, &copy);
+    identical = identical && memcmp(&original, &copy, sizeof(GameSnapshot)) == 0;
+  }
+
+  return identical;
+}
+
+// estraga um campo do snapshot, de um jeito diferente para cada kind
+static void corrupt(GameSnapshot* snapshot, int kind, int size) {
+  switch (kind) {
+    case 0: snapshot->free_count = (uint16_t) (size + 1); break;
+    case 1: snapshot->free_order[0] = (uint16_t) size; break;
+    case 2: snapshot->free_order[0] = SNAPSHOT_NO_CELL; break;
+    case 3: snapshot->free_order[1] = snapshot->free_order[0]; break;
+    case 4: snapshot->body[snapshot->snake_size - 1] = (uint16_t) size; break;
+    case 5: snapshot->food_cell = (uint16_t) size; break;
+    case 6: snapshot->cells[size - 1] = CELL_OBSTACLE + 1; break;
+    case 7: snapshot->snake_direction = DIRECTION_NONE; break;
+    case 8: snapshot->snake_size = (uint16_t) (size + 1); break;
+    // as células livres e as células não batem
+    case 9: {
+      snapshot->free_count = (uint16_t) size;
+
+      for (int i = 0; i < size; i++) {
+        snapshot->free_order[i] = (uint16_t) i;
+      }
+
+      break;
+    }
+    case 10: snapshot->free_count--; break;
+    case 11: snapshot->free_order[0] = snapshot->body[0]; break;
+    case 12: snapshot->snake_pending_growth = (uint16_t) (size - snapshot->snake_size + 1); break;
+    case 13: snapshot->body[1] = snapshot->free_order[0]; break;
+    case 14: {
+      snapshot->flags |= SNAPSHOT_FLAG_FOOD_IN_CANVAS;
+      snapshot->food_cell = snapshot->free_order[0];
+      break;
+    }
+  }
+}
+
+// cada snapshot corrompido é recusado e o jogo fica como estava
+static bool corrupt_rejected(GameState* state, GameState* clone) {
+  static GameSnapshot valid, broken, before, after;
+  int size = state->canvas->rows * state->canvas->cols;
+  bool rejected = game_snapshot_save(state, &valid) && valid.free_count >= 2;
+
+  for (int kind = 0; kind < CORRUPTIONS && rejected; kind++) {
+    broken = valid;
+    corrupt(&broken, kind, size);
+    game_snapshot_save(clone, &before);
+    rejected = !game_snapshot_load(clone, &broken);
+    game_snapshot_save(clone, &after);
+    rejected = rejected && memcmp(&before, &after, sizeof(GameSnapshot)) == 0;
+  }
+
+  return rejected;
+}
+
+int main() {
+  int sizes[] = { 5, 16 };
+  bool round_trip = true, plays_identically = true, rejected = true;
+
+  bench_report_header("game snapshot (" CANVAS_BACKEND " backend, snake at half the canvas)");
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    int n = sizes[i];
+    Autopilot* autopilot = autopilot_init(n, n);
+    SnapshotContext context = {
+      .state = mid_game(autopilot, n, 1),
+      .clone = game_state_init(n, n, 0),
+    };
+
+    game_snapshot_save(context.state, &context.snapshot);
+
+    char size[32];
+    snprintf(size, sizeof(size), "%ix%i", n, n);
+
+    bench_report("save", size, bench_run(bench_save, &context, BENCH_MIN_NS), sizeof(GameSnapshot));
+    bench_report("copy snapshot (memcpy)", size, bench_run(bench_copy, &context, BENCH_MIN_NS), sizeof(GameSnapshot));
+    bench_report("load", size, bench_run(bench_load, &context, BENCH_MIN_NS), sizeof(GameSnapshot));
+    bench_report("clone (save + load)", size, bench_run(bench_clone, &context, BENCH_MIN_NS), sizeof(GameSnapshot));
+    bench_report("clone (init + load)", size, bench_run(bench_allocate_and_load, &context, BENCH_MIN_NS), sizeof(GameSnapshot));
+
+    for (uint64_t seed = 1; seed <= 20; seed++) {
+      GameState* state = mid_game(autopilot, n, seed);
+      round_trip = round_trip && round_trip_identical(state, context.clone);
+      rejected = rejected && corrupt_rejected(state, context.clone);
+      plays_identically = plays_identically && clone_plays_identically(autopilot, state, context.clone);
+      game_state_free(state);
+    }
+
+    game_state_free(context.state);
+    game_state_free(context.clone);
+    autopilot_free(autopilot);
+  }
+
+  printf("snapshot size: %zu bytes\n", sizeof(GameSnapshot));
+  printf("round trip byte-identical: %s\n", round_trip ? "yes" : "no");
+  printf("clone plays identically: %s\n", plays_identically ? "yes" : "no");
+  printf("corrupt snapshots rejected: %s\n", rejected ? "yes" : "no");
+
+  return round_trip && plays_identically && rejected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "host_hal.h"
+#include "bench.h"
+#include "../inc/constants.h"
+#include "../inc/synth.h"
+#include "../inc/synth_stream.h"
+
+// =============================================================
+// BENCH SYNTH
+// O mixer de src/synth.c: quanto custa mixar uma metade do buffer do DMA
+// (SYNTH_HALF_SAMPLES níveis) com as SYNTH_VOICES vozes tocando (quadrada,
+// triangular, ruído e um PCM) a 8, 16 e 22,05 kHz, e que fração do tempo de
+// tocar essa metade isso ocupa. No host a fração é só uma referência; no
+// RP2040 o laço é o mesmo, com contas inteiras.
+//
+// Depois confere as formas de onda, que a soma nunca sai de 0..top, que as
+// durações e o PCM acabam na amostra certa e, com o relógio manual e o
+// registro de escritas no PWM do HAL de host, que o stream de DMA
+// (src/synth_stream.c) escreve no nível do buzzer exatamente a saída do
+// mixer, uma amostra a cada 1/taxa, trocando de metade sem perder nenhuma.
+// =============================================================
+
+#define RUNS 5
+#define PCM_LENGTH 2048
+#define PCM_RATE 8000
+// duração do stream conferido e sua taxa
+#define STREAM_US 250000
+#define STREAM_RATE 8000
+#define STREAM_SAMPLES (STREAM_US / (1000000 / STREAM_RATE))
+
+static const uint rates[] = { 8000, 16000, 22050 };
+static int8_t pcm[PCM_LENGTH];
+
+// um "plim": seno decaindo, gravado a PCM_RATE
+static void pcm_init(void) {
+  for (int i = 0; i < PCM_LENGTH; i++) {
+    double t = (double) i / PCM_RATE;
+    pcm[i] = (int8_t) lrint(127 * exp(-t * 12) * sin(2 * M_PI * 880 * t));
+  }
+}
+
+static void play_all_voices(Synth* synth) {
+  synth_play(synth, 0, SYNTH_SQUARE, 440, 200, 0);
+  synth_play(synth, 1, SYNTH_TRIANGLE, 660, 200, 0);
+  synth_play(synth, 2, SYNTH_NOISE, 4000, 120, 0);
+  synth_play_pcm(synth, 3, pcm, PCM_LENGTH, PCM_RATE, 255);
+}
+
+static void mix_half(void* context) {
+  Synth* synth = context;
+  uint16_t levels[SYNTH_HALF_SAMPLES];
+
+  // o PCM recomeça quando acaba, para medir sempre as quatro vozes
+  if (!synth_is_playing(synth, 3)) {
+    synth_play_pcm(synth, 3, pcm, PCM_LENGTH, PCM_RATE, 255);
+  }
+
+  synth_mix(synth, levels, SYNTH_HALF_SAMPLES, SYNTH_PWM_TOP);
+  bench_sink += levels[SYNTH_HALF_SAMPLES - 1];
+}
+
+// uma quadrada a taxa / 8: 4 amostras acima do centro e 4 abaixo, e sem
+// nada tocando, o centro
+static bool waves_shaped(void) {
+  Synth synth;
+  uint16_t levels[16];
+  uint center = (SYNTH_PWM_TOP + 1) / 2;
+  bool shaped = true;
+
+  synth_init(&synth, 8000);
+  synth_mix(&synth, levels, 16, SYNTH_PWM_TOP);
+
+  for (int i = 0; i < 16; i++) {
+    shaped = shaped && levels[i] == center;
+  }
+
+  synth_play(&synth, 0, SYNTH_SQUARE, 1000, SYNTH_VOLUME_MAX, 0);
+  synth_mix(&synth, levels, 16, SYNTH_PWM_TOP);
+
+  for (int i = 0; i < 16; i++) {
+    shaped = shaped && (i % 8 < 4 ? levels[i] > center : levels[i] < center) && levels[i] == levels[i % 4 + (i % 8 < 4 ? 0 : 4)];
+  }
+
+  // a triangular sobe durante meio ciclo e desce no outro
+  synth_play(&synth, 0, SYNTH_TRIANGLE, 500, SYNTH_VOLUME_MAX, 0);
+  synth_mix(&synth, levels, 16, SYNTH_PWM_TOP);
+
+  for (int i = 1; i < 16; i++) {
+    shaped = shaped && (i <= 8 ? levels[i] > levels[i - 1] : levels[i] < levels[i - 1]);
+  }
+
+  return shaped;
+}
+
+// todas as vozes no máximo e em fase ficam dentro de 0..top, e chegam perto
+// das pontas
+static bool mix_in_range(void) {
+  Synth synth;
+  uint16_t levels[1024];
+  uint low = SYNTH_PWM_TOP;
+  uint high = 0;
+
+  synth_init(&synth, 22050);
+
+  for (uint v = 0; v < SYNTH_VOICES; v++) {
+    synth_play(&synth, v, SYNTH_SQUARE, 1000, SYNTH_VOLUME_MAX, 0);
+  }
+
+  synth_mix(&synth, levels, count_of(levels), SYNTH_PWM_TOP);
+
+  for (size_t i = 0; i < count_of(levels); i++) {
+    low = levels[i] < low ? levels[i] : low;
+    high = levels[i] > high ? levels[i] : high;
+  }
+
+  return low <= 2 && high >= SYNTH_PWM_TOP - 2 && high <= SYNTH_PWM_TOP;
+}
+
+// 10 ms a 8 kHz são 80 amostras, e um PCM de 100 amostras a 4 kHz dura 200
+// amostras a 8 kHz
+static bool voices_end_on_time(void) {
+  Synth synth;
+  uint16_t levels[400];
+  uint center = (SYNTH_PWM_TOP + 1) / 2;
+
+  synth_init(&synth, 8000);
+  synth_play(&synth, 0, SYNTH_SQUARE, 1000, SYNTH_VOLUME_MAX, 10000);
+  synth_mix(&synth, levels, count_of(levels), SYNTH_PWM_TOP);
+  bool tone = levels[79] != center && levels[80] == center && !synth_is_playing(&synth, 0);
+
+  synth_play_pcm(&synth, 1, pcm, 100, 4000, SYNTH_VOLUME_MAX);
+  uint16_t first = 0;
+  synth_mix(&synth, levels, count_of(levels), SYNTH_PWM_TOP);
+  // cada amostra do PCM sai duas vezes
+  bool doubled = true;
+
+  for (int i = 0; i < 200; i += 2) {
+    doubled = doubled && levels[i] == levels[i + 1];
+    first |= levels[i] != center;
+  }
+
+  bool pcm_done = doubled && first && levels[200] == center && !synth_is_playing(&synth, 1);
+
+  return tone && pcm_done;
+}
+
+// o stream escreve no nível do buzzer a saída do mixer, em ordem, uma
+// amostra a cada 1/STREAM_RATE
+static bool stream_matches_mixer(uint* written) {
+  static uint16_t expected[STREAM_SAMPLES];
+  Synth synth;
+  Synth reference;
+  uint channel = pwm_gpio_to_channel(BUZZER_PIN);
+  uint slice = pwm_gpio_to_slice_num(BUZZER_PIN);
+
+  synth_init(&synth, STREAM_RATE);
+  play_all_voices(&synth);
+  reference = synth;
+  synth_mix(&reference, expected, STREAM_SAMPLES, SYNTH_PWM_TOP);
+
+  host_pwm_log_clear();
+  uint64_t start = time_us_64();
+
+  if (!synth_stream_start(&synth, BUZZER_PIN) || synth_stream_rate() != STREAM_RATE) {
+    return false;
+  }
+
+  host_clock_advance_us(STREAM_US);
+  synth_stream_stop();
+  uint writes_at_stop = host_pwm_log_count();
+  host_clock_advance_us(STREAM_US);
+
+  bool match = host_pwm_log_count() == writes_at_stop;
+  *written = 0;
+
+  for (uint i = 0; i < host_pwm_log_count() && match; i++) {
+    HostPwmWrite write = host_pwm_log_get(i);
+
+    if (write.slice != slice || write.channel != (int) channel) {
+      continue;
+    }
+
+    // a última escrita é a de synth_stream_stop, que cala o buzzer
+    if (*written == STREAM_SAMPLES) {
+      match = write.value == 0;
+      continue;
+    }
+
+    uint64_t due = start + (uint64_t) (*written + 1) * 1000000 / STREAM_RATE;
+    match = write.us == due && write.value == expected[*written];
+
+    if (!match) {
+      printf("sample %u: level %u at %llu us, expected %u at %llu us\n", *written, write.value,
+          (unsigned long long) (write.us - start), expected[*written], (unsigned long long) (due - start));
+    }
+
+    (*written)++;
+  }
+
+  return match && *written == STREAM_SAMPLES;
+}
+
+int main() {
+  pcm_init();
+
+  printf("# mixing one half buffer (%i levels), %i voices: square, triangle, noise, pcm\n", SYNTH_HALF_SAMPLES, SYNTH_VOICES);
+  printf("%-20s %12s %12s %12s %12s\n", "rate", "ns/buffer", "ns/sample", "buffer us", "host load");
+
+  for (size_t i = 0; i < count_of(rates); i++) {
+    Synth synth;
+    synth_init(&synth, rates[i]);
+    play_all_voices(&synth);
+
+    double ns = bench_best_of(mix_half, &synth, RUNS, BENCH_MIN_NS);
+    double period_us = SYNTH_HALF_SAMPLES * 1e6 / rates[i];
+    char name[32];
+    snprintf(name, sizeof(name), "%u Hz", rates[i]);
+    printf("%-20s %12.1f %12.2f %12.1f %11.3f%%\n", name, ns, ns / SYNTH_HALF_SAMPLES, period_us, ns / (period_us * 10));
+  }
+
+  host_clock_set_manual(true);
+
+  uint written = 0;
+  bool shaped = waves_shaped();
+  bool in_range = mix_in_range();
+  bool on_time = voices_end_on_time();
+  bool streamed = stream_matches_mixer(&written);
+
+  printf("%-20s %12u levels in %i us\n", "dma stream", written, STREAM_US);
+  printf("square, triangle and silence have the expected shape: %s\n", shaped ? "yes" : "no");
+  printf("all voices at full volume stay within the pwm range: %s\n", in_range ? "yes" : "no");
+  printf("tones and pcm samples end on the right sample: %s\n", on_time ? "yes" : "no");
+  printf("dma stream writes the mixer output at the sample rate: %s\n", streamed ? "yes" : "no");
+
+  return shaped && in_range && on_time && streamed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -8,6 +8,7 @@
 #include "hardware/adc.h"
 #include "hardware/i2c.h"
 #include "hardware/pwm.h"
+#include "hardware/sync.h"
 #include "./inc/constants.h"
 #include "./inc/canvas.h"
 #include "./inc/snake.h"
@@ -15,10 +16,20 @@
 #include "./inc/utils.h"
 #include "./inc/joystick.h"
 #include "./inc/melody.h"
+#include "./inc/audio.h"
 #include "./inc/neopixel.h"
 #include "./inc/display_oled/ssd1306.h"
 #include "./inc/menu_text.h"
 #include "./inc/settings.h"
+#include "./inc/game_engine.h"
+#include "./inc/random.h"
+#include "./inc/replay.h"
+#include "./inc/autopilot.h"
+#include "./inc/scheduler.h"
+#include "./inc/input_queue.h"
+#include "./inc/input_events.h"
+#include "./inc/output.h"
+#include "./inc/latency.h"
 
 MenuText* create_menu_text_win() {
     size_t options_size = 2;
@@ -63,16 +74,18 @@ MenuText* create_menu_text_loss()  {
 }
 
 int settings_loop() {
-    size_t options_size = 3;
+    size_t options_size = 4;
     MenuOption* options = malloc(sizeof(MenuOption) * options_size);
     GameSettings* game_settings = game_settings_get();
 
     bool* music_mute = &game_settings->sound.music.mute;
     bool* sound_effects_mute = &game_settings->sound.sound_effects.mute;
+    bool* autopilot_enabled = &game_settings->autopilot.enabled;
 
     options[0] = (MenuOption) { .action = ACTION_SETTINGS_SOUND_TOGGLE_MUSIC_MUTE, .selected = true };
     options[1] = (MenuOption) { .action = ACTION_SETTINGS_SOUND_TOGGLE_SOUND_EFFECTS_MUTE };
-    options[2] = (MenuOption) { .action = ACTION_GO_BACK, .label = "Go back" };
+    options[2] = (MenuOption) { .action = ACTION_SETTINGS_TOGGLE_AUTOPILOT };
+    options[3] = (MenuOption) { .action = ACTION_GO_BACK, .label = "Go back" };
 
     MenuText* menu_text = menu_text_create(options, options_size);
 
@@ -93,6 +106,7 @@ int settings_loop() {
     while (true) {
         options[0].label = !*music_mute ? "music on" : "music off";
         options[1].label = !*sound_effects_mute ? "sfx on" : "sfx off";
+        options[2].label = *autopilot_enabled ? "autoplay on" : "autoplay off";
 
         int action = wait_menu_text_choice(menu_text, ssd, text_area);
 
@@ -109,6 +123,10 @@ int settings_loop() {
                 *music_mute = !*music_mute;
                 break;
             }
+            case ACTION_SETTINGS_TOGGLE_AUTOPILOT: {
+                *autopilot_enabled = !*autopilot_enabled;
+                break;
+            }
         }
     }
 }
@@ -131,17 +149,36 @@ int game_loop() {
     uint8_t ssd[ssd1306_buffer_length];
     ssd1306_clear(ssd, (uint8_t) ssd1306_buffer_length, text_area);
 
-    Canvas* canvas = canvas_init(5, 5);
+    // cada jogo tem sua própria semente, tirada do gerador padrão (que recebe
+    // a semente de boot em init_components)
+    GameState* state = game_state_init(5, 5, random_next64(random_default()));
+    Snake* snake = state->snake;
+
+    // grava as entradas do jogo: cada buffer cheio do gravador vai para a
+    // caixa de saída no tick e é enviado pela serial enquanto o loop espera
+    // o próximo (veja tools/replay.c)
+    ReplayOutbox replay_outbox;
+    replay_outbox_init(&replay_outbox);
+    ReplayWriter replay;
+    replay_writer_init(&replay, state->canvas->rows, state->canvas->cols, state->seed, replay_outbox_sink, &replay_outbox);
+
+    Autopilot* autopilot = settings->autopilot.enabled ? autopilot_init(state->canvas->rows, state->canvas->cols) : NULL;
 
-    Position snake_position;
-    // BUG: canvas_get_random_free_position doesn't work at the beginning
-    // because raspberry pi's time always starts at 0.
-    // canvas_get_random_free_position(canvas, snake_position);
-    copy_position((int [2]){ 2, 1 }, snake_position);
-    Snake* snake = snake_init(canvas, snake_position, DIRECTION_EAST, 2);
-    Food* food = food_init(canvas);
+    canvas_render(state->canvas);
 
-    canvas_render(canvas);
+    TickScheduler scheduler;
+    tick_scheduler_start(&scheduler, GAME_TICK_US);
+
+    // com o piloto automático o joystick não é lido e a fila fica vazia
+    DirectionQueue directions;
+    direction_queue_reset(&directions, snake->direction);
+
+    InputSampler sampler = { .running = false };
+    input_events_clear();
+
+    if (autopilot == NULL) {
+        input_sampler_start(&sampler, &directions, INPUT_SAMPLE_US);
+    }
 
     bool going = true;
     bool allow_speeding = false;
@@ -154,81 +191,103 @@ int game_loop() {
             displaying_text_in_game = true;
         }
 
-        int total_delay = 500;
-        int step_delay = 10;
-        int steps = total_delay / step_delay;
+        Direction new_direction = snake->direction;
+        bool step_early = false;
 
-        for (int i = 0; i < steps; i++) {
-            Direction current_direction = snake->direction;
-            Direction previous_direction = current_direction;
-            Direction new_direction = current_direction;
-            bool skip_delay = false;
+        // com o piloto automático a direção vem dele, uma vez por tick, e o
+        // joystick é ignorado (os botões continuam funcionando)
+        if (autopilot != NULL) {
+            new_direction = autopilot_decide(autopilot, state);
+        }
 
-            JoystickInfo joystick_info = joystick_get_info();
-            Direction joystick_direction = joystick_info.direction;
+        // uma curva que chega com a fila vazia adianta o tick; as que chegam
+        // atrás de outra esperam a sua vez, uma por tick
+        bool queued_before = !direction_queue_is_empty(&directions);
 
-            if (joystick_direction != DIRECTION_NONE) {
-                if (allow_speeding && current_direction == joystick_direction) {
-                    skip_delay = true;
-                } else if (current_direction != get_opposite_direction(joystick_direction)) {
-                    new_direction = joystick_direction;
-                }
+        // espera a próxima fronteira de tick, marcada pelo alarme do
+        // scheduler, enquanto o amostrador enche a fila de direções
+        while (!tick_scheduler_take(&scheduler)) {
+            if (allow_speeding && sampler.sample == snake->direction) {
+                step_early = true;
             }
 
-            bool button_a_down = is_button_down(BUTTON_A);
-            bool button_b_down = is_button_down(BUTTON_B);
+            InputEvent event;
+            int button = -1;
 
-            if (button_a_down || button_b_down) {
-                going = false;
-                skip_delay = true;
-                next_action = button_a_down ? ACTION_QUIT : ACTION_RESTART;
-
-                while (is_button_down(button_a_down ? BUTTON_A : BUTTON_B)) {
-                    sleep_ms(10);
+            while (button < 0 && input_events_pop(&event)) {
+                if (event.type == INPUT_EVENT_BUTTON_DOWN) {
+                    button = event.button;
                 }
             }
 
-            if (previous_direction != new_direction) {
-                snake->direction = new_direction;
-                skip_delay = true;
+            if (button >= 0) {
+                going = false;
+                next_action = button == BUTTON_A ? ACTION_QUIT : ACTION_RESTART;
+                replay_record_button(&replay, state->ticks, button);
+                input_wait_release(button);
+                break;
+            }
+
+            if (!queued_before && !direction_queue_is_empty(&directions)) {
+                step_early = true;
             }
 
-            if (skip_delay) {
+            if (step_early) {
                 break;
             }
 
-            sleep_ms(step_delay);
+            // um bloco da gravação por volta, fora do tick; enquanto houver
+            // blocos o loop não dorme
+            if (replay_outbox_drain(&replay_outbox)) {
+                continue;
+            }
+
+            // dorme até a próxima interrupção (o alarme do tick, o amostrador
+            // ou um botão)
+            LATENCY_POLL();
+            __wfe();
+        }
+
+        // um tick adiantado pela mudança de direção recomeça a contagem, para
+        // que o próximo venha um intervalo inteiro depois dele
+        if (step_early) {
+            tick_scheduler_restart(&scheduler);
         }
 
         if (!going) {
             break;
         }
 
-        Position next_head_position;
-        get_next_node_position(snake, canvas, 0, next_head_position);
+        direction_queue_pop(&directions, &new_direction);
 
-        if (positions_collide(next_head_position, food->position)) {
-            food_remove(food, canvas);
-            if (!settings->sound.sound_effects.mute) {
-                play_bite(BUZZER_PIN);
-            }
-            snake_grow(snake, canvas);
-            snake_move(snake, canvas);
+        if (new_direction != snake->direction) {
+            replay_record_direction(&replay, state->ticks, new_direction);
+        }
 
-            if (canvas_count_free_positions(canvas) > 0) {
-                food_move(food, canvas);
-            }
+        Direction previous_direction = snake->direction;
+        GameEvents events = game_step(state, (GameInput) { .direction = new_direction });
+
+        // uma entrada que o tick não aplicou (meia volta, por exemplo) não
+        // conta para as medidas de latência
+        if (snake->direction != previous_direction) {
+            LATENCY_SPAN(LATENCY_INPUT_TO_TICK, LATENCY_MARK_INPUT);
         } else {
-            snake_move(snake, canvas);
+            LATENCY_CLEAR(LATENCY_MARK_INPUT);
         }
 
-        canvas_render(canvas);
+        LATENCY_MARK(LATENCY_MARK_TICK);
+
+        if ((events & GAME_EVENT_ATE) && !settings->sound.sound_effects.mute) {
+            play_bite(BUZZER_PIN);
+        }
 
-        bool game_over = snake_self_collides(snake);
-        bool game_won = canvas_count_free_positions(canvas) == 0 && !food->in_canvas;
+        canvas_render(state->canvas);
 
-        if (game_over || game_won) {
-            if (game_over) {
+        if (events & (GAME_EVENT_LOST | GAME_EVENT_WON)) {
+            // os menus leem o joystick por conta própria
+            input_sampler_stop(&sampler);
+
+            if (events & GAME_EVENT_LOST) {
                 if (!settings->sound.music.mute) {
                     play_game_over(BUZZER_PIN);
                 }
@@ -245,16 +304,20 @@ int game_loop() {
             going = false;
         }
 
-        canvas_render(canvas);
+        canvas_render(state->canvas);
     }
 
+    input_sampler_stop(&sampler);
+    tick_scheduler_stop(&scheduler);
+    replay_writer_finish(&replay, state->ticks);
+    replay_outbox_flush(&replay_outbox);
+    autopilot_free(autopilot);
+
     menu_text_free(menu_text_loss);
     menu_text_free(menu_text_win);
-    food_free(food);
-    snake_free(snake);
-    canvas_clear(canvas);
-    canvas_render(canvas);
-    canvas_free(canvas);
+    canvas_clear(state->canvas);
+    canvas_render(state->canvas);
+    game_state_free(state);
 
     return next_action;
 }
@@ -265,6 +328,17 @@ void init_components() {
     // inicia joystick
     joystick_init();
 
+    // semeia o gerador padrão com o ruído do ADC (o relógio sempre começa em 0
+    // no boot, então não serve de semente sozinho)
+    random_seed(random_default(), random_entropy_seed());
+
+    // daqui em diante o ADC converte sozinho e o DMA guarda as leituras do
+    // joystick
+    joystick_sampler_start();
+
+    // centro de repouso do joystick, que é lido solto no boot
+    joystick_calibrate();
+
     // inicia neopixel (leds)
     npInit(LED_PIN);
     npClear();
@@ -286,8 +360,15 @@ void init_components() {
     gpio_set_dir(BUTTON_B, GPIO_IN);
     gpio_pull_up(BUTTON_B);
 
+    // eventos dos botões por interrupção
+    input_events_init();
+
     // inicia buzzer
     pwm_init_buzzer(BUZZER_PIN);
+
+    // a partir daqui LEDs, OLED e buzzer são escritos pelo core1, e o core0
+    // fica só com o jogo
+    output_start();
 }
 
 int main() {
@@ -366,5 +447,8 @@ int main() {
         sleep_ms(50);
     }
 
+    audio_stop();
+    output_stop();
+
     return 0;
 }
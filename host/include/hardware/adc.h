@@ -0,0 +1,35 @@
+#pragma once
+
+#include "pico/types.h"
+
+// só o registrador que o DMA lê; no host o DMA recebe as conversões direto
+// do ADC emulado, sem passar por ele
+typedef struct adc_hw_t {
+    volatile uint32_t fifo;
+} adc_hw_t;
+
+extern adc_hw_t host_adc_hw;
+
+#define adc_hw (&host_adc_hw)
+
+void adc_init(void);
+
+void adc_gpio_init(uint gpio);
+
+void adc_select_input(uint input);
+
+uint16_t adc_read(void);
+
+void adc_set_temp_sensor_enabled(bool enable);
+
+// modo livre: o ADC converte sem parar, a cada clkdiv + 1 ciclos do clk_adc
+// (no mínimo 96), passando pelos canais de input_mask a partir do selecionado
+void adc_set_round_robin(uint input_mask);
+
+void adc_set_clkdiv(float clkdiv);
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+
+void adc_run(bool run);
+
+void adc_fifo_drain(void);
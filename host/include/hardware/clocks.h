@@ -0,0 +1,10 @@
+#pragma once
+
+#include "pico/types.h"
+
+enum clock_index {
+    clk_sys = 5,
+    clk_adc = 8,
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
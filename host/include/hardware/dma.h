@@ -0,0 +1,79 @@
+#pragma once
+
+#include "pico/types.h"
+
+// sinais de pedido de transferência (só os usados pelo jogo)
+#define DREQ_ADC 36
+#define DREQ_DMA_TIMER0 59
+// sem pedido: o canal transfere assim que é disparado
+#define DREQ_FORCE 63
+
+#define HOST_DMA_CHANNELS 12
+#define HOST_DMA_TIMERS 4
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+typedef struct dma_channel_config {
+    enum dma_channel_transfer_size size;
+    bool read_increment;
+    bool write_increment;
+    bool ring_write;
+    uint ring_size_bits;
+    uint dreq;
+    uint chain_to;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+
+void dma_channel_unclaim(uint channel);
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size);
+
+void channel_config_set_read_increment(dma_channel_config* c, bool incr);
+
+void channel_config_set_write_increment(dma_channel_config* c, bool incr);
+
+// o endereço (de escrita, com write true) volta ao início a cada
+// 2^size_bits bytes; o buffer precisa estar alinhado a esse tamanho
+void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits);
+
+void channel_config_set_dreq(dma_channel_config* c, uint dreq);
+
+// ao terminar, o canal dispara chain_to (o próprio canal: nenhum)
+void channel_config_set_chain_to(dma_channel_config* c, uint chain_to);
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr, const volatile void* read_addr, uint transfer_count, bool trigger);
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger);
+
+// dispara o canal com o último transfer_count configurado
+void dma_channel_start(uint channel);
+
+void dma_start_channel_mask(uint32_t chan_mask);
+
+void dma_channel_abort(uint channel);
+
+bool dma_channel_is_busy(uint channel);
+
+// interrupção DMA_IRQ_0 quando o canal termina
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+
+bool dma_channel_get_irq0_status(uint channel);
+
+void dma_channel_acknowledge_irq0(uint channel);
+
+// timers de ritmo: um pedido a cada denominator / numerator ciclos do
+// clk_sys, para os canais com o dreq de dma_get_timer_dreq
+int dma_claim_unused_timer(bool required);
+
+void dma_timer_unclaim(uint timer);
+
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator);
+
+uint dma_get_timer_dreq(uint timer_num);
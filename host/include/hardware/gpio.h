@@ -0,0 +1,42 @@
+#pragma once
+
+#include "pico/types.h"
+
+enum gpio_dir {
+    GPIO_IN = 0,
+    GPIO_OUT = 1,
+};
+
+enum gpio_function {
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+
+void gpio_set_dir(uint gpio, bool out);
+
+void gpio_pull_up(uint gpio);
+
+bool gpio_get(uint gpio);
+
+void gpio_put(uint gpio, bool value);
+
+void gpio_set_function(uint gpio, enum gpio_function fn);
+
+// no host as bordas só acontecem em host_gpio_set_input, que chama o
+// callback na hora, como se a interrupção tivesse chegado
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
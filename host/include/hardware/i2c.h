@@ -0,0 +1,12 @@
+#pragma once
+
+#include "pico/types.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t* i2c0;
+extern i2c_inst_t* i2c1;
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "pico/types.h"
+
+// só as interrupções usadas pelo jogo; no host elas são chamadas pelo HAL,
+// no core0, quando o tempo passa (veja ../../src/hal.c)
+#define DMA_IRQ_0 11
+
+#define HOST_IRQ_COUNT 32
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+
+void irq_remove_handler(uint num, irq_handler_t handler);
+
+void irq_set_enabled(uint num, bool enabled);
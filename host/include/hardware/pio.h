@@ -0,0 +1,21 @@
+#pragma once
+
+#include "pico/types.h"
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t* PIO;
+
+typedef struct pio_program {
+    const uint16_t* instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+extern PIO pio0;
+extern PIO pio1;
+
+uint pio_add_program(PIO pio, const pio_program_t* program);
+
+int pio_claim_unused_sm(PIO pio, bool required);
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "pico/types.h"
+
+typedef struct {
+    uint32_t csr;
+    uint32_t div;
+    uint32_t top;
+} pwm_config;
+
+enum pwm_chan {
+    PWM_CHAN_A = 0,
+    PWM_CHAN_B = 1,
+};
+
+// os registradores de uma fatia; no host só cc (os níveis dos canais A e B)
+// tem efeito, e só quando escrito pelo DMA
+typedef struct pwm_slice_hw_t {
+    volatile uint32_t csr;
+    volatile uint32_t div;
+    volatile uint32_t ctr;
+    volatile uint32_t cc;
+    volatile uint32_t top;
+} pwm_slice_hw_t;
+
+typedef struct pwm_hw_t {
+    pwm_slice_hw_t slice[8];
+} pwm_hw_t;
+
+extern pwm_hw_t host_pwm_hw;
+
+#define pwm_hw (&host_pwm_hw)
+
+uint pwm_gpio_to_slice_num(uint gpio);
+
+uint pwm_gpio_to_channel(uint gpio);
+
+pwm_config pwm_get_default_config(void);
+
+void pwm_config_set_clkdiv(pwm_config* c, float div);
+
+void pwm_config_set_wrap(pwm_config* c, uint16_t wrap);
+
+void pwm_init(uint slice_num, pwm_config* c, bool start);
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+
+void pwm_set_clkdiv(uint slice_num, float divider);
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract);
+
+void pwm_set_enabled(uint slice_num, bool enabled);
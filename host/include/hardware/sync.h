@@ -0,0 +1,20 @@
+#pragma once
+
+#include "pico/types.h"
+
+// no host, __wfe no core0 dorme até o próximo timer (a única interrupção que
+// existe) e no core1 só cede a vez; um __sev antes faz a próxima voltar na
+// hora, como no hardware
+void __wfe(void);
+
+void __sev(void);
+
+// no host as "interrupções" (timers e bordas de GPIO) só acontecem dentro
+// das chamadas ao HAL, então não há o que desligar
+static inline uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    (void) status;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// Controle do HAL de host a partir de programas no host: permite definir as
+// entradas (botões, eixos do joystick) e inspecionar o que o jogo escreveu
+// nos periféricos.
+
+#include "pico/types.h"
+
+#define HOST_GPIO_COUNT 30
+#define HOST_ADC_CHANNELS 5
+#define HOST_PWM_SLICES 8
+#define HOST_REPEATING_TIMERS 8
+#define HOST_PWM_LOG_WRITES 8192
+
+typedef struct HostPwmSlice {
+    uint16_t wrap;
+    uint16_t level[2];
+    float clkdiv;
+    bool enabled;
+} HostPwmSlice;
+
+// channel de uma escrita que não é o nível de um canal
+#define HOST_PWM_WRAP -1
+// o divisor de clock, em dezesseis avos
+#define HOST_PWM_CLKDIV -2
+
+// uma escrita no PWM: o nível de um canal, o wrap ou o divisor de uma fatia
+typedef struct HostPwmWrite {
+    uint64_t us;
+    uint slice;
+    // canal do nível, HOST_PWM_WRAP ou HOST_PWM_CLKDIV
+    int channel;
+    uint16_t value;
+} HostPwmWrite;
+
+void host_gpio_set_input(uint gpio, bool value);
+
+void host_adc_set_value(uint input, uint16_t value);
+
+HostPwmSlice host_pwm_get_slice(uint slice_num);
+
+// esvazia o registro das escritas no PWM, que guarda, com o instante de
+// cada uma, as primeiras HOST_PWM_LOG_WRITES desde a última chamada
+void host_pwm_log_clear(void);
+
+uint host_pwm_log_count(void);
+
+HostPwmWrite host_pwm_log_get(uint index);
+
+uint64_t host_i2c_bytes_written(void);
+
+// instante (time_us_64) da última escrita no I2C, ou 0
+uint64_t host_i2c_last_write_us(void);
+
+uint64_t host_pio_words_written(void);
+
+// relógio manual: time_us_64 passa a devolver um tempo que só anda com
+// host_clock_advance_us (e com sleep_us/sleep_ms), que dispara os timers
+// vencidos em ordem, cada um no seu instante exato
+void host_clock_set_manual(bool manual);
+
+void host_clock_advance_us(uint64_t us);
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "pico/types.h"
+
+// no host o core1 é uma thread; entry precisa retornar antes de
+// multicore_reset_core1, que espera por ela
+void multicore_launch_core1(void (*entry)(void));
+
+void multicore_reset_core1(void);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdio.h>
+#include "pico/types.h"
+
+#define PICO_ERROR_TIMEOUT -1
+
+bool stdio_init_all(void);
+
+// no host não há serial USB, então nunca chega nada
+int getchar_timeout_us(uint32_t timeout_us);
+
+// extensão da newlib usada por ../../src/menu_text.c, a glibc não tem
+char* asnprintf(char* str, size_t* lenp, const char* fmt, ...);
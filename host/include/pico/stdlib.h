@@ -0,0 +1,12 @@
+#pragma once
+
+#include <assert.h>
+#include "pico/types.h"
+#include "pico/time.h"
+#include "pico/stdio.h"
+#include "hardware/gpio.h"
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+// no host, também dispara os timers vencidos (veja ../../src/hal.c)
+void tight_loop_contents(void);
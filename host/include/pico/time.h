@@ -0,0 +1,32 @@
+#pragma once
+
+#include "pico/types.h"
+
+void sleep_ms(uint32_t ms);
+
+void sleep_us(uint64_t us);
+
+uint64_t time_us_64(void);
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t) time_us_64();
+}
+
+typedef int32_t alarm_id_t;
+
+typedef struct repeating_timer repeating_timer_t;
+
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t* rt);
+
+// delay_us negativo conta o intervalo a partir do início da chamada anterior
+// (taxa fixa), positivo a partir do fim dela; o callback pode mudá-lo
+struct repeating_timer {
+    int64_t delay_us;
+    alarm_id_t alarm_id;
+    repeating_timer_callback_t callback;
+    void* user_data;
+};
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void* user_data, repeating_timer_t* out);
+
+bool cancel_repeating_timer(repeating_timer_t* timer);
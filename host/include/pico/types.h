@@ -0,0 +1,16 @@
+#pragma once
+
+// Stand-in do pico-sdk para o build de host (SNAKE_HOST_BUILD), declara só o
+// que o código do jogo usa.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+typedef uint64_t absolute_time_t;
+
+#ifndef _u
+#define _u(x) x ## u
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+// Stand-in do header gerado a partir de ../../ws2818b.pio no build de
+// firmware, o programa PIO não existe no host.
+
+#include "hardware/pio.h"
+
+static const pio_program_t ws2818b_program = { 0 };
+
+static inline void ws2818b_program_init(PIO pio, uint sm, uint offset, uint pin, float freq) {
+    (void) pio;
+    (void) sm;
+    (void) offset;
+    (void) pin;
+    (void) freq;
+}
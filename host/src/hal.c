@@ -0,0 +1,972 @@
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "host_hal.h"
+
+// ===========================================================================
+// HOST HAL
+// Implementações do pico-sdk para o build de host (SNAKE_HOST_BUILD). Não
+// há hardware: o tempo vem do relógio monotônico do sistema (ou de um relógio
+// manual, avançado pelos programas de host), os timers repetitivos disparam
+// dentro de sleep_us, tight_loop_contents e __wfe em vez de numa interrupção, as
+// entradas
+// (gpio e adc) guardam valores definidos pelos programas de host via
+// ../include/host_hal.h e as saídas só registram o que foi escrito.
+//
+// O ADC em modo livre, os timers de ritmo do DMA e os canais de DMA pedidos
+// por eles andam junto com os timers: as conversões e transferências que
+// venceram até cada instante são feitas quando o tempo passa dentro do HAL,
+// logo antes dos callbacks daquele instante. Um canal que termina dispara o
+// canal encadeado e, com a interrupção ligada, o handler de DMA_IRQ_0, ali
+// mesmo no core0.
+//
+// O core1 é uma thread. Os timers são todos do core0: só disparam na thread
+// principal, e no core1 sleep_us só dorme (com o relógio manual, nem isso,
+// porque quem anda o relógio é o core0).
+// ===========================================================================
+
+#define HOST_SYS_CLOCK_HZ 125000000
+#define HOST_ADC_CLOCK_HZ 48000000
+// ciclos do clk_adc por conversão
+#define HOST_ADC_CONVERSION_CYCLES 96
+
+i2c_inst_t* i2c0 = (i2c_inst_t*) 0;
+i2c_inst_t* i2c1 = (i2c_inst_t*) 1;
+PIO pio0 = (PIO) 0;
+PIO pio1 = (PIO) 1;
+
+static bool gpio_levels[HOST_GPIO_COUNT];
+static bool gpio_levels_initialized = false;
+static uint32_t gpio_irq_masks[HOST_GPIO_COUNT];
+static gpio_irq_callback_t gpio_irq_callback = NULL;
+static uint16_t adc_values[HOST_ADC_CHANNELS] = { 2047, 2047, 2047, 2047, 2047 };
+static uint adc_selected_input = 0;
+static HostPwmSlice pwm_slices[HOST_PWM_SLICES];
+static HostPwmWrite pwm_log[HOST_PWM_LOG_WRITES];
+static uint pwm_log_count = 0;
+static uint64_t i2c_bytes = 0;
+static uint64_t i2c_last_write_us = 0;
+static uint64_t pio_words = 0;
+static bool clock_manual = false;
+static uint64_t clock_manual_us = 0;
+
+typedef struct HostTimer {
+    repeating_timer_t* timer;
+    uint64_t due_us;
+} HostTimer;
+
+static HostTimer timers[HOST_REPEATING_TIMERS];
+static alarm_id_t next_alarm_id = 1;
+
+// core em que a thread atual roda
+static _Thread_local uint current_core = 0;
+static void (*core1_entry)(void) = NULL;
+static pthread_t core1_thread;
+// registrador de evento de __wfe/__sev
+static atomic_bool event_flag = false;
+
+static void peripherals_update(uint64_t until_us);
+
+// ---------------------------------------------------------------------------
+// tempo
+// ---------------------------------------------------------------------------
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000ull + (uint64_t) ts.tv_nsec / 1000ull;
+}
+
+uint64_t time_us_64(void) {
+    return clock_manual ? clock_manual_us : monotonic_us();
+}
+
+// timer ativo que vence primeiro até until, ou NULL
+static HostTimer* earliest_timer(uint64_t until) {
+    HostTimer* earliest = NULL;
+
+    for (int i = 0; i < HOST_REPEATING_TIMERS; i++) {
+        HostTimer* timer = &timers[i];
+
+        if (timer->timer != NULL && timer->due_us <= until && (earliest == NULL || timer->due_us < earliest->due_us)) {
+            earliest = timer;
+        }
+    }
+
+    return earliest;
+}
+
+// chama, em ordem, os callbacks dos timers que vencem até until; com o relógio
+// manual, o relógio fica no instante de cada um durante a chamada
+static void fire_timers(uint64_t until) {
+    HostTimer* timer;
+
+    while ((timer = earliest_timer(until)) != NULL) {
+        repeating_timer_t* rt = timer->timer;
+        uint64_t due = timer->due_us;
+
+        if (clock_manual && due > clock_manual_us) {
+            clock_manual_us = due;
+        }
+
+        peripherals_update(due);
+        bool again = rt->callback(rt);
+
+        // o callback pode ter cancelado o próprio timer
+        if (timer->timer != rt) {
+            continue;
+        }
+
+        if (again) {
+            timer->due_us = rt->delay_us < 0 ? due + (uint64_t) -rt->delay_us : time_us_64() + (uint64_t) rt->delay_us;
+        } else {
+            timer->timer = NULL;
+        }
+    }
+
+    peripherals_update(until);
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void* user_data, repeating_timer_t* out) {
+    for (int i = 0; i < HOST_REPEATING_TIMERS; i++) {
+        if (timers[i].timer == NULL) {
+            out->delay_us = delay_us;
+            out->callback = callback;
+            out->user_data = user_data;
+            out->alarm_id = next_alarm_id++;
+            timers[i].timer = out;
+            timers[i].due_us = time_us_64() + (uint64_t) (delay_us < 0 ? -delay_us : delay_us);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool cancel_repeating_timer(repeating_timer_t* timer) {
+    for (int i = 0; i < HOST_REPEATING_TIMERS; i++) {
+        if (timers[i].timer == timer) {
+            timers[i].timer = NULL;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void tight_loop_contents(void) {
+    if (current_core == 0) {
+        fire_timers(time_us_64());
+    }
+
+    // com o core1 rodando, quem espera cede a vez para o outro (o host pode
+    // ter um processador só)
+    if (core1_entry != NULL) {
+        sched_yield();
+    }
+}
+
+void host_clock_set_manual(bool manual) {
+    if (manual && !clock_manual) {
+        clock_manual_us = monotonic_us();
+    }
+
+    clock_manual = manual;
+}
+
+void host_clock_advance_us(uint64_t us) {
+    uint64_t target = clock_manual_us + us;
+    fire_timers(target);
+    clock_manual_us = target;
+}
+
+// dorme em trechos que terminam nos vencimentos dos timers, para que eles
+// disparem na hora certa
+void sleep_us(uint64_t us) {
+    if (clock_manual) {
+        if (current_core == 0) {
+            host_clock_advance_us(us);
+        }
+
+        return;
+    }
+
+    uint64_t target = monotonic_us() + us;
+    uint64_t now;
+
+    while ((now = monotonic_us()) < target) {
+        HostTimer* timer = current_core == 0 ? earliest_timer(target) : NULL;
+        uint64_t until = timer != NULL && timer->due_us < target ? timer->due_us : target;
+
+        if (until > now) {
+            struct timespec ts = {
+                .tv_sec = (time_t) ((until - now) / 1000000ull),
+                .tv_nsec = (long) ((until - now) % 1000000ull) * 1000L,
+            };
+            nanosleep(&ts, NULL);
+        }
+
+        if (current_core == 0) {
+            fire_timers(monotonic_us());
+        }
+    }
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t) ms * 1000ull);
+}
+
+// ---------------------------------------------------------------------------
+// multicore
+// ---------------------------------------------------------------------------
+
+static void* core1_main(void* argument) {
+    (void) argument;
+    current_core = 1;
+    core1_entry();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    if (core1_entry != NULL) {
+        fprintf(stderr, "core1 is already running.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    core1_entry = entry;
+
+    if (pthread_create(&core1_thread, NULL, core1_main, NULL) != 0) {
+        fprintf(stderr, "Could not start the core1 thread.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void multicore_reset_core1(void) {
+    if (core1_entry != NULL) {
+        pthread_join(core1_thread, NULL);
+        core1_entry = NULL;
+    }
+}
+
+void __wfe(void) {
+    if (atomic_exchange(&event_flag, false)) {
+        return;
+    }
+
+    HostTimer* timer = current_core == 0 ? earliest_timer(UINT64_MAX) : NULL;
+
+    if (timer == NULL) {
+        sched_yield();
+        return;
+    }
+
+    uint64_t due = timer->due_us;
+    uint64_t now = time_us_64();
+
+    if (due > now) {
+        sleep_us(due - now);
+    } else {
+        fire_timers(now);
+    }
+}
+
+void __sev(void) {
+    atomic_store(&event_flag, true);
+}
+
+// ---------------------------------------------------------------------------
+// stdio
+// ---------------------------------------------------------------------------
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void) timeout_us;
+    return PICO_ERROR_TIMEOUT;
+}
+
+char* asnprintf(char* str, size_t* lenp, const char* fmt, ...) {
+    va_list args;
+
+    va_start(args, fmt);
+    int length = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+
+    if (length < 0) {
+        return NULL;
+    }
+
+    // como na newlib, str é reaproveitado se tiver espaço suficiente
+    if (str == NULL || *lenp < (size_t) length + 1) {
+        str = malloc((size_t) length + 1);
+
+        if (str == NULL) {
+            return NULL;
+        }
+    }
+
+    va_start(args, fmt);
+    vsnprintf(str, (size_t) length + 1, fmt, args);
+    va_end(args);
+
+    *lenp = (size_t) length;
+    return str;
+}
+
+// ---------------------------------------------------------------------------
+// gpio
+// ---------------------------------------------------------------------------
+
+// os botões da placa têm pull-up, então o nível padrão das entradas é alto
+static void gpio_levels_init(void) {
+    if (gpio_levels_initialized) {
+        return;
+    }
+
+    for (uint i = 0; i < HOST_GPIO_COUNT; i++) {
+        gpio_levels[i] = true;
+    }
+
+    gpio_levels_initialized = true;
+}
+
+void gpio_init(uint gpio) {
+    (void) gpio;
+    gpio_levels_init();
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    (void) gpio;
+    (void) out;
+}
+
+void gpio_pull_up(uint gpio) {
+    (void) gpio;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void) gpio;
+    (void) fn;
+}
+
+bool gpio_get(uint gpio) {
+    gpio_levels_init();
+    return gpio < HOST_GPIO_COUNT ? gpio_levels[gpio] : false;
+}
+
+void gpio_put(uint gpio, bool value) {
+    host_gpio_set_input(gpio, value);
+}
+
+void host_gpio_set_input(uint gpio, bool value) {
+    gpio_levels_init();
+
+    if (gpio >= HOST_GPIO_COUNT || gpio_levels[gpio] == value) {
+        return;
+    }
+
+    gpio_levels[gpio] = value;
+
+    uint32_t event = value ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+
+    if (gpio_irq_callback != NULL && (gpio_irq_masks[gpio] & event)) {
+        gpio_irq_callback(gpio, event);
+    }
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (gpio < HOST_GPIO_COUNT) {
+        gpio_irq_masks[gpio] = enabled ? gpio_irq_masks[gpio] | event_mask : gpio_irq_masks[gpio] & ~event_mask;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    gpio_irq_callback = callback;
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+}
+
+// ---------------------------------------------------------------------------
+// adc
+// ---------------------------------------------------------------------------
+
+void adc_init(void) {}
+
+void adc_gpio_init(uint gpio) {
+    (void) gpio;
+}
+
+void adc_select_input(uint input) {
+    adc_selected_input = input < HOST_ADC_CHANNELS ? input : 0;
+}
+
+uint16_t adc_read(void) {
+    return adc_values[adc_selected_input];
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {
+    (void) enable;
+}
+
+void host_adc_set_value(uint input, uint16_t value) {
+    if (input < HOST_ADC_CHANNELS) {
+        adc_values[input] = value & 0x0fff;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// adc em modo livre e dma
+// ---------------------------------------------------------------------------
+
+typedef struct HostDmaChannel {
+    bool claimed;
+    bool busy;
+    dma_channel_config config;
+    uintptr_t write_addr;
+    uintptr_t read_addr;
+    uint32_t remaining;
+    // recarregado em remaining a cada disparo
+    uint32_t transfer_count;
+    bool irq0_enabled;
+} HostDmaChannel;
+
+// timer de ritmo do DMA: um pedido a cada denominator / numerator ciclos do
+// clk_sys, contados desde start_ns
+typedef struct HostDmaTimer {
+    bool claimed;
+    uint16_t numerator;
+    uint16_t denominator;
+    uint64_t start_ns;
+    uint64_t ticks;
+} HostDmaTimer;
+
+adc_hw_t host_adc_hw;
+pwm_hw_t host_pwm_hw;
+
+static HostDmaChannel dma_channels[HOST_DMA_CHANNELS];
+static HostDmaTimer dma_timers[HOST_DMA_TIMERS];
+static uint32_t dma_irq0_status = 0;
+static irq_handler_t irq_handlers[HOST_IRQ_COUNT];
+static bool irq_enabled[HOST_IRQ_COUNT];
+static uint adc_round_robin_mask = 0;
+static float adc_clkdiv = 0;
+static bool adc_fifo_dreq = false;
+static bool adc_running = false;
+// canal da próxima conversão do modo livre e quando ela termina, em ns
+static uint adc_free_input = 0;
+static uint64_t adc_next_ns = 0;
+
+static uint64_t adc_conversion_ns(void) {
+    double cycles = adc_clkdiv + 1 < HOST_ADC_CONVERSION_CYCLES ? HOST_ADC_CONVERSION_CYCLES : adc_clkdiv + 1;
+    return (uint64_t) (cycles * 1e9 / HOST_ADC_CLOCK_HZ + 0.5);
+}
+
+static uintptr_t dma_next_address(uintptr_t address, uint increment, bool ring, uint ring_bits) {
+    uintptr_t next = address + increment;
+
+    if (ring && ring_bits > 0) {
+        uintptr_t mask = ((uintptr_t) 1 << ring_bits) - 1;
+        next = (address & ~mask) | (next & mask);
+    }
+
+    return next;
+}
+
+// escrita de um canal de DMA; nos registradores de nível do PWM, uma escrita
+// estreita vale para as duas metades, como no barramento do RP2040
+static void dma_write(uintptr_t address, enum dma_channel_transfer_size size, uint32_t value) {
+    for (uint slice = 0; slice < HOST_PWM_SLICES; slice++) {
+        if (address == (uintptr_t) &host_pwm_hw.slice[slice].cc) {
+            uint32_t levels = size == DMA_SIZE_32 ? value : size == DMA_SIZE_16 ? (value & 0xffff) * 0x10001u : (value & 0xff) * 0x01010101u;
+            host_pwm_hw.slice[slice].cc = levels;
+            pwm_set_chan_level(slice, PWM_CHAN_A, (uint16_t) levels);
+            pwm_set_chan_level(slice, PWM_CHAN_B, (uint16_t) (levels >> 16));
+            return;
+        }
+    }
+
+    switch (size) {
+        case DMA_SIZE_8: *(volatile uint8_t*) address = (uint8_t) value; break;
+        case DMA_SIZE_16: *(volatile uint16_t*) address = (uint16_t) value; break;
+        case DMA_SIZE_32: *(volatile uint32_t*) address = value; break;
+    }
+}
+
+static void dma_trigger(uint channel) {
+    HostDmaChannel* c = &dma_channels[channel];
+    c->remaining = c->transfer_count;
+    c->busy = c->remaining > 0;
+}
+
+// um canal terminou: dispara o encadeado e a interrupção
+static void dma_complete(uint channel) {
+    HostDmaChannel* c = &dma_channels[channel];
+    c->busy = false;
+
+    if (c->config.chain_to != channel) {
+        dma_trigger(c->config.chain_to);
+    }
+
+    if (c->irq0_enabled) {
+        dma_irq0_status |= 1u << channel;
+
+        if (irq_enabled[DMA_IRQ_0] && irq_handlers[DMA_IRQ_0] != NULL) {
+            irq_handlers[DMA_IRQ_0]();
+        }
+    }
+}
+
+// faz uma transferência do primeiro canal ocupado que espera por dreq
+static void dma_request(uint dreq) {
+    for (uint i = 0; i < HOST_DMA_CHANNELS; i++) {
+        HostDmaChannel* channel = &dma_channels[i];
+
+        if (!channel->busy || channel->config.dreq != dreq) {
+            continue;
+        }
+
+        uint size = 1u << channel->config.size;
+        uint32_t value;
+
+        switch (channel->config.size) {
+            case DMA_SIZE_8: value = *(volatile uint8_t*) channel->read_addr; break;
+            case DMA_SIZE_16: value = *(volatile uint16_t*) channel->read_addr; break;
+            default: value = *(volatile uint32_t*) channel->read_addr; break;
+        }
+
+        dma_write(channel->write_addr, channel->config.size, value);
+
+        if (channel->config.write_increment) {
+            channel->write_addr = dma_next_address(channel->write_addr, size, channel->config.ring_write, channel->config.ring_size_bits);
+        }
+
+        if (channel->config.read_increment) {
+            channel->read_addr = dma_next_address(channel->read_addr, size, !channel->config.ring_write, channel->config.ring_size_bits);
+        }
+
+        if (--channel->remaining == 0) {
+            dma_complete(i);
+        }
+
+        return;
+    }
+}
+
+// faz as conversões do modo livre que terminam até until_us
+static void adc_update(uint64_t until_us) {
+    if (!adc_running) {
+        return;
+    }
+
+    uint64_t until_ns = until_us * 1000ull;
+    uint64_t period_ns = adc_conversion_ns();
+
+    while (adc_next_ns <= until_ns) {
+        host_adc_hw.fifo = adc_values[adc_free_input];
+
+        if (adc_fifo_dreq) {
+            dma_request(DREQ_ADC);
+        }
+
+        // o próximo canal da máscara, dando a volta
+        if (adc_round_robin_mask != 0) {
+            do {
+                adc_free_input = (adc_free_input + 1) % HOST_ADC_CHANNELS;
+            } while ((adc_round_robin_mask & (1u << adc_free_input)) == 0);
+        }
+
+        adc_next_ns += period_ns;
+    }
+}
+
+static uint64_t dma_timer_tick_ns(const HostDmaTimer* timer, uint64_t tick) {
+    return timer->start_ns + (uint64_t) ((double) tick * timer->denominator * 1e9 / ((double) timer->numerator * HOST_SYS_CLOCK_HZ) + 0.5);
+}
+
+// faz os pedidos dos timers de ritmo que vencem até until_us, em ordem; com
+// o relógio manual, o relógio fica no instante de cada um
+static void dma_timers_update(uint64_t until_us) {
+    uint64_t until_ns = until_us * 1000ull;
+
+    while (true) {
+        HostDmaTimer* earliest = NULL;
+        uint64_t earliest_ns = 0;
+
+        for (int i = 0; i < HOST_DMA_TIMERS; i++) {
+            HostDmaTimer* timer = &dma_timers[i];
+
+            if (timer->numerator == 0 || timer->denominator == 0) {
+                continue;
+            }
+
+            uint64_t due_ns = dma_timer_tick_ns(timer, timer->ticks + 1);
+
+            if (due_ns <= until_ns && (earliest == NULL || due_ns < earliest_ns)) {
+                earliest = timer;
+                earliest_ns = due_ns;
+            }
+        }
+
+        if (earliest == NULL) {
+            return;
+        }
+
+        earliest->ticks++;
+
+        if (clock_manual && earliest_ns / 1000 > clock_manual_us) {
+            clock_manual_us = earliest_ns / 1000;
+        }
+
+        dma_request(dma_get_timer_dreq((uint) (earliest - dma_timers)));
+    }
+}
+
+static void peripherals_update(uint64_t until_us) {
+    adc_update(until_us);
+    dma_timers_update(until_us);
+}
+
+void adc_set_round_robin(uint input_mask) {
+    adc_round_robin_mask = input_mask & ((1u << HOST_ADC_CHANNELS) - 1);
+}
+
+void adc_set_clkdiv(float clkdiv) {
+    adc_clkdiv = clkdiv;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    (void) dreq_thresh;
+    (void) err_in_fifo;
+    (void) byte_shift;
+    adc_fifo_dreq = en && dreq_en;
+}
+
+void adc_run(bool run) {
+    if (run && !adc_running) {
+        adc_free_input = adc_selected_input;
+        adc_next_ns = time_us_64() * 1000ull + adc_conversion_ns();
+    } else if (!run) {
+        adc_update(time_us_64());
+    }
+
+    adc_running = run;
+}
+
+void adc_fifo_drain(void) {}
+
+int dma_claim_unused_channel(bool required) {
+    for (int i = 0; i < HOST_DMA_CHANNELS; i++) {
+        if (!dma_channels[i].claimed) {
+            dma_channels[i].claimed = true;
+            return i;
+        }
+    }
+
+    if (required) {
+        fprintf(stderr, "No DMA channels are free.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    dma_channels[channel].claimed = false;
+    dma_channels[channel].busy = false;
+    dma_channels[channel].irq0_enabled = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    return (dma_channel_config) {
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = DREQ_FORCE,
+        .chain_to = channel,
+    };
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->write_increment = incr;
+}
+
+void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits) {
+    c->ring_write = write;
+    c->ring_size_bits = size_bits;
+}
+
+void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+    c->dreq = dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config* c, uint chain_to) {
+    c->chain_to = chain_to;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr, const volatile void* read_addr, uint transfer_count, bool trigger) {
+    HostDmaChannel* c = &dma_channels[channel];
+    c->config = *config;
+    c->write_addr = (uintptr_t) write_addr;
+    c->read_addr = (uintptr_t) read_addr;
+    c->transfer_count = transfer_count;
+    c->remaining = transfer_count;
+    c->busy = false;
+
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger) {
+    dma_channels[channel].read_addr = (uintptr_t) read_addr;
+
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_start(uint channel) {
+    dma_trigger(channel);
+}
+
+void dma_start_channel_mask(uint32_t chan_mask) {
+    for (uint i = 0; i < HOST_DMA_CHANNELS; i++) {
+        if (chan_mask & (1u << i)) {
+            dma_trigger(i);
+        }
+    }
+}
+
+void dma_channel_abort(uint channel) {
+    dma_channels[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    return dma_channels[channel].busy;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    dma_channels[channel].irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+    return dma_irq0_status & (1u << channel);
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    dma_irq0_status &= ~(1u << channel);
+}
+
+int dma_claim_unused_timer(bool required) {
+    for (int i = 0; i < HOST_DMA_TIMERS; i++) {
+        if (!dma_timers[i].claimed) {
+            dma_timers[i].claimed = true;
+            return i;
+        }
+    }
+
+    if (required) {
+        fprintf(stderr, "No DMA timers are free.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return -1;
+}
+
+void dma_timer_unclaim(uint timer) {
+    dma_timers[timer] = (HostDmaTimer) { 0 };
+}
+
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator) {
+    HostDmaTimer* t = &dma_timers[timer];
+    peripherals_update(time_us_64());
+    t->numerator = numerator;
+    t->denominator = denominator;
+    t->start_ns = time_us_64() * 1000ull;
+    t->ticks = 0;
+}
+
+uint dma_get_timer_dreq(uint timer_num) {
+    return DREQ_DMA_TIMER0 + timer_num;
+}
+
+// ---------------------------------------------------------------------------
+// irq
+// ---------------------------------------------------------------------------
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (irq_handlers[num] != NULL && irq_handlers[num] != handler) {
+        fprintf(stderr, "IRQ %u already has a handler.\n", num);
+        exit(EXIT_FAILURE);
+    }
+
+    irq_handlers[num] = handler;
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+    if (irq_handlers[num] == handler) {
+        irq_handlers[num] = NULL;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    irq_enabled[num] = enabled;
+}
+
+// ---------------------------------------------------------------------------
+// pwm
+// ---------------------------------------------------------------------------
+
+uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1) & 7;
+}
+
+uint pwm_gpio_to_channel(uint gpio) {
+    return gpio & 1;
+}
+
+pwm_config pwm_get_default_config(void) {
+    return (pwm_config) { .csr = 0, .div = 1 << 4, .top = 0xffff };
+}
+
+void pwm_config_set_clkdiv(pwm_config* c, float div) {
+    c->div = (uint32_t) (div * 16.0f);
+}
+
+void pwm_config_set_wrap(pwm_config* c, uint16_t wrap) {
+    c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config* c, bool start) {
+    HostPwmSlice* slice = &pwm_slices[slice_num % HOST_PWM_SLICES];
+    slice->wrap = (uint16_t) c->top;
+    slice->clkdiv = c->div / 16.0f;
+    slice->enabled = start;
+}
+
+static void pwm_log_write(uint slice_num, int channel, uint16_t value) {
+    if (pwm_log_count < HOST_PWM_LOG_WRITES) {
+        pwm_log[pwm_log_count++] = (HostPwmWrite) { time_us_64(), slice_num, channel, value };
+    }
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+    pwm_slices[slice_num % HOST_PWM_SLICES].level[chan & 1] = level;
+    pwm_log_write(slice_num % HOST_PWM_SLICES, (int) (chan & 1), level);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    pwm_slices[slice_num % HOST_PWM_SLICES].wrap = wrap;
+    pwm_log_write(slice_num % HOST_PWM_SLICES, HOST_PWM_WRAP, wrap);
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+    pwm_slices[slice_num % HOST_PWM_SLICES].clkdiv = divider;
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) {
+    pwm_slices[slice_num % HOST_PWM_SLICES].clkdiv = integer + (fract & 15) / 16.0f;
+    pwm_log_write(slice_num % HOST_PWM_SLICES, HOST_PWM_CLKDIV, (uint16_t) (integer << 4 | (fract & 15)));
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    pwm_slices[slice_num % HOST_PWM_SLICES].enabled = enabled;
+}
+
+HostPwmSlice host_pwm_get_slice(uint slice_num) {
+    return pwm_slices[slice_num % HOST_PWM_SLICES];
+}
+
+void host_pwm_log_clear(void) {
+    pwm_log_count = 0;
+}
+
+uint host_pwm_log_count(void) {
+    return pwm_log_count;
+}
+
+HostPwmWrite host_pwm_log_get(uint index) {
+    return pwm_log[index % HOST_PWM_LOG_WRITES];
+}
+
+// ---------------------------------------------------------------------------
+// i2c, pio e clocks
+// ---------------------------------------------------------------------------
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate) {
+    (void) i2c;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    (void) i2c;
+    (void) addr;
+    (void) src;
+    (void) nostop;
+    i2c_bytes += len;
+    i2c_last_write_us = time_us_64();
+    return (int) len;
+}
+
+uint64_t host_i2c_bytes_written(void) {
+    return i2c_bytes;
+}
+
+uint64_t host_i2c_last_write_us(void) {
+    return i2c_last_write_us;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+    (void) pio;
+    (void) program;
+    return 0;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    (void) pio;
+    (void) required;
+    return 0;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    (void) pio;
+    (void) sm;
+    (void) data;
+    pio_words++;
+}
+
+uint64_t host_pio_words_written(void) {
+    return pio_words;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return clk_index == clk_adc ? HOST_ADC_CLOCK_HZ : HOST_SYS_CLOCK_HZ;
+}
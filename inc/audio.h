@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "./melody.h"
+
+// camadas do sequenciador, em ordem de prioridade: enquanto há efeitos na
+// fila a música fica pausada, e continua de onde parou depois deles
+#define AUDIO_EFFECTS 0
+#define AUDIO_MUSIC 1
+#define AUDIO_LAYERS 2
+
+// como uma melodia entra na camada: depois das que já estão nela, ou no
+// lugar delas, na hora
+#define AUDIO_QUEUE 0
+#define AUDIO_PREEMPT 1
+
+// notas esperando em cada camada (potência de 2)
+#define AUDIO_LAYER_NOTES 32
+
+typedef struct AudioLayer {
+  MelodyStep steps[AUDIO_LAYER_NOTES];
+  uint head;
+  uint count;
+  // o que faltava da nota da frente quando outra camada a interrompeu, ou 0
+  uint32_t remaining_us;
+} AudioLayer;
+
+bool audio_play(uint pin, int layer, const MelodyStep* melody, uint length, int mode);
+
+void audio_stop(void);
+
+bool audio_is_playing(void);
+
+void audio_wait(void);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "./types.h"
+#include "./game_engine.h"
+
+// índices das direções nas tabelas do piloto automático (a ordem das
+// constantes DIRECTION_*)
+#define AUTOPILOT_DIRECTIONS 4
+
+// quantas decisões usaram cada estratégia
+typedef struct AutopilotStats {
+  unsigned long decisions;
+  unsigned long food_paths;
+  unsigned long tail_paths;
+  unsigned long cycle_moves;
+  unsigned long area_moves;
+  unsigned long stuck;
+} AutopilotStats;
+
+typedef struct Autopilot {
+  int rows;
+  int cols;
+  int cells;
+  // vizinho de cada célula em cada direção, com a volta pelas bordas
+  uint16_t (*neighbors)[AUTOPILOT_DIRECTIONS];
+  // direção do ciclo hamiltoniano em cada célula, se o canvas tiver um
+  int8_t* cycle;
+  bool has_cycle;
+  // buffers da busca, alocados uma vez e reaproveitados a cada decisão
+  uint16_t* queue;
+  uint16_t* parent;
+  uint16_t* distance;
+  // em quantos movimentos cada célula fica livre (0 se já está livre)
+  uint16_t* free_at;
+  uint16_t* body;
+  // corpo que a cobra teria depois de seguir o caminho até a comida
+  uint16_t* virtual_body;
+  uint32_t* visited;
+  uint32_t generation;
+  AutopilotStats stats;
+} Autopilot;
+
+Autopilot* autopilot_init(int rows, int cols);
+
+Direction autopilot_decide(Autopilot* autopilot, GameState* state);
+
+void autopilot_free(Autopilot* autopilot);
@@ -2,14 +2,61 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "./types.h"
 #include "./constants.h"
 #include "./matrix.h"
+#include "./random.h"
 
-typedef Matrix Canvas;
 typedef MatrixDataType CanvasCell;
 typedef MatrixPosition CanvasPosition;
 
+// o armazenamento do canvas é escolhido em tempo de compilação (opção
+// CANVAS_BACKEND do CMake). Ambos implementam a mesma API abaixo.
+#if defined(CANVAS_BACKEND_BITBOARD)
+
+#define CANVAS_BACKEND "bitboard"
+// o mesmo, como número (gravado nos replays, veja replay.h)
+#define CANVAS_BACKEND_ID 1
+
+// uma camada de bits por tipo de célula ocupada (CELL_SNAKE_BODY até
+// CELL_OBSTACLE), a camada de um tipo é planes[cell - 1]
+#define CANVAS_PLANES 4
+
+typedef struct Canvas {
+  int rows;
+  int cols;
+  // quantidade de palavras de 64 bits de cada camada
+  int words;
+  uint64_t* planes[CANVAS_PLANES];
+  // união de todas as camadas. Os bits depois da última célula ficam sempre
+  // ligados, assim as células livres são exatamente os bits desligados
+  uint64_t* occupied;
+  // gerador usado para sortear posições livres
+  Random random;
+} Canvas;
+
+#else
+
+#define CANVAS_BACKEND "matrix"
+#define CANVAS_BACKEND_ID 0
+
+typedef struct Canvas {
+  int rows;
+  int cols;
+  Matrix* cells;
+  // conjunto das células livres: free_cells é um array denso com os índices
+  // lineares das células livres e free_cells_index diz onde cada célula está
+  // em free_cells (-1 se ocupada), o que permite inserir e remover em O(1)
+  int* free_cells;
+  int* free_cells_index;
+  int free_count;
+  // gerador usado para sortear posições livres
+  Random random;
+} Canvas;
+
+#endif
+
 void canvas_render(Canvas* canvas);
 
 CanvasCell canvas_get(Canvas *canvas, CanvasPosition position);
@@ -20,6 +67,8 @@ void canvas_clear(Canvas *canvas);
 
 Canvas* canvas_init(int n_rows, int n_cols);
 
+void canvas_seed(Canvas* canvas, uint64_t seed);
+
 void canvas_free(Canvas* canvas);
 
 Position* canvas_get_free_positions(Canvas* canvas, size_t* size);
@@ -27,3 +76,7 @@ Position* canvas_get_free_positions(Canvas* canvas, size_t* size);
 void canvas_get_random_free_position(Canvas* canvas, Position position);
 
 int canvas_count_free_positions(Canvas* canvas);
+
+int canvas_save(Canvas* canvas, CanvasCell* cells, uint16_t* free_order);
+
+void canvas_load(Canvas* canvas, const CanvasCell* cells, const uint16_t* free_order, int free_count);
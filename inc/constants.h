@@ -14,14 +14,21 @@
 #define ACTION_SETTINGS_SOUND_TOGGLE_SOUND_EFFECTS_MUTE 4
 #define ACTION_SETTINGS_SOUND_TOGGLE_MUSIC_MUTE 5
 #define ACTION_GO_BACK 6
+#define ACTION_SETTINGS_TOGGLE_AUTOPILOT 7
 
 #define CELL_UNUSED 0
 #define CELL_SNAKE_BODY 1
 #define CELL_SNAKE_HEAD 2
 #define CELL_FOOD 3
+#define CELL_OBSTACLE 4
 
 #define DIRECTION_NORTH 4
 #define DIRECTION_EAST 5
 #define DIRECTION_SOUTH 6
 #define DIRECTION_WEST 7
-#define DIRECTION_NONE 8
\ No newline at end of file
+#define DIRECTION_NONE 8
+
+// intervalo entre os ticks do jogo
+#define GAME_TICK_US 500000
+// intervalo entre as leituras do joystick durante o jogo
+#define INPUT_SAMPLE_US 2000
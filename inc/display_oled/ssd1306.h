@@ -3,6 +3,8 @@ extern void calculate_render_area_buffer_length(struct render_area *area);
 extern void ssd1306_send_command(uint8_t cmd);
 extern void ssd1306_send_command_list(uint8_t *ssd, int number);
 extern void ssd1306_send_buffer(uint8_t ssd[], int buffer_length);
+extern void ssd1306_write_command_list(const uint8_t *commands, int number);
+extern void ssd1306_write_buffer(const uint8_t *ssd, int buffer_length);
 extern RenderArea ssd1306_init();
 extern void ssd1306_scroll(bool set);
 extern void render_on_display(uint8_t *ssd, struct render_area *area);
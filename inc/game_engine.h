@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "./types.h"
+#include "./constants.h"
+#include "./canvas.h"
+#include "./snake.h"
+#include "./food.h"
+
+// eventos produzidos por um passo do jogo, combinados com |
+#define GAME_EVENT_NONE 0
+#define GAME_EVENT_MOVED (1 << 0)
+#define GAME_EVENT_ATE (1 << 1)
+#define GAME_EVENT_LOST (1 << 2)
+#define GAME_EVENT_WON (1 << 3)
+
+typedef uint32_t GameEvents;
+
+typedef struct GameInput {
+  // nova direção da cobra, DIRECTION_NONE mantém a atual
+  Direction direction;
+} GameInput;
+
+typedef struct GameState {
+  Canvas* canvas;
+  Snake* snake;
+  Food* food;
+  unsigned long ticks;
+  bool over;
+  bool won;
+  // semente com que o jogo foi iniciado
+  uint64_t seed;
+} GameState;
+
+GameState* game_state_init(int n_rows, int n_cols, uint64_t seed);
+
+void game_state_reset(GameState* state, uint64_t seed);
+
+void game_state_free(GameState* state);
+
+bool game_direction_is_valid(GameState* state, Direction direction);
+
+GameEvents game_step(GameState* state, GameInput input);
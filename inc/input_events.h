@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+#include "./types.h"
+
+// tipos de evento
+#define INPUT_EVENT_BUTTON_DOWN 0
+#define INPUT_EVENT_BUTTON_UP 1
+#define INPUT_EVENT_JOYSTICK 2
+
+// eventos esperando o loop (potência de 2)
+#define INPUT_EVENTS_CAPACITY 16
+
+// bordas de um botão mais próximas que isso da anterior são repique
+#define BUTTON_DEBOUNCE_US 20000
+
+// amostrador do joystick nos menus: rápido logo depois de uma entrada e
+// devagar quando o joystick fica parado, para acordar menos o processador
+#define MENU_SAMPLE_ACTIVE_US 20000
+#define MENU_SAMPLE_IDLE_US 100000
+#define MENU_IDLE_AFTER_US 2000000
+// repetição de uma direção segurada
+#define MENU_REPEAT_US 150000
+
+typedef struct InputEvent {
+  uint8_t type;
+  // BUTTON_A ou BUTTON_B nos eventos de botão
+  uint8_t button;
+  // direção nos eventos do joystick
+  Direction direction;
+  // instante da borda ou da amostra
+  uint64_t time_us;
+} InputEvent;
+
+typedef struct InputStats {
+  // vezes que input_wait_event acordou
+  uint32_t wakeups;
+  uint32_t events;
+  // eventos descartados com a fila cheia
+  uint32_t dropped;
+  // bordas descartadas pelo debounce
+  uint32_t bounces;
+} InputStats;
+
+extern InputStats input_stats;
+
+void input_events_init(void);
+
+bool input_events_pop(InputEvent* event);
+
+void input_events_clear(void);
+
+void input_wait_event(InputEvent* event);
+
+void input_wait_release(uint button);
+
+bool input_button_is_down(uint button);
+
+void input_menu_sampler_start(void);
+
+void input_menu_sampler_stop(void);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "./types.h"
+
+// mudanças de direção pendentes, uma consumida por tick (potência de 2)
+#define DIRECTION_QUEUE_CAPACITY 4
+
+typedef struct DirectionQueue {
+  volatile Direction items[DIRECTION_QUEUE_CAPACITY];
+  // posições de leitura (escrita só pelo loop) e de escrita (escrita só pelo
+  // amostrador), que crescem sem voltar e são reduzidas pela capacidade
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  // última direção enfileirada, contra a qual a próxima é validada
+  Direction last;
+  // mudanças válidas descartadas com a fila cheia
+  uint32_t dropped;
+} DirectionQueue;
+
+typedef struct InputSampler {
+  repeating_timer_t timer;
+  DirectionQueue* queue;
+  // direção lida na última amostra, para enfileirar só as mudanças
+  volatile Direction sample;
+  bool running;
+} InputSampler;
+
+void direction_queue_reset(DirectionQueue* queue, Direction current);
+
+bool direction_queue_push(DirectionQueue* queue, Direction direction);
+
+bool direction_queue_pop(DirectionQueue* queue, Direction* direction);
+
+bool direction_queue_is_empty(const DirectionQueue* queue);
+
+void input_sampler_start(InputSampler* sampler, DirectionQueue* queue, uint32_t interval_us);
+
+void input_sampler_stop(InputSampler* sampler);
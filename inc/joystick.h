@@ -1,7 +1,35 @@
 #pragma once
 
+#include <stdbool.h>
+#include "pico/types.h"
 #include "./types.h"
 
+// leitura máxima do ADC (12 bits) e o centro usado para as distâncias
+#define JOYSTICK_MAX ((1 << 12) - 1)
+#define JOYSTICK_CENTER (JOYSTICK_MAX / 2)
+
+// distâncias ao centro, em unidades do ADC, para o classificador inteiro:
+// entrar numa direção pede mais de 50% do raio (a mesma regra de
+// joystick_get_info), e ela só é largada abaixo de 40%
+#define JOYSTICK_ENTER_DISTANCE ((JOYSTICK_CENTER + 1) / 2)
+#define JOYSTICK_EXIT_DISTANCE (JOYSTICK_CENTER * 2 / 5)
+// quanto o outro eixo precisa passar do eixo da direção atual para virar
+#define JOYSTICK_AXIS_MARGIN (JOYSTICK_CENTER / 8)
+
+// conversões por segundo do ADC em modo livre, alternando os eixos y (canal
+// 0) e x (canal 1)
+#define JOYSTICK_CONVERSIONS_HZ 4000
+// amostras no anel preenchido pelo DMA (potência de 2): metade de cada eixo,
+// o que dá a média dos últimos 8 ms
+#define JOYSTICK_RING_SAMPLES 32
+#define JOYSTICK_RING_BITS 6
+// prefixo das linhas de SNAKE_JOYSTICK_TRACE, lidas por tools/joystick_trace.c
+#define JOYSTICK_TRACE_PREFIX "joystick: "
+// leituras do anel (cada uma com o anel renovado) na calibração do boot
+#define JOYSTICK_CALIBRATION_READS 8
+
+typedef struct JoystickConfig JoystickConfig;
+
 typedef struct JoystickInfo {
     // uint angle;
     Direction direction;
@@ -21,4 +49,24 @@ typedef struct JoystickInfo {
 
 void joystick_init();
 
-JoystickInfo joystick_get_info();
\ No newline at end of file
+JoystickInfo joystick_get_info();
+
+void joystick_sampler_start(void);
+
+void joystick_sampler_stop(void);
+
+bool joystick_sampler_is_running(void);
+
+void joystick_read_raw(uint* x_raw, uint* y_raw);
+
+Direction joystick_classify_deviation(Direction previous, int dx, int dy, int enter2, int exit2, int axis_margin);
+
+Direction joystick_classify(uint x_raw, uint y_raw);
+
+Direction joystick_classify_hysteresis(Direction previous, uint x_raw, uint y_raw);
+
+void joystick_configure(const JoystickConfig* config);
+
+bool joystick_calibrate(void);
+
+Direction joystick_get_direction(void);
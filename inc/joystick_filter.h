@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+#include "./types.h"
+#include "./joystick.h"
+
+// frações em ponto fixo Q8 (256 = 1)
+#define JOYSTICK_FILTER_ONE 256
+
+// menor alcance aceito para um lado de um eixo, em unidades do ADC, para que
+// um lado que ainda não foi inclinado não vire uma escala enorme
+#define JOYSTICK_MIN_RANGE (JOYSTICK_CENTER / 4)
+// o centro de repouso medido no boot só é aceito perto do centro nominal; mais
+// longe que isso, o joystick provavelmente estava inclinado
+#define JOYSTICK_CALIBRATION_MAX_OFFSET (JOYSTICK_CENTER / 4)
+
+// zonas mortas em porcentagem do alcance calibrado de cada lado, e
+// constantes de tempo dos filtros
+typedef struct JoystickConfig {
+  // entrar numa direção pede mais que enter_percent do alcance, e ela só é
+  // largada abaixo de exit_percent
+  uint8_t enter_percent;
+  uint8_t exit_percent;
+  // quanto o outro eixo precisa passar do eixo da direção atual para virar
+  uint8_t axis_margin_percent;
+  // alcance assumido de cada lado até o joystick ir mais longe, em
+  // porcentagem da distância do centro ao fim da escala
+  uint8_t initial_range_percent;
+  // constante de tempo do passa-baixa das leituras (0 desliga)
+  uint32_t filter_us;
+  // constante de tempo com que o centro segue as leituras em repouso
+  uint32_t center_us;
+} JoystickConfig;
+
+#define JOYSTICK_CONFIG_DEFAULT ((JoystickConfig) { \
+  .enter_percent = 50, \
+  .exit_percent = 40, \
+  .axis_margin_percent = 12, \
+  .initial_range_percent = 75, \
+  .filter_us = 4000, \
+  .center_us = 2000000, \
+})
+
+typedef struct JoystickAxis {
+  // leitura filtrada e centro, em Q8 de unidades do ADC
+  int32_t filtered;
+  int32_t center;
+  // maior distância ao centro já vista para baixo (0) e para cima (1), e a
+  // escala em Q8 que a leva a JOYSTICK_CENTER
+  int32_t range[2];
+  int32_t scale[2];
+} JoystickAxis;
+
+typedef struct JoystickFilter {
+  JoystickConfig config;
+  JoystickAxis x;
+  JoystickAxis y;
+  // limiares de config em unidades de JOYSTICK_CENTER, calculados uma vez
+  int32_t enter2;
+  int32_t exit2;
+  int32_t rest2;
+  int32_t axis_margin;
+  // 1/filter_us e 1/center_us em Q24
+  uint32_t filter_rate;
+  uint32_t center_rate;
+  Direction direction;
+  uint64_t last_us;
+  // sem leitura anterior, a primeira entra no filtro sem suavizar
+  bool primed;
+} JoystickFilter;
+
+void joystick_filter_init(JoystickFilter* filter, const JoystickConfig* config);
+
+bool joystick_filter_calibrate(JoystickFilter* filter, uint x_raw, uint y_raw);
+
+void joystick_filter_reset(JoystickFilter* filter);
+
+Direction joystick_filter_update(JoystickFilter* filter, uint x_raw, uint y_raw, uint64_t now_us);
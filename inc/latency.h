@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// sondas de latência, da mudança de direção no joystick até os LEDs e o
+// OLED. Só existem com SNAKE_LATENCY_PROBES (opção de mesmo nome no CMake);
+// sem ela as macros abaixo não geram código nenhum
+
+// instantes marcados pelas sondas
+#define LATENCY_MARK_INPUT 0
+#define LATENCY_MARK_TICK 1
+#define LATENCY_MARK_OLED 2
+#define LATENCY_MARK_AUDIO 3
+#define LATENCY_MARKS 4
+
+// trechos medidos, cada um com seu histograma
+#define LATENCY_INPUT_TO_TICK 0
+#define LATENCY_TICK_TO_LEDS 1
+#define LATENCY_INPUT_TO_LEDS 2
+#define LATENCY_OLED_FLUSH 3
+#define LATENCY_INPUT_TO_OLED 4
+#define LATENCY_AUDIO 5
+#define LATENCY_SPANS 6
+
+// faixas do histograma: valores exatos até 7 us e depois 4 faixas por
+// potência de 2 (erro de até 25%), o que cobre todo o uint32_t
+#define LATENCY_BUCKETS 128
+
+typedef struct LatencyHistogram {
+  uint32_t buckets[LATENCY_BUCKETS];
+  uint32_t count;
+  uint32_t max_us;
+} LatencyHistogram;
+
+// marcas levadas por um comando ao core de saída (output.h): o core0 as tira
+// com LATENCY_TAKE ao enviar o comando, e o core1 fecha os trechos com
+// LATENCY_RECORD sem ler as marcas, que são só do core0
+typedef struct LatencyStamps {
+  uint64_t us[LATENCY_MARKS];
+} LatencyStamps;
+
+#if SNAKE_LATENCY_PROBES
+
+void latency_mark(int mark);
+
+void latency_mark_first(int mark);
+
+void latency_clear(int mark);
+
+void latency_span(int span, int mark);
+
+void latency_take(LatencyStamps* stamps, int mark);
+
+void latency_record(int span, const LatencyStamps* stamps, int mark);
+
+void latency_reset(void);
+
+void latency_dump(void);
+
+void latency_poll(void);
+
+const LatencyHistogram* latency_histogram(int span);
+
+uint32_t latency_percentile_us(const LatencyHistogram* histogram, double percentile);
+
+#define LATENCY_MARK(mark) latency_mark(mark)
+#define LATENCY_MARK_FIRST(mark) latency_mark_first(mark)
+#define LATENCY_CLEAR(mark) latency_clear(mark)
+#define LATENCY_SPAN(span, mark) latency_span(span, mark)
+#define LATENCY_TAKE(stamps, mark) latency_take(stamps, mark)
+#define LATENCY_RECORD(span, stamps, mark) latency_record(span, stamps, mark)
+#define LATENCY_POLL() latency_poll()
+
+#else
+
+#define LATENCY_MARK(mark) ((void) 0)
+#define LATENCY_MARK_FIRST(mark) ((void) 0)
+#define LATENCY_CLEAR(mark) ((void) 0)
+#define LATENCY_SPAN(span, mark) ((void) 0)
+#define LATENCY_TAKE(stamps, mark) ((void) 0)
+#define LATENCY_RECORD(span, stamps, mark) ((void) 0)
+#define LATENCY_POLL() ((void) 0)
+
+#endif
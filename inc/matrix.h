@@ -1,11 +1,14 @@
 #pragma once
 
-typedef int MatrixDataType;
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t MatrixDataType;
 
 typedef struct Matrix {
   int rows;
   int cols;
-  MatrixDataType** data;
+  MatrixDataType* data;
 } Matrix;
 
 typedef int MatrixPosition[2];
@@ -16,4 +19,14 @@ MatrixDataType matrix_get(Matrix* matrix, MatrixPosition position);
 
 void matrix_put(Matrix* matrix, MatrixPosition position, MatrixDataType val);
 
+void matrix_fill(Matrix* matrix, MatrixDataType val);
+
+size_t matrix_size(Matrix* matrix);
+
 void matrix_free(Matrix* matrix);
+
+// índice linear (row-major) de uma posição, usado por quem precisa percorrer
+// a matriz inteira sem o custo de montar uma MatrixPosition por célula
+static inline size_t matrix_index(Matrix* matrix, int row, int col) {
+  return (size_t) row * (size_t) matrix->cols + (size_t) col;
+}
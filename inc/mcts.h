@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "./types.h"
+#include "./random.h"
+#include "./game_engine.h"
+#include "./snapshot.h"
+
+#define MCTS_DIRECTIONS 4
+#define MCTS_NO_NODE UINT32_MAX
+
+// tamanho padrão da arena de nodes: no RP2040 a arena precisa caber na RAM
+// junto com o resto do jogo (1024 nodes são 24 KB)
+#if PICO_ON_DEVICE
+#define MCTS_DEFAULT_NODE_CAPACITY 1024
+#define MCTS_DEFAULT_BUDGET_US 50000
+#else
+#define MCTS_DEFAULT_NODE_CAPACITY 65536
+#define MCTS_DEFAULT_BUDGET_US 1000
+#endif
+
+typedef struct MctsNode {
+  // filho de cada direção (na ordem das constantes DIRECTION_*), MCTS_NO_NODE
+  // se ainda não foi expandido
+  uint32_t children[MCTS_DIRECTIONS];
+  uint32_t visits;
+  // soma dos valores das simulações que passaram pelo node, entre 0 e 1
+  float value;
+} MctsNode;
+
+typedef struct MctsConfig {
+  // quantos nodes a arena comporta; com a arena cheia a árvore para de crescer
+  // e as simulações continuam a partir das folhas
+  uint32_t node_capacity;
+  // tempo de cada decisão, em microssegundos (0 não limita)
+  uint32_t budget_us;
+  // simulações de cada decisão (0 não limita); com budget_us igual a 0 as
+  // decisões não dependem do relógio
+  uint32_t max_rollouts;
+  // movimentos de cada simulação depois de sair da árvore
+  int rollout_depth;
+  // constante de exploração do UCT
+  float exploration;
+  // semente das comidas sorteadas nas simulações e da política aleatória
+  uint64_t seed;
+} MctsConfig;
+
+typedef struct MctsStats {
+  unsigned long decisions;
+  unsigned long long rollouts;
+  unsigned long long rollout_moves;
+  // decisões em que a arena encheu
+  unsigned long arena_full;
+  // tempo gasto decidindo, em microssegundos
+  uint64_t elapsed_us;
+} MctsStats;
+
+typedef struct Mcts {
+  MctsConfig config;
+  MctsNode* nodes;
+  uint32_t node_count;
+  // nodes visitados pela simulação atual, da raiz à folha
+  uint32_t* path;
+  // jogo onde as simulações acontecem, restaurado de root a cada uma
+  GameState* scratch;
+  GameSnapshot root;
+  Random random;
+  MctsStats stats;
+} Mcts;
+
+MctsConfig mcts_default_config(int rows, int cols);
+
+Mcts* mcts_init(int rows, int cols, MctsConfig config);
+
+Direction mcts_decide(Mcts* mcts, GameState* state);
+
+void mcts_free(Mcts* mcts);
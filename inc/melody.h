@@ -1,30 +1,34 @@
+#pragma once
+
+#include <stdint.h>
 #include "pico/types.h"
 
-typedef uint Melody[][2];
+// o que tone_on escreve no PWM para tocar uma nota: o wrap e o divisor de
+// clock em 8.4 (inteiro e dezesseis avos)
+typedef struct NotePwm {
+  uint16_t wrap;
+  uint8_t div_int;
+  uint8_t div_frac;
+} NotePwm;
+
+// um passo de uma melodia: o índice da nota em note_pwm (NOTE_*, 0 para a
+// pausa) nos 6 bits de cima e a duração em ticks de MELODY_TICK_US nos 10
+// de baixo
+typedef uint16_t MelodyStep;
+
+#define MELODY_STEP(note, ticks) ((MelodyStep) ((note) << 10 | (ticks)))
+#define MELODY_STEP_NOTE(step) ((step) >> 10)
+#define MELODY_STEP_TICKS(step) ((step) & 0x3ff)
 
-#define NOTE_C4 29886
-#define NOTE_Cs4 28294
-#define NOTE_C5 14929
-#define NOTE_C6 7465
-#define NOTE_D4 26795
-#define NOTE_D5 13298
-#define NOTE_DS4 25386
-#define NOTE_E4 24063
-#define NOTE_F4 22823
-#define NOTE_FS5 9561
-#define NOTE_Fs4 21663
-#define NOTE_G4 20579
-#define NOTE_G5 8966
-#define NOTE_GS5 9409
-#define NOTE_GS4 19569
-#define NOTE_A4 18630
-#define NOTE_AS4 177758
-#define NOTE_AS5 8380
-#define NOTE_AS3 33498
-#define NOTE_B4 16952
+// gerado na compilação por tools/gen_melodies.py a partir de
+// src/melodies.score: as notas NOTE_*, a tabela note_pwm, as melodias
+// melody_* e MELODY_TICK_US
+#include "melody_tables.h"
 
-void play_melody(uint pin, Melody melody, uint melody_length);
+void tone_on(uint pin, uint note);
+void tone_off(uint pin);
+void play_melody(uint pin, const MelodyStep* melody, uint melody_length);
 void play_game_won(uint pin);
 void play_game_over(uint pin);
 void play_bite(uint pin);
-void play_selection_move(uint pin);
\ No newline at end of file
+void play_selection_move(uint pin);
@@ -25,6 +25,8 @@ void npClear();
 
 void npWrite();
 
+void npWriteBuffer(const npLED_t* buffer);
+
 int getIndex(int x, int y);
 
 void setSpriteLEDs(int sprite[5][5][3]);
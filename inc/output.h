@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "pico/types.h"
+#include "./neopixel.h"
+#include "./latency.h"
+#include "./display_oled/ssd1306_i2c.h"
+
+// comandos enviados pelo core0 ao core de saída
+#define OUTPUT_LEDS 0
+#define OUTPUT_OLED_COMMANDS 1
+#define OUTPUT_OLED_BUFFER 2
+#define OUTPUT_STOP 3
+
+// comandos na fila entre os cores (potência de 2)
+#define OUTPUT_QUEUE_CAPACITY 8
+// listas maiores são divididas em vários comandos
+#define OUTPUT_OLED_MAX_COMMANDS 32
+
+typedef struct OutputCommand {
+  uint16_t type;
+  // bytes de oled_commands ou oled_buffer
+  uint16_t length;
+#if SNAKE_LATENCY_PROBES
+  // marcas tiradas pelo core0 ao enviar, fechadas pelo core1 (veja latency.c)
+  LatencyStamps latency;
+#endif
+  union {
+    npLED_t leds[LED_COUNT];
+    uint8_t oled_commands[OUTPUT_OLED_MAX_COMMANDS];
+    uint8_t oled_buffer[ssd1306_buffer_length];
+  };
+} OutputCommand;
+
+// fila de um produtor (core0) e um consumidor (core1), sem travas
+typedef struct OutputQueue {
+  OutputCommand items[OUTPUT_QUEUE_CAPACITY];
+  // posições de leitura (escrita só pelo consumidor) e de escrita (escrita
+  // só pelo produtor), que crescem sem voltar
+  _Atomic uint32_t head;
+  _Atomic uint32_t tail;
+} OutputQueue;
+
+void output_queue_init(OutputQueue* queue);
+
+OutputCommand* output_queue_reserve(OutputQueue* queue);
+
+void output_queue_publish(OutputQueue* queue);
+
+OutputCommand* output_queue_peek(OutputQueue* queue);
+
+void output_queue_release(OutputQueue* queue);
+
+bool output_queue_is_empty(OutputQueue* queue);
+
+void output_start(void);
+
+void output_stop(void);
+
+bool output_is_running(void);
+
+void output_flush(void);
+
+bool output_post_leds(const npLED_t* leds);
+
+bool output_post_oled_commands(const uint8_t* commands, int count);
+
+bool output_post_oled_buffer(const uint8_t* buffer, int length);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// gerador PCG32 (XSH RR): 64 bits de estado, um incremento ímpar que escolhe
+// a sequência, e saídas de 32 bits
+typedef struct Random {
+  uint64_t state;
+  uint64_t increment;
+} Random;
+
+void random_seed(Random* random, uint64_t seed);
+
+uint32_t random_next(Random* random);
+
+uint64_t random_next64(Random* random);
+
+uint32_t random_bounded(Random* random, uint32_t bound);
+
+int random_range(Random* random, int min, int max);
+
+Random* random_default();
+
+uint64_t random_entropy_seed();
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "./types.h"
+#include "./game_engine.h"
+
+// formato: cabeçalho de REPLAY_HEADER_SIZE bytes ("SNKR", versão, backend do
+// canvas, linhas e colunas em 16 bits e a semente, em little endian) seguido
+// de eventos, cada um um varint (LEB128) de (ticks desde o evento anterior
+// << 3) | código. Os backends sorteiam comidas diferentes para a mesma
+// semente, então uma gravação só é reproduzida com o backend em que foi feita
+#define REPLAY_MAGIC "SNKR"
+#define REPLAY_VERSION 2
+#define REPLAY_HEADER_SIZE 18
+
+// maior número de linhas ou colunas que cabe no cabeçalho
+#define REPLAY_MAX_SIDE UINT16_MAX
+
+// códigos de evento
+#define REPLAY_CODE_NORTH 0
+#define REPLAY_CODE_EAST 1
+#define REPLAY_CODE_SOUTH 2
+#define REPLAY_CODE_WEST 3
+#define REPLAY_CODE_BUTTON_A 4
+#define REPLAY_CODE_BUTTON_B 5
+#define REPLAY_CODE_END 7
+
+// tamanho do buffer do gravador: quando o próximo evento pode não caber, o
+// buffer é entregue ao destino e volta a ficar vazio
+#define REPLAY_BUFFER_SIZE 32
+
+// maior evento codificado (um varint de 64 bits)
+#define REPLAY_MAX_EVENT_SIZE 10
+
+// prefixo das linhas escritas por replay_stdio_sink
+#define REPLAY_STDIO_PREFIX "replay: "
+
+// blocos do gravador esperando na caixa de saída (potência de 2)
+#define REPLAY_OUTBOX_BLOCKS 8
+
+typedef void (*ReplaySink)(const uint8_t* data, size_t length, void* context);
+
+typedef struct ReplayWriter {
+  uint8_t buffer[REPLAY_BUFFER_SIZE];
+  size_t length;
+  unsigned long last_tick;
+  // total de bytes gravados, contando os já entregues ao destino
+  size_t written;
+  ReplaySink sink;
+  void* sink_context;
+} ReplayWriter;
+
+// fila de blocos entre o gravador, no tick, e a serial, escrita fora dele
+typedef struct ReplayOutbox {
+  uint8_t blocks[REPLAY_OUTBOX_BLOCKS][REPLAY_BUFFER_SIZE];
+  uint8_t lengths[REPLAY_OUTBOX_BLOCKS];
+  // posições de leitura e de escrita, que crescem sem voltar
+  uint32_t head;
+  uint32_t tail;
+  // blocos descartados: com a caixa cheia, e todos depois do primeiro
+  unsigned long dropped;
+} ReplayOutbox;
+
+typedef struct ReplayEvent {
+  unsigned long tick;
+  int code;
+} ReplayEvent;
+
+typedef struct ReplayReader {
+  const uint8_t* data;
+  size_t length;
+  size_t offset;
+  unsigned long tick;
+  // CANVAS_BACKEND_ID de quem gravou
+  int backend;
+  int rows;
+  int cols;
+  uint64_t seed;
+  bool ended;
+} ReplayReader;
+
+typedef struct ReplayResult {
+  bool valid;
+  unsigned long ticks;
+  int snake_size;
+  bool won;
+  bool lost;
+  // botão que interrompeu o jogo (BUTTON_A ou BUTTON_B), ou -1
+  int button;
+  // gravada com outro backend do canvas, e por isso não reproduzida
+  bool wrong_backend;
+} ReplayResult;
+
+typedef void (*ReplayTickCallback)(GameState* state, GameEvents events, void* context);
+
+void replay_writer_init(ReplayWriter* writer, int rows, int cols, uint64_t seed, ReplaySink sink, void* sink_context);
+
+void replay_record_direction(ReplayWriter* writer, unsigned long tick, Direction direction);
+
+void replay_record_button(ReplayWriter* writer, unsigned long tick, int button);
+
+void replay_writer_finish(ReplayWriter* writer, unsigned long tick);
+
+void replay_writer_flush(ReplayWriter* writer);
+
+void replay_stdio_sink(const uint8_t* data, size_t length, void* context);
+
+void replay_outbox_init(ReplayOutbox* outbox);
+
+void replay_outbox_sink(const uint8_t* data, size_t length, void* context);
+
+bool replay_outbox_drain(ReplayOutbox* outbox);
+
+void replay_outbox_flush(ReplayOutbox* outbox);
+
+bool replay_reader_init(ReplayReader* reader, const uint8_t* data, size_t length);
+
+bool replay_reader_next(ReplayReader* reader, ReplayEvent* event);
+
+Direction replay_code_to_direction(int code);
+
+ReplayResult replay_play(const uint8_t* data, size_t length, uint32_t tick_ms, ReplayTickCallback on_tick, void* context);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+typedef struct TickScheduler {
+  repeating_timer_t timer;
+  // ticks disparados pelo alarme (escrito só na interrupção) e ticks já
+  // consumidos pelo loop (escrito só fora dela)
+  volatile uint32_t fired;
+  uint32_t consumed;
+  // intervalo entre ticks, aplicado a partir do próximo disparo
+  volatile uint32_t interval_us;
+  // instante previsto e instante real do último disparo
+  volatile uint64_t expected_us;
+  volatile uint64_t fired_us;
+  // maior atraso de um disparo em relação ao instante previsto
+  volatile uint32_t max_jitter_us;
+  // ticks descartados porque o loop só os viu depois do tick seguinte
+  uint32_t missed;
+  bool running;
+} TickScheduler;
+
+void tick_scheduler_start(TickScheduler* scheduler, uint32_t interval_us);
+
+void tick_scheduler_stop(TickScheduler* scheduler);
+
+void tick_scheduler_restart(TickScheduler* scheduler);
+
+void tick_scheduler_set_interval(TickScheduler* scheduler, uint32_t interval_us);
+
+bool tick_scheduler_take(TickScheduler* scheduler);
@@ -15,8 +15,13 @@ typedef struct {
     GameSettingsSoundMusic music;
 } GameSettingsSound;
 
+typedef struct {
+    bool enabled;
+} GameSettingsAutopilot;
+
 typedef struct {
     GameSettingsSound sound;
+    GameSettingsAutopilot autopilot;
 } GameSettings;
 
 extern GameSettings settings;
@@ -10,20 +10,29 @@
 #include "./canvas.h"
 
 typedef struct Snake {
+  // buffer circular com as posições dos nodes, com capacidade para a cobra
+  // ocupar o canvas inteiro. A cabeça fica em node_positions[head] e os nodes
+  // seguintes ficam nos índices anteriores (com circularidade).
   Position* node_positions;
+  int capacity;
+  int head;
+  // quantos movimentos ainda devem manter a cauda no lugar (crescimento)
+  int pending_growth;
   Direction direction;
   bool in_canvas;
+  // se o último movimento levou a cabeça para uma célula do próprio corpo
+  bool self_collided;
   int size;
 } Snake;
 
 bool snake_node_is_head(Snake* snake, int node_index);
 
+void snake_get_node_position(Snake* snake, int node_index, Position node_position);
+
 void snake_get_head_position(Snake* snake, Position head_position);
 
 void get_next_node_position(Snake* snake, Canvas* canvas, int node_index, Position next_node_position);
 
-void snake_get_new_node_position(Snake* snake, Canvas* canvas, Position node_position);
-
 void snake_grow(Snake *snake, Canvas* canvas);
 
 void snake_free(Snake* snake);
@@ -32,6 +41,8 @@ void snake_remove(Snake* snake, Canvas* canvas);
 
 void snake_move(Snake* snake, Canvas* canvas);
 
+bool snake_next_move_collides(Snake* snake, Canvas* canvas);
+
 bool snake_self_collides(Snake* snake);
 
 Snake* snake_init(Canvas* canvas, Position position, Direction direction, int size);
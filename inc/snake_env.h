@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ambiente de aprendizado por reforço com as regras do jogo (as mesmas de
+// game_step), para treinar agentes no host: muitos jogos avançam numa chamada
+
+// ações: índice da direção (na ordem das constantes DIRECTION_*) ou manter a
+// direção atual
+#define SNAKE_ENV_ACTION_NORTH 0
+#define SNAKE_ENV_ACTION_EAST 1
+#define SNAKE_ENV_ACTION_SOUTH 2
+#define SNAKE_ENV_ACTION_WEST 3
+#define SNAKE_ENV_ACTION_KEEP 4
+
+// motivo do fim de um episódio, em dones
+#define SNAKE_ENV_RUNNING 0
+#define SNAKE_ENV_LOST 1
+#define SNAKE_ENV_WON 2
+#define SNAKE_ENV_TRUNCATED 3
+
+// recompensas
+#define SNAKE_ENV_REWARD_FOOD 1.0f
+#define SNAKE_ENV_REWARD_LOSS -1.0f
+#define SNAKE_ENV_REWARD_WIN 10.0f
+
+// planos da observação de cada ambiente, cada um um bitboard de
+// snake_env_plane_words palavras de 64 bits (bit row * cols + col)
+#define SNAKE_ENV_PLANE_BODY 0
+#define SNAKE_ENV_PLANE_HEAD 1
+#define SNAKE_ENV_PLANE_FOOD 2
+#define SNAKE_ENV_PLANES 3
+
+typedef struct SnakeEnv SnakeEnv;
+
+SnakeEnv* snake_env_create(int count, int rows, int cols);
+
+void snake_env_destroy(SnakeEnv* env);
+
+int snake_env_count(const SnakeEnv* env);
+
+int snake_env_plane_words(const SnakeEnv* env);
+
+void snake_env_set_max_ticks(SnakeEnv* env, uint32_t max_ticks);
+
+void snake_env_reset(SnakeEnv* env, uint64_t seed);
+
+void snake_env_step(SnakeEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones);
+
+void snake_env_observe(const SnakeEnv* env, uint64_t* planes);
+
+const uint16_t* snake_env_lengths(const SnakeEnv* env);
+
+const uint32_t* snake_env_ticks(const SnakeEnv* env);
+
+const uint64_t* snake_env_seeds(const SnakeEnv* env);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "./game_engine.h"
+
+#define SNAPSHOT_MAGIC 0x534b4e53u
+#define SNAPSHOT_VERSION 1
+
+// maior canvas que cabe num snapshot (16x16)
+#define SNAPSHOT_MAX_CELLS 256
+
+#define SNAPSHOT_NO_CELL 0xffff
+
+#define SNAPSHOT_FLAG_OVER (1 << 0)
+#define SNAPSHOT_FLAG_WON (1 << 1)
+#define SNAPSHOT_FLAG_SELF_COLLIDED (1 << 2)
+#define SNAPSHOT_FLAG_FOOD_IN_CANVAS (1 << 3)
+
+// estado de um jogo sem ponteiros e sem bytes de preenchimento (veja
+// ../src/snapshot.c)
+typedef struct GameSnapshot {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t rows;
+  uint8_t cols;
+  uint64_t seed;
+  uint64_t random_state;
+  uint64_t random_increment;
+  uint32_t ticks;
+  uint16_t snake_size;
+  uint16_t snake_pending_growth;
+  uint16_t free_count;
+  uint16_t food_cell;
+  uint8_t snake_direction;
+  uint8_t flags;
+  uint8_t reserved[2];
+  // células do canvas em ordem de linha
+  uint8_t cells[SNAPSHOT_MAX_CELLS];
+  // células dos nodes da cobra, a partir da cabeça
+  uint16_t body[SNAPSHOT_MAX_CELLS];
+  // células livres na ordem usada pelos sorteios do canvas
+  uint16_t free_order[SNAPSHOT_MAX_CELLS];
+} GameSnapshot;
+
+_Static_assert(sizeof(GameSnapshot) == 48 + SNAPSHOT_MAX_CELLS * 5, "GameSnapshot must not have padding");
+
+bool game_snapshot_save(GameState* state, GameSnapshot* snapshot);
+
+bool game_snapshot_load(GameState* state, const GameSnapshot* snapshot);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+
+// vozes mixadas ao mesmo tempo
+#define SYNTH_VOICES 4
+
+// formas de onda de uma voz
+#define SYNTH_OFF 0
+#define SYNTH_SQUARE 1
+#define SYNTH_TRIANGLE 2
+// ruído de um LFSR de 15 bits, que anda um passo a cada ciclo da frequência
+#define SYNTH_NOISE 3
+// amostras PCM de 8 bits com sinal, tocadas uma vez
+#define SYNTH_PCM 4
+
+#define SYNTH_VOLUME_MAX 255
+
+// amostras mixadas de uma vez, na pilha, por synth_mix
+#define SYNTH_MIX_BLOCK 64
+
+typedef struct SynthVoice {
+  uint8_t wave;
+  uint8_t volume;
+  // registrador do ruído
+  uint16_t noise;
+  // fase em Q32 de um ciclo (em SYNTH_PCM, a posição no PCM em Q16) e
+  // quanto ela anda por amostra de saída
+  uint32_t phase;
+  uint32_t step;
+  const int8_t* pcm;
+  // fim do PCM em Q16
+  uint32_t pcm_end;
+  // amostras de saída até a voz calar, ou 0 para tocar até synth_stop
+  uint32_t remaining;
+} SynthVoice;
+
+typedef struct Synth {
+  uint sample_rate;
+  SynthVoice voices[SYNTH_VOICES];
+} Synth;
+
+void synth_init(Synth* synth, uint sample_rate);
+
+void synth_play(Synth* synth, uint voice, uint8_t wave, uint frequency, uint8_t volume, uint32_t duration_us);
+
+void synth_play_pcm(Synth* synth, uint voice, const int8_t* pcm, uint length, uint pcm_rate, uint8_t volume);
+
+void synth_stop(Synth* synth, uint voice);
+
+bool synth_is_playing(const Synth* synth, uint voice);
+
+void synth_mix(Synth* synth, uint16_t* levels, uint count, uint16_t top);
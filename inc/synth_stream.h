@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdbool.h>
+#include "pico/types.h"
+#include "./synth.h"
+
+// níveis no buffer do DMA: duas metades, uma tocando enquanto a outra é
+// mixada
+#define SYNTH_BUFFER_SAMPLES 256
+#define SYNTH_HALF_SAMPLES (SYNTH_BUFFER_SAMPLES / 2)
+
+// o PWM conta até SYNTH_PWM_TOP no clk_sys: 8 bits por amostra, com a
+// portadora (488 kHz a 125 MHz) bem acima do que se ouve
+#define SYNTH_PWM_TOP 255
+
+bool synth_stream_start(Synth* synth, uint pin);
+
+void synth_stream_stop(void);
+
+bool synth_stream_is_running(void);
+
+uint synth_stream_rate(void);
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "../inc/melody.h"
+#include "../inc/latency.h"
+#include "../inc/audio.h"
+
+// =============================================================
+// AUDIO
+// Sequenciador de notas do buzzer movido por um alarme: audio_play só põe
+// as notas numa fila e retorna, e o alarme, que vence no fim de cada nota,
+// reprograma o PWM para a seguinte (ou o desliga) e se arma para o fim dela.
+// Entre uma nota e outra não há nada rodando, e o tick do jogo segue.
+//
+// Há duas filas: a dos efeitos (mordida, menu), que tem prioridade, e a da
+// música. Um efeito que chega com a música tocando a interrompe; quando os
+// efeitos acabam, a nota interrompida volta pelo tempo que faltava e a
+// música segue. Em cada fila, AUDIO_QUEUE toca a melodia depois das que já
+// estão esperando e AUDIO_PREEMPT a toca na hora, descartando as outras.
+//
+// O alarme e o loop do jogo são do core0: as filas são mexidas com as
+// interrupções desligadas.
+// =============================================================
+
+static AudioLayer layers[AUDIO_LAYERS];
+static uint audio_pin;
+// camada da nota que está soando, ou -1 em silêncio, e quando ela acaba
+static int playing = -1;
+static uint64_t note_end_us;
+static repeating_timer_t timer;
+static bool timer_running = false;
+
+static MelodyStep layer_front(const AudioLayer* layer) {
+  return layer->steps[layer->head % AUDIO_LAYER_NOTES];
+}
+
+static uint32_t step_duration_us(MelodyStep step) {
+  return MELODY_STEP_TICKS(step) * MELODY_TICK_US;
+}
+
+static void layer_pop(AudioLayer* layer) {
+  layer->head++;
+  layer->count--;
+  layer->remaining_us = 0;
+}
+
+static void layer_clear(AudioLayer* layer) {
+  layer->head = 0;
+  layer->count = 0;
+  layer->remaining_us = 0;
+}
+
+// a camada de maior prioridade com notas, ou -1
+static int top_layer(void) {
+  for (int i = 0; i < AUDIO_LAYERS; i++) {
+    if (layers[i].count > 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static void sound(MelodyStep step) {
+  if (MELODY_STEP_NOTE(step) == NOTE_REST) {
+    tone_off(audio_pin);
+  } else {
+    tone_on(audio_pin, MELODY_STEP_NOTE(step));
+  }
+}
+
+// põe para tocar a nota certa para now e retorna quando ela acaba, ou 0 em
+// silêncio
+static uint64_t audio_advance(uint64_t now) {
+  // notas acabadas saem da fila; a seguinte começa quando a anterior acabou,
+  // mesmo que o alarme tenha chegado atrasado
+  while (playing >= 0 && now >= note_end_us) {
+    AudioLayer* layer = &layers[playing];
+    layer_pop(layer);
+
+    // a camada acabou: o que vier depois (outra camada ou o silêncio)
+    // começa no fim da última nota
+    if (layer->count == 0) {
+      now = note_end_us;
+      break;
+    }
+
+    note_end_us += step_duration_us(layer_front(layer));
+    sound(layer_front(layer));
+  }
+
+  int top = top_layer();
+
+  if (top == playing) {
+    return playing >= 0 ? note_end_us : 0;
+  }
+
+  // outra camada passou na frente: guarda o que faltava da nota interrompida
+  // (0 se a camada acabou)
+  if (playing >= 0) {
+    layers[playing].remaining_us = (uint32_t) (note_end_us - now);
+  }
+
+  playing = top;
+
+  if (top < 0) {
+    tone_off(audio_pin);
+    LATENCY_SPAN(LATENCY_AUDIO, LATENCY_MARK_AUDIO);
+    return 0;
+  }
+
+  AudioLayer* layer = &layers[top];
+  MelodyStep step = layer_front(layer);
+  note_end_us = now + (layer->remaining_us > 0 ? layer->remaining_us : step_duration_us(step));
+  sound(step);
+
+  return note_end_us;
+}
+
+static bool audio_alarm(repeating_timer_t* timer) {
+  uint64_t now = time_us_64();
+  uint64_t end = audio_advance(now);
+
+  timer_running = end > 0;
+  timer->delay_us = -(int64_t) (end > now ? end - now : 1);
+
+  return timer_running;
+}
+
+// arma o alarme para o fim da nota atual, com as interrupções desligadas
+static void audio_schedule(uint64_t now) {
+  if (timer_running) {
+    cancel_repeating_timer(&timer);
+    timer_running = false;
+  }
+
+  uint64_t end = audio_advance(now);
+
+  if (end == 0) {
+    return;
+  }
+
+  if (!add_repeating_timer_us(-(int64_t) (end > now ? end - now : 1), audio_alarm, NULL, &timer)) {
+    fprintf(stderr, "No alarm slots available for the audio sequencer.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  timer_running = true;
+}
+
+// põe uma melodia na fila de uma camada e retorna na hora; retorna false,
+// sem tocar nada, se ela não cabe
+bool audio_play(uint pin, int layer, const MelodyStep* melody, uint length, int mode) {
+  uint32_t status = save_and_disable_interrupts();
+  AudioLayer* target = &layers[layer];
+
+  if (mode == AUDIO_PREEMPT) {
+    layer_clear(target);
+
+    // a nota que soava era dessa camada: a melodia nova começa agora, e uma
+    // melodia vazia só cala a camada
+    if (playing == layer) {
+      playing = -1;
+
+      if (length == 0) {
+        tone_off(audio_pin);
+      }
+    }
+  }
+
+  if (target->count + length > AUDIO_LAYER_NOTES) {
+    restore_interrupts(status);
+    return false;
+  }
+
+  for (uint i = 0; i < length; i++) {
+    target->steps[(target->head + target->count++) % AUDIO_LAYER_NOTES] = melody[i];
+  }
+
+  audio_pin = pin;
+  audio_schedule(time_us_64());
+  restore_interrupts(status);
+
+  return true;
+}
+
+// corta o som e esvazia as filas
+void audio_stop(void) {
+  uint32_t status = save_and_disable_interrupts();
+
+  for (int i = 0; i < AUDIO_LAYERS; i++) {
+    layer_clear(&layers[i]);
+  }
+
+  if (playing >= 0) {
+    playing = -1;
+    tone_off(audio_pin);
+  }
+
+  if (timer_running) {
+    cancel_repeating_timer(&timer);
+    timer_running = false;
+  }
+
+  restore_interrupts(status);
+}
+
+bool audio_is_playing(void) {
+  return playing >= 0;
+}
+
+// espera as filas acabarem
+void audio_wait(void) {
+  while (audio_is_playing()) {
+    __wfe();
+  }
+}
@@ -0,0 +1,390 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../inc/utils.h"
+#include "../inc/constants.h"
+#include "../inc/autopilot.h"
+
+// =============================================================
+// AUTOPILOT
+// Escolhe a direção da cobra a cada tick, no lugar do joystick. Em ordem:
+//   1. o caminho mais curto até a comida (busca em largura; como todos os
+//      passos custam o mesmo, é o que um A* encontraria), desde que depois de
+//      comer a cobra ainda consiga alcançar a própria cauda;
+//   2. o caminho mais longo até a cauda entre os vizinhos da cabeça, para
+//      ganhar tempo até que apareça um caminho seguro até a comida;
+//   3. a próxima célula de um ciclo hamiltoniano do canvas, se houver;
+//   4. o vizinho de onde se alcança a maior área livre.
+// A busca leva em conta que o corpo anda: o node i de uma cobra de tamanho n
+// deixa sua célula depois de n - i movimentos (mais o crescimento pendente),
+// então uma célula do corpo pode entrar no caminho a partir desse movimento.
+// As tabelas de vizinhos (com a volta pelas bordas, como em
+// get_relative_position) e os buffers da busca são alocados uma vez no
+// autopilot_init, nenhuma decisão aloca memória.
+// =============================================================
+
+#define NO_CELL 0xffff
+
+static void* allocate(size_t size) {
+  void* pointer = malloc(size);
+
+  if (pointer == NULL) {
+    memory_allocation_error();
+  }
+
+  return pointer;
+}
+
+static int direction_index(Direction direction) {
+  return direction - DIRECTION_NORTH;
+}
+
+static Direction index_direction(int index) {
+  return DIRECTION_NORTH + index;
+}
+
+static int cell_of(Autopilot* autopilot, Position position) {
+  return position[0] * autopilot->cols + position[1];
+}
+
+// direção do ciclo na célula (row, col) de um canvas com um número par de
+// linhas: a primeira linha vai para leste, as demais são percorridas em zigue
+// zague sem a coluna 0, que é o caminho de volta para o norte
+static int even_rows_cycle_direction(int row, int col, int rows, int cols) {
+  int north = direction_index(DIRECTION_NORTH), east = direction_index(DIRECTION_EAST);
+  int south = direction_index(DIRECTION_SOUTH), west = direction_index(DIRECTION_WEST);
+
+  if (col == 0) {
+    return row == 0 ? east : north;
+  }
+
+  if (row == 0) {
+    return col == cols - 1 ? south : east;
+  }
+
+  if (row % 2 == 1) {
+    if (col == 1) {
+      return row == rows - 1 ? west : south;
+    }
+
+    return west;
+  }
+
+  return col == cols - 1 ? south : east;
+}
+
+// monta o ciclo hamiltoniano, se o canvas tiver um que dê para construir:
+// linhas pares, colunas pares (o mesmo ciclo transposto) ou, com a volta pelas
+// bordas, linhas múltiplas das colunas (cada linha é percorrida para leste e
+// a seguinte começa uma coluna antes). O ciclo é conferido percorrendo-o.
+static void build_cycle(Autopilot* autopilot) {
+  int rows = autopilot->rows, cols = autopilot->cols;
+  // transposição de direções: norte vira oeste, leste vira sul e vice-versa
+  static const int8_t transposed[AUTOPILOT_DIRECTIONS] = { 3, 2, 1, 0 };
+
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      int direction;
+
+      if (rows % 2 == 0 && cols >= 2) {
+        direction = even_rows_cycle_direction(row, col, rows, cols);
+      } else if (cols % 2 == 0 && rows >= 2) {
+        direction = transposed[even_rows_cycle_direction(col, row, cols, rows)];
+      } else {
+        int last_col = wrap(-row - 1, 0, cols - 1);
+        direction = direction_index(col == last_col ? DIRECTION_SOUTH : DIRECTION_EAST);
+      }
+
+      autopilot->cycle[row * cols + col] = (int8_t) direction;
+    }
+  }
+
+  autopilot->generation++;
+  int cell = 0;
+  bool valid = true;
+
+  for (int i = 0; i < autopilot->cells && valid; i++) {
+    valid = autopilot->visited[cell] != autopilot->generation;
+    autopilot->visited[cell] = autopilot->generation;
+    cell = autopilot->neighbors[cell][autopilot->cycle[cell]];
+  }
+
+  autopilot->has_cycle = valid && cell == 0;
+}
+
+Autopilot* autopilot_init(int rows, int cols) {
+  if (rows < 1 || cols < 1 || rows * cols >= NO_CELL) {
+    fprintf(stderr, "Invalid autopilot canvas size: %ix%i.\n", rows, cols);
+    exit(EXIT_FAILURE);
+  }
+
+  Autopilot* autopilot = allocate(sizeof(Autopilot));
+  int cells = rows * cols;
+
+  autopilot->rows = rows;
+  autopilot->cols = cols;
+  autopilot->cells = cells;
+  autopilot->neighbors = allocate(sizeof(uint16_t[AUTOPILOT_DIRECTIONS]) * cells);
+  autopilot->cycle = allocate(sizeof(int8_t) * cells);
+  autopilot->queue = allocate(sizeof(uint16_t) * cells);
+  autopilot->parent = allocate(sizeof(uint16_t) * cells);
+  autopilot->distance = allocate(sizeof(uint16_t) * cells);
+  autopilot->free_at = allocate(sizeof(uint16_t) * cells);
+  autopilot->body = allocate(sizeof(uint16_t) * cells);
+  autopilot->virtual_body = allocate(sizeof(uint16_t) * cells);
+  autopilot->visited = calloc(cells, sizeof(uint32_t));
+  autopilot->generation = 0;
+  autopilot->stats = (AutopilotStats) { 0 };
+
+  if (autopilot->visited == NULL) {
+    memory_allocation_error();
+  }
+
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      uint16_t* neighbors = autopilot->neighbors[row * cols + col];
+      neighbors[direction_index(DIRECTION_NORTH)] = wrap(row - 1, 0, rows - 1) * cols + col;
+      neighbors[direction_index(DIRECTION_EAST)] = row * cols + wrap(col + 1, 0, cols - 1);
+      neighbors[direction_index(DIRECTION_SOUTH)] = wrap(row + 1, 0, rows - 1) * cols + col;
+      neighbors[direction_index(DIRECTION_WEST)] = row * cols + wrap(col - 1, 0, cols - 1);
+    }
+  }
+
+  build_cycle(autopilot);
+
+  return autopilot;
+}
+
+void autopilot_free(Autopilot* autopilot) {
+  if (autopilot == NULL) {
+    return;
+  }
+
+  free(autopilot->neighbors);
+  free(autopilot->cycle);
+  free(autopilot->queue);
+  free(autopilot->parent);
+  free(autopilot->distance);
+  free(autopilot->free_at);
+  free(autopilot->body);
+  free(autopilot->virtual_body);
+  free(autopilot->visited);
+  free(autopilot);
+}
+
+// começa uma nova busca: em vez de limpar visited, troca o valor que marca
+// uma célula como visitada
+static void next_generation(Autopilot* autopilot) {
+  if (++autopilot->generation == 0) {
+    memset(autopilot->visited, 0, sizeof(uint32_t) * autopilot->cells);
+    autopilot->generation = 1;
+  }
+}
+
+// marca em quantos movimentos cada célula do corpo fica livre
+static void mark_body(Autopilot* autopilot, const uint16_t* body, int size, int growth) {
+  memset(autopilot->free_at, 0, sizeof(uint16_t) * autopilot->cells);
+
+  for (int i = 0; i < size; i++) {
+    autopilot->free_at[body[i]] = (uint16_t) (size - i + growth);
+  }
+}
+
+// busca em largura a partir de start (alcançada no movimento start_distance),
+// sem entrar em blocked no primeiro movimento (a cobra não dá meia volta).
+// Retorna a distância até target, ou -1 se ele não for alcançável; com target
+// NO_CELL, percorre tudo o que for alcançável e coloca a contagem em area.
+static int search(Autopilot* autopilot, int start, int start_distance, int target, int blocked, int* area) {
+  next_generation(autopilot);
+
+  int head = 0, tail = 0;
+  autopilot->queue[tail++] = (uint16_t) start;
+  autopilot->visited[start] = autopilot->generation;
+  autopilot->distance[start] = (uint16_t) start_distance;
+  autopilot->parent[start] = NO_CELL;
+
+  while (head < tail) {
+    int cell = autopilot->queue[head++];
+    int distance = autopilot->distance[cell] + 1;
+
+    for (int i = 0; i < AUTOPILOT_DIRECTIONS; i++) {
+      int neighbor = autopilot->neighbors[cell][i];
+
+      if (autopilot->visited[neighbor] == autopilot->generation || autopilot->free_at[neighbor] > distance) {
+        continue;
+      }
+
+      if (cell == start && neighbor == blocked) {
+        continue;
+      }
+
+      autopilot->visited[neighbor] = autopilot->generation;
+      autopilot->distance[neighbor] = (uint16_t) distance;
+      autopilot->parent[neighbor] = (uint16_t) cell;
+
+      if (neighbor == target) {
+        return distance - start_distance;
+      }
+
+      autopilot->queue[tail++] = (uint16_t) neighbor;
+    }
+  }
+
+  if (area != NULL) {
+    *area = tail;
+  }
+
+  return -1;
+}
+
+// direção do primeiro passo do caminho de start até target encontrado pela
+// última busca
+static Direction first_move(Autopilot* autopilot, int start, int target) {
+  int cell = target;
+
+  while (autopilot->parent[cell] != start) {
+    cell = autopilot->parent[cell];
+  }
+
+  for (int i = 0; i < AUTOPILOT_DIRECTIONS; i++) {
+    if (autopilot->neighbors[start][i] == cell) {
+      return index_direction(i);
+    }
+  }
+
+  return DIRECTION_NONE;
+}
+
+// diz se, depois de seguir o caminho até a comida encontrado pela última busca
+// (de length passos), a cobra ainda alcança a própria cauda
+static bool food_path_is_safe(Autopilot* autopilot, int size, int growth, int food, int length) {
+  // a cauda fica parada nos movimentos com crescimento pendente, e comer
+  // acrescenta um crescimento já no último movimento
+  int kept = (length - 1 < growth ? length - 1 : growth) + 1;
+  int new_size = size + kept;
+  int new_growth = growth + 1 - kept;
+
+  if (new_size >= autopilot->cells) {
+    return true;
+  }
+
+  uint16_t* body = autopilot->virtual_body;
+  int count = 0;
+
+  for (int cell = food; cell != NO_CELL && count < new_size; cell = autopilot->parent[cell]) {
+    if (autopilot->parent[cell] != NO_CELL) {
+      body[count++] = (uint16_t) cell;
+    }
+  }
+
+  for (int i = 0; count < new_size; i++) {
+    body[count++] = autopilot->body[i];
+  }
+
+  mark_body(autopilot, body, new_size, new_growth);
+
+  return search(autopilot, body[0], 0, body[new_size - 1], body[1], NULL) > 0;
+}
+
+// escolhe a direção da cobra para o próximo tick
+Direction autopilot_decide(Autopilot* autopilot, GameState* state) {
+  Snake* snake = state->snake;
+  Food* food = state->food;
+  int size = snake->size;
+  int growth = snake->pending_growth;
+
+  autopilot->stats.decisions++;
+
+  for (int i = 0; i < size; i++) {
+    Position position;
+    snake_get_node_position(snake, i, position);
+    autopilot->body[i] = (uint16_t) cell_of(autopilot, position);
+  }
+
+  int head = autopilot->body[0];
+  int blocked = size > 1 ? autopilot->body[1] : NO_CELL;
+
+  mark_body(autopilot, autopilot->body, size, growth);
+
+  if (food->in_canvas) {
+    int target = cell_of(autopilot, food->position);
+    int length = search(autopilot, head, 0, target, blocked, NULL);
+
+    if (length > 0) {
+      Direction direction = first_move(autopilot, head, target);
+
+      if (food_path_is_safe(autopilot, size, growth, target, length)) {
+        autopilot->stats.food_paths++;
+        return direction;
+      }
+
+      mark_body(autopilot, autopilot->body, size, growth);
+    }
+  }
+
+  // segue a cauda pelo vizinho de onde ela está mais longe: correr atrás
+  // dela pelo caminho mais curto faz a cobra girar no mesmo lugar, enquanto o
+  // caminho mais longo abre espaço para que um caminho até a comida apareça
+  if (size > 1) {
+    int tail = autopilot->body[size - 1];
+    Direction best = DIRECTION_NONE;
+    int best_length = -1;
+
+    for (int i = 0; i < AUTOPILOT_DIRECTIONS; i++) {
+      int next = autopilot->neighbors[head][i];
+
+      if (next == blocked || autopilot->free_at[next] > 1) {
+        continue;
+      }
+
+      int length = next == tail ? 0 : search(autopilot, next, 1, tail, NO_CELL, NULL);
+
+      if (length > best_length) {
+        best = index_direction(i);
+        best_length = length;
+      }
+    }
+
+    if (best_length >= 0) {
+      autopilot->stats.tail_paths++;
+      return best;
+    }
+  }
+
+  if (autopilot->has_cycle) {
+    int direction = autopilot->cycle[head];
+    int next = autopilot->neighbors[head][direction];
+
+    if (next != blocked && autopilot->free_at[next] <= 1) {
+      autopilot->stats.cycle_moves++;
+      return index_direction(direction);
+    }
+  }
+
+  Direction best = snake->direction;
+  int best_area = 0;
+
+  for (int i = 0; i < AUTOPILOT_DIRECTIONS; i++) {
+    int next = autopilot->neighbors[head][i];
+
+    if (next == blocked || autopilot->free_at[next] > 1) {
+      continue;
+    }
+
+    int area = 0;
+    search(autopilot, next, 1, NO_CELL, NO_CELL, &area);
+
+    if (area > best_area) {
+      best = index_direction(i);
+      best_area = area;
+    }
+  }
+
+  if (best_area > 0) {
+    autopilot->stats.area_moves++;
+  } else {
+    autopilot->stats.stuck++;
+  }
+
+  return best;
+}
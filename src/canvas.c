@@ -2,11 +2,13 @@
 #include <stdbool.h>
 #include <malloc.h>
 #include <stdlib.h>
+#include <string.h>
 #include "../inc/types.h"
 #include "../inc/utils.h"
 #include "../inc/constants.h"
 #include "../inc/matrix.h"
-#include "../inc/neopixel.h"
+#include "../inc/canvas.h"
+#include "../inc/random.h"
 
 // ==========================================================================
 // CANVAS
@@ -14,36 +16,52 @@
 // posicionado e renderizado.
 // Usa como base uma estrutura de dados de matriz (código em ./matrix.c), mas
 // adiciona funções úteis para a renderização e a lógica do jogo.
+// Além das células, o canvas mantém o conjunto das células livres, atualizado
+// a cada canvas_put, para que contar e sortear posições livres seja O(1).
+// A renderização é comum aos backends e fica em ./canvas_render.c, a
+// alternativa com camadas de bits fica em ./canvas_bitboard.c.
 // ==========================================================================
 
-typedef Matrix Canvas;
-typedef MatrixDataType CanvasCell;
-typedef MatrixPosition CanvasPosition;
+// converte um índice linear de célula numa posição (linha, coluna)
+static void index_to_position(Canvas* canvas, int index, Position position) {
+  copy_position((int [2]){ index / canvas->cols, index % canvas->cols }, position);
+}
+
+// insere uma célula no conjunto de células livres
+static void free_cells_add(Canvas* canvas, int index) {
+  canvas->free_cells[canvas->free_count] = index;
+  canvas->free_cells_index[index] = canvas->free_count;
+  canvas->free_count++;
+}
+
+// remove uma célula do conjunto de células livres, trocando-a de lugar com a
+// última célula do array denso
+static void free_cells_remove(Canvas* canvas, int index) {
+  int slot = canvas->free_cells_index[index];
+  int last = canvas->free_cells[canvas->free_count - 1];
 
-// checa se uma posição (linha, coluna) está livra
-static bool is_position_free(Canvas* canvas, Position position) {
-  int row = position[0], col = position[1];
-  return (canvas->data[row][col] == CELL_UNUSED);
+  canvas->free_cells[slot] = last;
+  canvas->free_cells_index[last] = slot;
+  canvas->free_cells_index[index] = -1;
+  canvas->free_count--;
 }
 
 // retorna um array com todas as posições (linha, coluna) livres
 Position* canvas_get_free_positions(Canvas* canvas, size_t* size) {
-  *size = 0;
-  Position* positions = NULL;
-
-  for (int row = 0; row < canvas->rows; row++) {
-    for (int col = 0; col < canvas->cols; col++) {
-      if (is_position_free(canvas, (int [2]){ row, col })) {
-        (*size)++;
-        positions = realloc(positions, (*size) * sizeof(Position));
-
-        if (positions == NULL) {
-          memory_allocation_error();
-        }
-
-        copy_position((int [2]){ row, col }, positions[*size - 1]);
-      }
-    }
+  *size = (size_t) canvas->free_count;
+
+  if (*size == 0) {
+    return NULL;
+  }
+
+  Position* positions = malloc((*size) * sizeof(Position));
+
+  if (positions == NULL) {
+    memory_allocation_error();
+  }
+
+  for (size_t i = 0; i < *size; i++) {
+    index_to_position(canvas, canvas->free_cells[i], positions[i]);
   }
 
   return positions;
@@ -53,14 +71,9 @@ Position* canvas_get_free_positions(Canvas* canvas, size_t* size) {
 // chamado caso não exista posição livre (isso pode ser checado por meio das
 // outras funções do canvas)
 void canvas_get_random_free_position(Canvas* canvas, Position position) {
-  size_t positions_size;
-
-  Position* free_positions = canvas_get_free_positions(canvas, &positions_size);
-
-  if (positions_size > 0 && free_positions != NULL) {
-    int position_index = randint(0, (int) positions_size - 1);
-    copy_position(free_positions[position_index], position);
-    free(free_positions);
+  if (canvas->free_count > 0) {
+    int slot = (int) random_bounded(&canvas->random, (uint32_t) canvas->free_count);
+    index_to_position(canvas, canvas->free_cells[slot], position);
   } else {
     fprintf(stderr, "Function canvas_get_random_free_position() called but there is no free position.\n");
     exit(EXIT_FAILURE);
@@ -69,92 +82,118 @@ void canvas_get_random_free_position(Canvas* canvas, Position position) {
 
 // retorna a quantidade de posições livres
 int canvas_count_free_positions(Canvas* canvas) {
-  int count = 0;
-
-  for (int row = 0; row < canvas->rows; row++) {
-    for (int col = 0; col < canvas->cols; col++) {
-      if (is_position_free(canvas, (int [2]){ row, col })) {
-        count++;
-      }
-    }
+  return canvas->free_count;
+}
+
+// retorna a célula (o valor) de uma determinada posição do canvas.
+// isso é um inteiro correspondente a uma célula definida em ../inc/constants.h
+CanvasCell canvas_get(Canvas *canvas, CanvasPosition position) {
+  return matrix_get(canvas->cells, position);
+};
+
+// preenche o canvas numa posição específica, mantendo o conjunto de células
+// livres atualizado
+void canvas_put(Canvas *canvas, CanvasCell cell, CanvasPosition position) {
+  int index = (int) matrix_index(canvas->cells, position[0], position[1]);
+  CanvasCell previous_cell = canvas->cells->data[index];
+
+  canvas->cells->data[index] = cell;
+
+  if (previous_cell == CELL_UNUSED && cell != CELL_UNUSED) {
+    free_cells_remove(canvas, index);
+  } else if (previous_cell != CELL_UNUSED && cell == CELL_UNUSED) {
+    free_cells_add(canvas, index);
   }
+};
 
-  return count;
-}
+// copia as células (em ordem de linha) para cells e o conjunto de células
+// livres, na ordem usada pelos sorteios, para free_order; retorna quantas
+// células estão livres
+int canvas_save(Canvas* canvas, CanvasCell* cells, uint16_t* free_order) {
+  memcpy(cells, canvas->cells->data, matrix_size(canvas->cells) * sizeof(CanvasCell));
 
-// função utilitária para gerar um sprite para a matriz de leds
-static void gen_sprite(Canvas* canvas, int sprite[5][5][3]) {
-  for (int row = 0; row < canvas->rows; row++) {
-    for (int col = 0; col < canvas->cols; col++) {
-      int cell = canvas->data[row][col];
-
-      switch (cell) {
-        case CELL_UNUSED: {
-          copy_color((int [3]){ 0, 0, 0 }, sprite[row][col]);
-          break;
-        } case CELL_SNAKE_HEAD: {
-          copy_color((int [3]){ 2, 2, 2 }, sprite[row][col]);
-          break;
-        } case CELL_FOOD: {
-          copy_color((int [3]){ 2, 0, 0 }, sprite[row][col]);
-          break;
-        } case CELL_SNAKE_BODY: {
-          copy_color((int [3]){ 0, 0, 2 }, sprite[row][col]);
-          break;
-        } default: {
-          copy_color((int [3]){ 0, 2, 0 }, sprite[row][col]);
-          break;
-        }
-      }
-    }
+  for (int i = 0; i < canvas->free_count; i++) {
+    free_order[i] = (uint16_t) canvas->free_cells[i];
   }
+
+  return canvas->free_count;
 }
 
-// renderiza o canvas, esta é a única função "pública" (sem static) que de fato
-// foge da abstração e usa a matriz de leds.
-// todas as funções que alteram o canvas de alguma forma apenas definem o que
-// será mostrado, mas é preciso chamar esta função quando for o tempo certo de
-// mostrar de fato.
-void canvas_render(Canvas* canvas) {
-  npClear();
+// restaura o que canvas_save copiou, incluindo a ordem das células livres,
+// para que os sorteios seguintes sejam os mesmos
+void canvas_load(Canvas* canvas, const CanvasCell* cells, const uint16_t* free_order, int free_count) {
+  int size = (int) matrix_size(canvas->cells);
 
-  int sprite[5][5][3];
-  gen_sprite(canvas, sprite);
-  setSpriteLEDs(sprite);
+  memcpy(canvas->cells->data, cells, size * sizeof(CanvasCell));
 
-  npWrite();
-}
+  for (int i = 0; i < size; i++) {
+    canvas->free_cells_index[i] = -1;
+  }
 
-// retorna a célula (o valor) de uma determinada posição do canvas.
-// isso é um inteiro correspondente a uma célula definida em ../inc/constants.h
-CanvasCell canvas_get(Canvas *canvas, CanvasPosition position) {
-  int row = position[0];
-  int col = position[1];
-  return canvas->data[row][col];
-};
+  for (int i = 0; i < free_count; i++) {
+    canvas->free_cells[i] = free_order[i];
+    canvas->free_cells_index[free_order[i]] = i;
+  }
 
-// preenche o canvas numa posição específica
-void canvas_put(Canvas *canvas, CanvasCell cell, CanvasPosition position) {
-  matrix_put(canvas, position, cell);
-};
+  canvas->free_count = free_count;
+}
 
 // limpa o canvas
 void canvas_clear(Canvas *canvas) {
-  for (int i = 0; i < canvas->rows; i++) {
-    for (int j = 0; j < canvas->cols; j++) {
-      canvas_put(canvas, CELL_UNUSED, (int[2]){ i, j });
-    };
-  };
+  int size = (int) matrix_size(canvas->cells);
+
+  matrix_fill(canvas->cells, CELL_UNUSED);
+
+  for (int i = 0; i < size; i++) {
+    canvas->free_cells[i] = i;
+    canvas->free_cells_index[i] = i;
+  }
+
+  canvas->free_count = size;
 }
 
 // inicia o canvas
 Canvas* canvas_init(int n_rows, int n_cols) {
-  Canvas* canvas = matrix_init(n_rows, n_cols);
+  Canvas* canvas = malloc(sizeof(Canvas));
+
+  if (canvas == NULL) {
+    memory_allocation_error();
+  }
+
+  canvas->cells = matrix_init(n_rows, n_cols);
+  canvas->rows = n_rows;
+  canvas->cols = n_cols;
+
+  size_t size = matrix_size(canvas->cells);
+  canvas->free_cells = malloc(size * sizeof(int));
+  canvas->free_cells_index = malloc(size * sizeof(int));
+
+  if (canvas->free_cells == NULL || canvas->free_cells_index == NULL) {
+    memory_allocation_error();
+  }
+
+  // semente fixa até que quem usa o canvas escolha outra com canvas_seed; o
+  // gerador padrão não é tocado, então canvas_init pode ser chamado de várias
+  // threads ao mesmo tempo
+  canvas_seed(canvas, 0);
   canvas_clear(canvas);
   return canvas;
 }
 
+// define a semente do gerador usado para sortear posições livres, a mesma
+// semente com as mesmas jogadas produz as mesmas posições
+void canvas_seed(Canvas* canvas, uint64_t seed) {
+  random_seed(&canvas->random, seed);
+}
+
 // libera a memória alocada para o canvas
 void canvas_free(Canvas* canvas) {
-  matrix_free(canvas);
+  if (canvas == NULL) {
+    return;
+  }
+
+  free(canvas->free_cells);
+  free(canvas->free_cells_index);
+  matrix_free(canvas->cells);
+  free(canvas);
 }
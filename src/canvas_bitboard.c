@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include "../inc/types.h"
+#include "../inc/utils.h"
+#include "../inc/constants.h"
+#include "../inc/canvas.h"
+#include "../inc/random.h"
+
+// ==========================================================================
+// CANVAS (BITBOARD)
+// Backend alternativo do canvas (selecionado com CANVAS_BACKEND=bitboard no
+// CMake), com a mesma API de ./canvas.c.
+// Cada tipo de célula ocupada tem uma camada de bits em palavras de 64 bits,
+// e a união delas (occupied) diz quais células estão ocupadas. Contar as
+// células livres é um popcount sobre as palavras e sortear uma célula livre é
+// um rank/select sobre a máscara de ocupação invertida.
+// ==========================================================================
+
+#define WORD_BITS 64
+
+static inline int popcount(uint64_t word) {
+  return __builtin_popcountll(word);
+}
+
+// posição (0 a 63) do k-ésimo bit ligado (k começando em 0) de uma palavra,
+// por busca binária sobre as contagens das metades
+static int select_bit(uint64_t word, int k) {
+  int position = 0;
+
+  for (int width = WORD_BITS / 2; width > 0; width /= 2) {
+    uint64_t low = word & ((1ull << width) - 1);
+    int count = popcount(low);
+
+    if (k >= count) {
+      k -= count;
+      word >>= width;
+      position += width;
+    } else {
+      word = low;
+    }
+  }
+
+  return position;
+}
+
+static inline int position_to_index(Canvas* canvas, CanvasPosition position) {
+  return position[0] * canvas->cols + position[1];
+}
+
+static void index_to_position(Canvas* canvas, int index, Position position) {
+  copy_position((int [2]){ index / canvas->cols, index % canvas->cols }, position);
+}
+
+static inline bool bit_get(uint64_t* plane, int index) {
+  return (plane[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+static inline void bit_set(uint64_t* plane, int index) {
+  plane[index / WORD_BITS] |= 1ull << (index % WORD_BITS);
+}
+
+static inline void bit_clear(uint64_t* plane, int index) {
+  plane[index / WORD_BITS] &= ~(1ull << (index % WORD_BITS));
+}
+
+// retorna um array com todas as posições (linha, coluna) livres
+Position* canvas_get_free_positions(Canvas* canvas, size_t* size) {
+  *size = (size_t) canvas_count_free_positions(canvas);
+
+  if (*size == 0) {
+    return NULL;
+  }
+
+  Position* positions = malloc((*size) * sizeof(Position));
+
+  if (positions == NULL) {
+    memory_allocation_error();
+  }
+
+  size_t count = 0;
+
+  for (int word = 0; word < canvas->words; word++) {
+    uint64_t free_bits = ~canvas->occupied[word];
+
+    while (free_bits != 0) {
+      int bit = __builtin_ctzll(free_bits);
+      index_to_position(canvas, word * WORD_BITS + bit, positions[count++]);
+      free_bits &= free_bits - 1;
+    }
+  }
+
+  return positions;
+}
+
+// preenche o array position com uma posição livre aleatória, não deve ser
+// chamado caso não exista posição livre (isso pode ser checado por meio das
+// outras funções do canvas)
+void canvas_get_random_free_position(Canvas* canvas, Position position) {
+  int free_count = canvas_count_free_positions(canvas);
+
+  if (free_count <= 0) {
+    fprintf(stderr, "Function canvas_get_random_free_position() called but there is no free position.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // rank: acha a palavra que contém a k-ésima célula livre; select: acha o
+  // bit dentro dessa palavra
+  int k = (int) random_bounded(&canvas->random, (uint32_t) free_count);
+
+  for (int word = 0; word < canvas->words; word++) {
+    uint64_t free_bits = ~canvas->occupied[word];
+    int count = popcount(free_bits);
+
+    if (k < count) {
+      index_to_position(canvas, word * WORD_BITS + select_bit(free_bits, k), position);
+      return;
+    }
+
+    k -= count;
+  }
+}
+
+// retorna a quantidade de posições livres
+int canvas_count_free_positions(Canvas* canvas) {
+  int count = 0;
+
+  for (int word = 0; word < canvas->words; word++) {
+    count += popcount(~canvas->occupied[word]);
+  }
+
+  return count;
+}
+
+// retorna a célula (o valor) de uma determinada posição do canvas.
+// isso é um inteiro correspondente a uma célula definida em ../inc/constants.h
+CanvasCell canvas_get(Canvas *canvas, CanvasPosition position) {
+  int index = position_to_index(canvas, position);
+
+  if (!bit_get(canvas->occupied, index)) {
+    return CELL_UNUSED;
+  }
+
+  for (int plane = 0; plane < CANVAS_PLANES; plane++) {
+    if (bit_get(canvas->planes[plane], index)) {
+      return (CanvasCell) (plane + 1);
+    }
+  }
+
+  return CELL_UNUSED;
+};
+
+// preenche o canvas numa posição específica
+void canvas_put(Canvas *canvas, CanvasCell cell, CanvasPosition position) {
+  if (cell > CANVAS_PLANES) {
+    fprintf(stderr, "Function canvas_put() called with an unknown cell: %i.\n", cell);
+    exit(EXIT_FAILURE);
+  }
+
+  int index = position_to_index(canvas, position);
+  CanvasCell previous_cell = canvas_get(canvas, position);
+
+  if (previous_cell != CELL_UNUSED) {
+    bit_clear(canvas->planes[previous_cell - 1], index);
+    bit_clear(canvas->occupied, index);
+  }
+
+  if (cell != CELL_UNUSED) {
+    bit_set(canvas->planes[cell - 1], index);
+    bit_set(canvas->occupied, index);
+  }
+};
+
+// copia as células (em ordem de linha) para cells e as células livres, na
+// ordem usada pelos sorteios (que aqui é sempre a ordem de linha), para
+// free_order; retorna quantas células estão livres
+int canvas_save(Canvas* canvas, CanvasCell* cells, uint16_t* free_order) {
+  int size = canvas->rows * canvas->cols;
+  int free_count = 0;
+
+  memset(cells, CELL_UNUSED, size * sizeof(CanvasCell));
+
+  for (int plane = 0; plane < CANVAS_PLANES; plane++) {
+    for (int word = 0; word < canvas->words; word++) {
+      uint64_t bits = canvas->planes[plane][word];
+
+      while (bits != 0) {
+        cells[word * WORD_BITS + __builtin_ctzll(bits)] = (CanvasCell) (plane + 1);
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  for (int word = 0; word < canvas->words; word++) {
+    uint64_t free_bits = ~canvas->occupied[word];
+
+    while (free_bits != 0) {
+      free_order[free_count++] = (uint16_t) (word * WORD_BITS + __builtin_ctzll(free_bits));
+      free_bits &= free_bits - 1;
+    }
+  }
+
+  return free_count;
+}
+
+// restaura o que canvas_save copiou; a ordem das células livres não precisa
+// ser guardada, já que ela decorre das células
+void canvas_load(Canvas* canvas, const CanvasCell* cells, const uint16_t* free_order, int free_count) {
+  int size = canvas->rows * canvas->cols;
+
+  canvas_clear(canvas);
+
+  for (int index = 0; index < size; index++) {
+    CanvasCell cell = cells[index];
+
+    if (cell != CELL_UNUSED && cell <= CANVAS_PLANES) {
+      bit_set(canvas->planes[cell - 1], index);
+      bit_set(canvas->occupied, index);
+    }
+  }
+}
+
+// limpa o canvas
+void canvas_clear(Canvas *canvas) {
+  size_t plane_bytes = (size_t) canvas->words * sizeof(uint64_t);
+
+  for (int plane = 0; plane < CANVAS_PLANES; plane++) {
+    memset(canvas->planes[plane], 0, plane_bytes);
+  }
+
+  memset(canvas->occupied, 0, plane_bytes);
+
+  // os bits que sobram na última palavra não são células e ficam "ocupados"
+  int used_bits = (canvas->rows * canvas->cols) % WORD_BITS;
+
+  if (used_bits != 0) {
+    canvas->occupied[canvas->words - 1] = ~((1ull << used_bits) - 1);
+  }
+}
+
+// inicia o canvas
+Canvas* canvas_init(int n_rows, int n_cols) {
+  if (n_rows < 1 || n_cols < 1) {
+    fprintf(stderr, "Invalid canvas size: %ix%i.\n", n_rows, n_cols);
+    exit(EXIT_FAILURE);
+  }
+
+  Canvas* canvas = malloc(sizeof(Canvas));
+
+  if (canvas == NULL) {
+    memory_allocation_error();
+  }
+
+  canvas->rows = n_rows;
+  canvas->cols = n_cols;
+  canvas->words = (n_rows * n_cols + WORD_BITS - 1) / WORD_BITS;
+
+  // todas as camadas (e a de ocupação, por último) num único bloco
+  uint64_t* words = malloc((size_t) (CANVAS_PLANES + 1) * canvas->words * sizeof(uint64_t));
+
+  if (words == NULL) {
+    memory_allocation_error();
+  }
+
+  for (int plane = 0; plane < CANVAS_PLANES; plane++) {
+    canvas->planes[plane] = words + (size_t) plane * canvas->words;
+  }
+
+  canvas->occupied = words + (size_t) CANVAS_PLANES * canvas->words;
+
+  // semente fixa até que quem usa o canvas escolha outra com canvas_seed; o
+  // gerador padrão não é tocado, então canvas_init pode ser chamado de várias
+  // threads ao mesmo tempo
+  canvas_seed(canvas, 0);
+  canvas_clear(canvas);
+  return canvas;
+}
+
+// define a semente do gerador usado para sortear posições livres, a mesma
+// semente com as mesmas jogadas produz as mesmas posições
+void canvas_seed(Canvas* canvas, uint64_t seed) {
+  random_seed(&canvas->random, seed);
+}
+
+// libera a memória alocada para o canvas
+void canvas_free(Canvas* canvas) {
+  if (canvas == NULL) {
+    return;
+  }
+
+  free(canvas->planes[0]);
+  free(canvas);
+}
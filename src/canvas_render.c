@@ -0,0 +1,61 @@
+#include "../inc/types.h"
+#include "../inc/constants.h"
+#include "../inc/canvas.h"
+#include "../inc/neopixel.h"
+
+// ==========================================================================
+// CANVAS RENDER
+// Renderização do canvas na matriz de leds, comum a todos os backends de
+// armazenamento do canvas (lê as células apenas por canvas_get).
+// ==========================================================================
+
+// a matriz de leds é 5x5, canvas maiores só têm o canto superior esquerdo
+// renderizado
+#define CANVAS_RENDER_ROWS 5
+#define CANVAS_RENDER_COLS 5
+
+// função utilitária para gerar um sprite para a matriz de leds
+static void gen_sprite(Canvas* canvas, int sprite[5][5][3]) {
+  int rows = canvas->rows < CANVAS_RENDER_ROWS ? canvas->rows : CANVAS_RENDER_ROWS;
+  int cols = canvas->cols < CANVAS_RENDER_COLS ? canvas->cols : CANVAS_RENDER_COLS;
+
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      int cell = canvas_get(canvas, (int [2]){ row, col });
+
+      switch (cell) {
+        case CELL_UNUSED: {
+          copy_color((int [3]){ 0, 0, 0 }, sprite[row][col]);
+          break;
+        } case CELL_SNAKE_HEAD: {
+          copy_color((int [3]){ 2, 2, 2 }, sprite[row][col]);
+          break;
+        } case CELL_FOOD: {
+          copy_color((int [3]){ 2, 0, 0 }, sprite[row][col]);
+          break;
+        } case CELL_SNAKE_BODY: {
+          copy_color((int [3]){ 0, 0, 2 }, sprite[row][col]);
+          break;
+        } default: {
+          copy_color((int [3]){ 0, 2, 0 }, sprite[row][col]);
+          break;
+        }
+      }
+    }
+  }
+}
+
+// renderiza o canvas, esta é a única função "pública" (sem static) que de fato
+// foge da abstração e usa a matriz de leds.
+// todas as funções que alteram o canvas de alguma forma apenas definem o que
+// será mostrado, mas é preciso chamar esta função quando for o tempo certo de
+// mostrar de fato.
+void canvas_render(Canvas* canvas) {
+  npClear();
+
+  int sprite[5][5][3] = {0};
+  gen_sprite(canvas, sprite);
+  setSpriteLEDs(sprite);
+
+  npWrite();
+}
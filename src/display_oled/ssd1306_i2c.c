@@ -7,6 +7,8 @@
 #include "hardware/i2c.h"
 #include "../../inc/display_oled/ssd1306_font.h"
 #include "../../inc/display_oled/ssd1306_i2c.h"
+#include "../../inc/latency.h"
+#include "../../inc/output.h"
 
 RenderArea get_render_area() {
     return (RenderArea){
@@ -28,23 +30,46 @@ void ssd1306_send_command(uint8_t command) {
     i2c_write_blocking(i2c1, ssd1306_i2c_address, buffer, 2, false);
 }
 
-// Envia uma lista de comandos ao hardware
-void ssd1306_send_command_list(uint8_t *ssd, int number) {
+// Escreve uma lista de comandos no I2C, esperando cada transferência
+void ssd1306_write_command_list(const uint8_t *commands, int number) {
     for (int i = 0; i < number; i++) {
-        ssd1306_send_command(ssd[i]);
+        ssd1306_send_command(commands[i]);
     }
 }
 
-// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início
-void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
-    uint8_t *temp_buffer = malloc(buffer_length + 1);
+// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início.
+// O buffer temporário é estático porque esta função roda no core de saída, e o malloc do SDK não
+// é protegido contra chamadas simultâneas dos dois cores
+void ssd1306_write_buffer(const uint8_t *ssd, int buffer_length) {
+    static uint8_t temp_buffer[ssd1306_buffer_length + 1];
 
     temp_buffer[0] = 0x40;
     memcpy(temp_buffer + 1, ssd, buffer_length);
 
     i2c_write_blocking(i2c1, ssd1306_i2c_address, temp_buffer, buffer_length + 1, false);
+}
+
+// Envia uma lista de comandos ao hardware (pelo core de saída, se ele estiver rodando; veja output.c)
+void ssd1306_send_command_list(uint8_t *ssd, int number) {
+    if (output_post_oled_commands(ssd, number)) {
+        return;
+    }
 
-    free(temp_buffer);
+    ssd1306_write_command_list(ssd, number);
+}
+
+// Envia o buffer ao hardware (pelo core de saída, se ele estiver rodando)
+void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
+    if (output_post_oled_buffer(ssd, buffer_length)) {
+        return;
+    }
+
+    ssd1306_write_buffer(ssd, buffer_length);
+
+    // fim das medidas de latência até o OLED (com o core de saída, em output.c)
+    LATENCY_SPAN(LATENCY_OLED_FLUSH, LATENCY_MARK_OLED);
+    LATENCY_SPAN(LATENCY_INPUT_TO_OLED, LATENCY_MARK_INPUT);
+    LATENCY_CLEAR(LATENCY_MARK_INPUT);
 }
 
 // Cria a lista de comandos (com base nos endereços definidos em ssd1306_i2c.h) para a inicialização do display
@@ -93,6 +118,8 @@ void render_on_display(uint8_t *ssd, struct render_area *area) {
         ssd1306_set_page_address, area->start_page, area->end_page
     };
 
+    LATENCY_MARK(LATENCY_MARK_OLED);
+
     ssd1306_send_command_list(commands, count_of(commands));
     ssd1306_send_buffer(ssd, area->buffer_length);
 }
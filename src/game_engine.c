@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <malloc.h>
+#include "../inc/utils.h"
+#include "../inc/constants.h"
+#include "../inc/canvas.h"
+#include "../inc/snake.h"
+#include "../inc/food.h"
+#include "../inc/game_engine.h"
+
+// =============================================================
+// GAME ENGINE
+// As regras do jogo, sem nenhuma entrada/saída: não lê o joystick, não
+// renderiza, não toca sons e não espera. Cada chamada de game_step avança o
+// jogo um tick a partir de uma entrada e diz o que aconteceu por meio de
+// eventos, cabe a quem chama (o loop do jogo em ../game.c, ou programas no
+// host) reagir a eles.
+// =============================================================
+
+// tamanho inicial e direção inicial da cobra
+#define INITIAL_SNAKE_SIZE 2
+#define INITIAL_SNAKE_DIRECTION DIRECTION_EAST
+
+// coloca a cobra e a comida num canvas limpo, sorteando as posições a partir
+// da semente: a mesma semente com as mesmas entradas repete o mesmo jogo
+static void game_state_start(GameState* state, uint64_t seed) {
+  Canvas* canvas = state->canvas;
+
+  canvas_seed(canvas, seed);
+  state->seed = seed;
+
+  Position snake_position;
+  canvas_get_random_free_position(canvas, snake_position);
+
+  state->snake = snake_init(canvas, snake_position, INITIAL_SNAKE_DIRECTION, INITIAL_SNAKE_SIZE);
+  state->food = food_init(canvas);
+  state->ticks = 0;
+  state->over = false;
+  state->won = false;
+}
+
+// inicia um jogo num canvas de n_rows x n_cols
+GameState* game_state_init(int n_rows, int n_cols, uint64_t seed) {
+  GameState* state = malloc(sizeof(GameState));
+
+  if (state == NULL) {
+    memory_allocation_error();
+  }
+
+  state->canvas = canvas_init(n_rows, n_cols);
+  game_state_start(state, seed);
+
+  return state;
+}
+
+// recomeça o jogo, reaproveitando o canvas
+void game_state_reset(GameState* state, uint64_t seed) {
+  food_free(state->food);
+  snake_free(state->snake);
+  canvas_clear(state->canvas);
+  game_state_start(state, seed);
+}
+
+// libera a memória alocada para o jogo
+void game_state_free(GameState* state) {
+  if (state == NULL) {
+    return;
+  }
+
+  food_free(state->food);
+  snake_free(state->snake);
+  canvas_free(state->canvas);
+  free(state);
+}
+
+// diz se a cobra pode passar a ir na direção dada (ela não pode dar meia volta)
+bool game_direction_is_valid(GameState* state, Direction direction) {
+  return direction != DIRECTION_NONE && direction != get_opposite_direction(state->snake->direction);
+}
+
+// avança o jogo um tick
+GameEvents game_step(GameState* state, GameInput input) {
+  if (state->over) {
+    return GAME_EVENT_NONE;
+  }
+
+  Canvas* canvas = state->canvas;
+  Snake* snake = state->snake;
+  Food* food = state->food;
+  GameEvents events = GAME_EVENT_MOVED;
+
+  if (game_direction_is_valid(state, input.direction)) {
+    snake->direction = input.direction;
+  }
+
+  Position next_head_position;
+  get_next_node_position(snake, canvas, 0, next_head_position);
+
+  if (food->in_canvas && positions_collide(next_head_position, food->position)) {
+    food_remove(food, canvas);
+    snake_grow(snake, canvas);
+    snake_move(snake, canvas);
+    events |= GAME_EVENT_ATE;
+
+    if (canvas_count_free_positions(canvas) > 0) {
+      food_move(food, canvas);
+    }
+  } else {
+    snake_move(snake, canvas);
+  }
+
+  state->ticks++;
+
+  if (snake_self_collides(snake)) {
+    events |= GAME_EVENT_LOST;
+    state->over = true;
+  } else if (canvas_count_free_positions(canvas) == 0 && !food->in_canvas) {
+    events |= GAME_EVENT_WON;
+    state->over = true;
+    state->won = true;
+  }
+
+  return events;
+}
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "../inc/constants.h"
+#include "../inc/joystick.h"
+#include "../inc/latency.h"
+#include "../inc/input_events.h"
+
+// =============================================================
+// INPUT EVENTS
+// Os botões geram eventos por interrupção de GPIO, nas duas bordas, e o
+// joystick dos menus é lido por um alarme repetitivo que gera um evento
+// quando a direção muda (e a cada MENU_REPEAT_US enquanto ela é segurada).
+// Os eventos vão para uma fila e quem espera por eles dorme em __wfe até o
+// __sev de uma interrupção, em vez de acordar a cada 50 ms para olhar os
+// pinos.
+//
+// O debounce aceita a primeira borda na hora (a latência fica só a da
+// interrupção) e ignora as que vêm até BUTTON_DEBOUNCE_US depois dela. Se o
+// repique terminar com o pino num nível diferente do aceito, o próximo
+// input_events_pop depois da janela percebe e gera o evento que faltou.
+//
+// A interrupção de GPIO e a do timer têm a mesma prioridade e não se
+// interrompem, então a fila tem um produtor de cada vez (as interrupções do
+// core0) e um consumidor (o loop), e não precisa de trava.
+// =============================================================
+
+typedef struct ButtonState {
+  uint pin;
+  volatile bool down;
+  volatile uint64_t changed_us;
+} ButtonState;
+
+InputStats input_stats;
+
+static volatile InputEvent events[INPUT_EVENTS_CAPACITY];
+static volatile uint32_t events_head;
+static volatile uint32_t events_tail;
+
+static ButtonState buttons[] = {
+  { .pin = BUTTON_A },
+  { .pin = BUTTON_B },
+};
+
+// estado do amostrador dos menus
+static repeating_timer_t menu_sampler;
+static bool menu_sampler_running = false;
+static Direction menu_sampled;
+static uint64_t menu_repeat_us;
+static uint64_t menu_active_until_us;
+
+// chamada nas interrupções, ou no loop com elas desligadas
+static void input_events_push(uint8_t type, uint8_t button, Direction direction, uint64_t time_us) {
+  uint32_t tail = events_tail;
+
+  if (tail - events_head == INPUT_EVENTS_CAPACITY) {
+    input_stats.dropped++;
+    return;
+  }
+
+  volatile InputEvent* event = &events[tail % INPUT_EVENTS_CAPACITY];
+  event->type = type;
+  event->button = button;
+  event->direction = direction;
+  event->time_us = time_us;
+
+  events_tail = tail + 1;
+  input_stats.events++;
+
+  // acorda quem estiver esperando em __wfe
+  __sev();
+}
+
+static ButtonState* button_of(uint pin) {
+  for (uint i = 0; i < count_of(buttons); i++) {
+    if (buttons[i].pin == pin) {
+      return &buttons[i];
+    }
+  }
+
+  return NULL;
+}
+
+// aceita o nível atual do pino se ele muda o estado e a janela de debounce
+// da última mudança já passou
+static void button_update(ButtonState* button, uint64_t now) {
+  bool down = !gpio_get(button->pin);
+
+  if (down == button->down) {
+    return;
+  }
+
+  if (now - button->changed_us < BUTTON_DEBOUNCE_US) {
+    input_stats.bounces++;
+    return;
+  }
+
+  button->down = down;
+  button->changed_us = now;
+  input_events_push(down ? INPUT_EVENT_BUTTON_DOWN : INPUT_EVENT_BUTTON_UP, (uint8_t) button->pin, DIRECTION_NONE, now);
+}
+
+static void input_gpio_callback(uint gpio, uint32_t event_mask) {
+  (void) event_mask;
+  ButtonState* button = button_of(gpio);
+
+  if (button != NULL) {
+    button_update(button, time_us_64());
+  }
+}
+
+// liga as interrupções dos botões; chamada depois de configurar os pinos
+void input_events_init(void) {
+  uint64_t now = time_us_64();
+
+  for (uint i = 0; i < count_of(buttons); i++) {
+    buttons[i].down = !gpio_get(buttons[i].pin);
+    buttons[i].changed_us = now - BUTTON_DEBOUNCE_US;
+  }
+
+  input_events_clear();
+
+  gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, input_gpio_callback);
+  gpio_set_irq_enabled(BUTTON_B, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+}
+
+bool input_events_pop(InputEvent* event) {
+  // bordas que o debounce engoliu no fim de um repique
+  uint64_t now = time_us_64();
+
+  for (uint i = 0; i < count_of(buttons); i++) {
+    uint32_t interrupts = save_and_disable_interrupts();
+    button_update(&buttons[i], now);
+    restore_interrupts(interrupts);
+  }
+
+  uint32_t head = events_head;
+
+  if (head == events_tail) {
+    return false;
+  }
+
+  volatile InputEvent* queued = &events[head % INPUT_EVENTS_CAPACITY];
+  event->type = queued->type;
+  event->button = queued->button;
+  event->direction = queued->direction;
+  event->time_us = queued->time_us;
+
+  events_head = head + 1;
+
+  return true;
+}
+
+// descarta os eventos pendentes (o estado dos botões continua valendo)
+void input_events_clear(void) {
+  events_head = events_tail;
+}
+
+// dorme até o próximo evento
+void input_wait_event(InputEvent* event) {
+  while (!input_events_pop(event)) {
+    LATENCY_POLL();
+    __wfe();
+    input_stats.wakeups++;
+  }
+}
+
+// dorme até o botão ser solto, descartando os outros eventos
+void input_wait_release(uint button) {
+  InputEvent event;
+
+  while (input_button_is_down(button)) {
+    input_wait_event(&event);
+  }
+}
+
+// estado do botão depois do debounce
+bool input_button_is_down(uint button) {
+  ButtonState* state = button_of(button);
+  return state != NULL && state->down;
+}
+
+static bool menu_sampler_alarm(repeating_timer_t* timer) {
+  uint64_t now = time_us_64();
+  Direction direction = joystick_get_direction();
+
+  if (direction != menu_sampled) {
+    menu_sampled = direction;
+    menu_active_until_us = now + MENU_IDLE_AFTER_US;
+
+    if (direction != DIRECTION_NONE) {
+      input_events_push(INPUT_EVENT_JOYSTICK, 0, direction, now);
+      menu_repeat_us = now + MENU_REPEAT_US;
+    }
+  } else if (direction != DIRECTION_NONE && now >= menu_repeat_us) {
+    input_events_push(INPUT_EVENT_JOYSTICK, 0, direction, now);
+    menu_repeat_us += MENU_REPEAT_US;
+    menu_active_until_us = now + MENU_IDLE_AFTER_US;
+  }
+
+  timer->delay_us = -(int64_t) (now < menu_active_until_us ? MENU_SAMPLE_ACTIVE_US : MENU_SAMPLE_IDLE_US);
+
+  return menu_sampler_running;
+}
+
+// começa a ler o joystick para os menus. Como o amostrador do jogo
+// (input_queue.c), ele é dono da leitura do joystick enquanto roda
+void input_menu_sampler_start(void) {
+  if (menu_sampler_running) {
+    return;
+  }
+
+  menu_sampled = DIRECTION_NONE;
+  menu_active_until_us = time_us_64() + MENU_IDLE_AFTER_US;
+  menu_sampler_running = true;
+
+  if (!add_repeating_timer_us(-(int64_t) MENU_SAMPLE_ACTIVE_US, menu_sampler_alarm, NULL, &menu_sampler)) {
+    fprintf(stderr, "No alarm slots available for the menu input sampler.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void input_menu_sampler_stop(void) {
+  if (menu_sampler_running) {
+    menu_sampler_running = false;
+    cancel_repeating_timer(&menu_sampler);
+  }
+}
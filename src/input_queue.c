@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/joystick.h"
+#include "../inc/input_queue.h"
+
+// =============================================================
+// INPUT QUEUE
+// Fila circular das mudanças de direção feitas entre um tick e outro. O
+// joystick é lido por um alarme repetitivo, independente do tick, e cada
+// leitura nova entra na fila se for válida em relação à última direção
+// enfileirada (não a atual da cobra); o loop do jogo tira uma por tick. Assim
+// um "cima e depois esquerda" rápido, feito enquanto a cobra ainda anda para
+// a direita, vira duas curvas em ticks seguidos, em vez de a primeira se
+// perder e a segunda ser recusada como meia volta.
+//
+// O amostrador só escreve tail e o loop só escreve head, então a fila não
+// precisa de trava entre a interrupção e o loop.
+// =============================================================
+
+// esvazia a fila; current é a direção atual da cobra
+void direction_queue_reset(DirectionQueue* queue, Direction current) {
+  queue->head = 0;
+  queue->tail = 0;
+  queue->last = current;
+  queue->dropped = 0;
+}
+
+// enfileira direction se ela muda a última direção enfileirada sem dar meia
+// volta; retorna false se ela foi recusada ou se a fila estava cheia
+bool direction_queue_push(DirectionQueue* queue, Direction direction) {
+  if (direction == DIRECTION_NONE || direction == queue->last || direction == get_opposite_direction(queue->last)) {
+    return false;
+  }
+
+  uint32_t tail = queue->tail;
+
+  if (tail - queue->head == DIRECTION_QUEUE_CAPACITY) {
+    queue->dropped++;
+    return false;
+  }
+
+  queue->items[tail % DIRECTION_QUEUE_CAPACITY] = direction;
+  queue->last = direction;
+  queue->tail = tail + 1;
+
+  return true;
+}
+
+bool direction_queue_pop(DirectionQueue* queue, Direction* direction) {
+  uint32_t head = queue->head;
+
+  if (head == queue->tail) {
+    return false;
+  }
+
+  *direction = queue->items[head % DIRECTION_QUEUE_CAPACITY];
+  queue->head = head + 1;
+
+  return true;
+}
+
+bool direction_queue_is_empty(const DirectionQueue* queue) {
+  return queue->head == queue->tail;
+}
+
+static bool input_sampler_alarm(repeating_timer_t* timer) {
+  InputSampler* sampler = timer->user_data;
+  Direction direction = joystick_get_direction();
+
+  // segurar o joystick numa direção enfileira uma vez só
+  if (direction != sampler->sample) {
+    if (direction_queue_push(sampler->queue, direction)) {
+      __sev();
+    }
+
+    sampler->sample = direction;
+  }
+
+  return sampler->running;
+}
+
+// começa a ler o joystick a cada interval_us e a enfileirar as mudanças em
+// queue. Enquanto o amostrador roda, a histerese de joystick_get_direction é
+// dele: quem mais for ler o joystick (os menus) precisa pará-lo antes
+void input_sampler_start(InputSampler* sampler, DirectionQueue* queue, uint32_t interval_us) {
+  sampler->queue = queue;
+  sampler->sample = DIRECTION_NONE;
+  sampler->running = true;
+
+  if (!add_repeating_timer_us(-(int64_t) interval_us, input_sampler_alarm, sampler, &sampler->timer)) {
+    fprintf(stderr, "No alarm slots available for the input sampler.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void input_sampler_stop(InputSampler* sampler) {
+  if (sampler->running) {
+    sampler->running = false;
+    cancel_repeating_timer(&sampler->timer);
+  }
+}
@@ -1,17 +1,58 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
 #include "math.h"
 #include "../inc/joystick.h"
+#include "../inc/joystick_filter.h"
 #include "../inc/constants.h"
+#include "../inc/latency.h"
 
 // ===========================================================================
 // JOYSTICK
 // Facilita o uso do joystick no código principal ao encapsular a lógica da
 // captura de input e os cálculos necessários para determinar informações como
 // a direção em que ele está inclinado
+//
+// Depois de joystick_sampler_start o ADC converte sozinho, alternando os dois
+// eixos, e um canal de DMA copia cada conversão para um anel na memória, sem
+// a CPU. joystick_get_direction só soma o anel e classifica a média com
+// contas inteiras (distância ao quadrado, sem raiz nem ponto flutuante, que
+// no RP2040 é emulado em software), com histerese para que o ruído perto do
+// limiar não fique trocando a direção. Antes de classificar, a leitura passa
+// pelo filtro e pela calibração de src/joystick_filter.c. Sem o amostrador,
+// as duas funções leem o ADC na hora, como antes.
 // ===========================================================================
 
+// o anel escrito pelo DMA: amostras pares do eixo y, ímpares do x. O DMA
+// volta ao início a cada JOYSTICK_RING_SAMPLES amostras, o que pede o
+// alinhamento ao tamanho do anel
+static volatile uint16_t ring[JOYSTICK_RING_SAMPLES] __attribute__((aligned(JOYSTICK_RING_SAMPLES * sizeof(uint16_t))));
+static int ring_dma = -1;
+// filtro e calibração de joystick_get_direction, com JOYSTICK_CONFIG_DEFAULT
+// até joystick_configure
+static JoystickFilter filter;
+static bool filter_ready = false;
+
+static JoystickFilter* joystick_filter(void);
+
+#if SNAKE_LATENCY_PROBES
+// início da medida de latência: a primeira leitura com a direção nova
+static void joystick_mark_input(Direction direction) {
+    static Direction last_direction = DIRECTION_NONE;
+
+    if (direction != last_direction && direction != DIRECTION_NONE) {
+        LATENCY_MARK_FIRST(LATENCY_MARK_INPUT);
+    }
+
+    last_direction = direction;
+}
+#else
+#define joystick_mark_input(direction) ((void) 0)
+#endif
+
 // inicia o joystick
 void joystick_init() {
     adc_init();
@@ -33,13 +74,9 @@ void joystick_init() {
 JoystickInfo joystick_get_info() {
     JoystickInfo info = {};
 
-    adc_select_input(0);
-    info.y_raw = adc_read();
+    joystick_read_raw(&info.x_raw, &info.y_raw);
 
-    adc_select_input(1);
-    info.x_raw = adc_read();
-
-    info.max = (1 << 12) - 1;
+    info.max = JOYSTICK_MAX;
 
     info.x_normalized = info.x_raw / (float)info.max;
     info.y_normalized = info.y_raw / (float)info.max;
@@ -66,6 +103,206 @@ JoystickInfo joystick_get_info() {
         }
     }
 
+    joystick_mark_input(info.direction);
 
     return info;
-}
\ No newline at end of file
+}
+
+// ===========================================================================
+// AMOSTRADOR
+// ===========================================================================
+
+// põe o ADC em modo livre nos canais 0 e 1 e o DMA no anel. Enquanto ele
+// roda o ADC é do DMA: adc_read não pode mais ser usado (a semente de
+// random_entropy_seed vem antes)
+void joystick_sampler_start(void) {
+    if (joystick_sampler_is_running()) {
+        return;
+    }
+
+    // o anel começa no centro, para que a primeira média não invente uma
+    // direção
+    for (int i = 0; i < JOYSTICK_RING_SAMPLES; i++) {
+        ring[i] = JOYSTICK_CENTER;
+    }
+
+    joystick_filter_reset(joystick_filter());
+
+    // o modo livre começa pelo canal selecionado: a conversão 0 é do y
+    adc_run(false);
+    adc_fifo_drain();
+    adc_select_input(0);
+    adc_set_round_robin(0x3);
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(clock_get_hz(clk_adc) / (float) JOYSTICK_CONVERSIONS_HZ - 1);
+
+    ring_dma = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(ring_dma);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, JOYSTICK_RING_BITS);
+    channel_config_set_dreq(&config, DREQ_ADC);
+
+    // a contagem máxima dura mais de 12 dias a JOYSTICK_CONVERSIONS_HZ;
+    // joystick_get_direction reinicia o amostrador se ela acabar. Par, para
+    // que o eixo de cada posição do anel não mude
+    dma_channel_configure(ring_dma, &config, ring, &adc_hw->fifo, 0xfffffffe, true);
+    adc_run(true);
+}
+
+// devolve o ADC às leituras com adc_read
+void joystick_sampler_stop(void) {
+    if (!joystick_sampler_is_running()) {
+        return;
+    }
+
+    adc_run(false);
+    dma_channel_abort(ring_dma);
+    dma_channel_unclaim(ring_dma);
+    adc_set_round_robin(0);
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    ring_dma = -1;
+}
+
+bool joystick_sampler_is_running(void) {
+    return ring_dma >= 0;
+}
+
+// leitura dos dois eixos: a média do anel com o amostrador rodando, ou uma
+// conversão de cada na hora
+void joystick_read_raw(uint* x_raw, uint* y_raw) {
+    if (!joystick_sampler_is_running()) {
+        adc_select_input(0);
+        *y_raw = adc_read();
+
+        adc_select_input(1);
+        *x_raw = adc_read();
+        return;
+    }
+
+    // o DMA pode escrever durante a soma; cada amostra é lida inteira, e
+    // uma amostra mais nova no lugar de uma antiga não muda o sentido da média
+    uint y_sum = 0, x_sum = 0;
+
+    for (int i = 0; i < JOYSTICK_RING_SAMPLES; i += 2) {
+        y_sum += ring[i];
+        x_sum += ring[i + 1];
+    }
+
+    *y_raw = y_sum / (JOYSTICK_RING_SAMPLES / 2);
+    *x_raw = x_sum / (JOYSTICK_RING_SAMPLES / 2);
+}
+
+// ===========================================================================
+// CLASSIFICADOR
+// ===========================================================================
+
+static Direction direction_on_axis(bool horizontal, int dx, int dy) {
+    if (horizontal) {
+        return dx < 0 ? DIRECTION_WEST : DIRECTION_EAST;
+    }
+
+    // Regular cartesian plane y logic applies here
+    return dy > 0 ? DIRECTION_NORTH : DIRECTION_SOUTH;
+}
+
+// a direção de um desvio (dx, dy) do centro sabendo a anterior: entrar pede
+// distância ao quadrado de pelo menos enter2 e o eixo mais inclinado; uma
+// direção já escolhida só é largada abaixo de exit2, e só troca de eixo
+// quando o outro passa do dela por axis_margin
+Direction joystick_classify_deviation(Direction previous, int dx, int dy, int enter2, int exit2, int axis_margin) {
+    int distance2 = dx * dx + dy * dy;
+
+    if (previous == DIRECTION_NONE) {
+        return distance2 < enter2 ? DIRECTION_NONE : direction_on_axis(abs(dx) > abs(dy), dx, dy);
+    }
+
+    if (distance2 < exit2) {
+        return DIRECTION_NONE;
+    }
+
+    bool horizontal = previous == DIRECTION_EAST || previous == DIRECTION_WEST;
+    int along = horizontal ? abs(dx) : abs(dy);
+    int across = horizontal ? abs(dy) : abs(dx);
+
+    if (across > along + axis_margin) {
+        horizontal = !horizontal;
+    }
+
+    return direction_on_axis(horizontal, dx, dy);
+}
+
+// a direção de uma leitura, com a mesma regra de joystick_get_info: mais de
+// 50% do raio e o eixo mais inclinado
+Direction joystick_classify(uint x_raw, uint y_raw) {
+    return joystick_classify_hysteresis(DIRECTION_NONE, x_raw, y_raw);
+}
+
+// a direção de uma leitura sem calibração, com o centro e os limiares fixos
+Direction joystick_classify_hysteresis(Direction previous, uint x_raw, uint y_raw) {
+    return joystick_classify_deviation(previous, (int) x_raw - JOYSTICK_CENTER, (int) y_raw - JOYSTICK_CENTER,
+        JOYSTICK_ENTER_DISTANCE * JOYSTICK_ENTER_DISTANCE, JOYSTICK_EXIT_DISTANCE * JOYSTICK_EXIT_DISTANCE, JOYSTICK_AXIS_MARGIN);
+}
+
+// ===========================================================================
+// CALIBRAÇÃO
+// ===========================================================================
+
+// troca as zonas mortas e os filtros; a calibração recomeça do centro nominal
+void joystick_configure(const JoystickConfig* config) {
+    joystick_filter_init(&filter, config);
+    filter_ready = true;
+}
+
+static JoystickFilter* joystick_filter(void) {
+    if (!filter_ready) {
+        JoystickConfig config = JOYSTICK_CONFIG_DEFAULT;
+        joystick_configure(&config);
+    }
+
+    return &filter;
+}
+
+// mede o centro de repouso no boot, com o joystick solto, pela média de
+// algumas leituras; retorna false se ele parecia inclinado e o centro
+// nominal foi mantido (a calibração contínua corrige o resto)
+bool joystick_calibrate(void) {
+    uint x_sum = 0, y_sum = 0;
+
+    for (int i = 0; i < JOYSTICK_CALIBRATION_READS; i++) {
+        // com o amostrador, o anel inteiro é trocado entre uma leitura e outra
+        sleep_us(JOYSTICK_RING_SAMPLES * 1000000 / JOYSTICK_CONVERSIONS_HZ);
+
+        uint x_raw, y_raw;
+        joystick_read_raw(&x_raw, &y_raw);
+        x_sum += x_raw;
+        y_sum += y_raw;
+    }
+
+    return joystick_filter_calibrate(joystick_filter(), x_sum / JOYSTICK_CALIBRATION_READS, y_sum / JOYSTICK_CALIBRATION_READS);
+}
+
+// a direção do joystick para os amostradores de entrada: a média do anel (ou
+// uma leitura, sem o amostrador) filtrada, no centro e no alcance calibrados,
+// e classificada com histerese
+Direction joystick_get_direction(void) {
+    if (joystick_sampler_is_running() && !dma_channel_is_busy(ring_dma)) {
+        joystick_sampler_stop();
+        joystick_sampler_start();
+    }
+
+    uint x_raw, y_raw;
+    joystick_read_raw(&x_raw, &y_raw);
+
+#if SNAKE_JOYSTICK_TRACE
+    // uma linha por leitura, no formato lido por tools/joystick_trace.c
+    printf(JOYSTICK_TRACE_PREFIX "%llu %u %u\n", (unsigned long long) time_us_64(), x_raw, y_raw);
+#endif
+
+    Direction direction = joystick_filter_update(joystick_filter(), x_raw, y_raw, time_us_64());
+    joystick_mark_input(direction);
+
+    return direction;
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include "../inc/constants.h"
+#include "../inc/joystick.h"
+#include "../inc/joystick_filter.h"
+
+// =============================================================
+// JOYSTICK FILTER
+// O caminho de uma leitura do joystick até a direção, só com contas inteiras:
+//
+//   1. um passa-baixa de primeira ordem (IIR) em ponto fixo, com o peso da
+//      leitura nova tirado do tempo desde a anterior, para que o filtro
+//      tenha a mesma constante de tempo a 2 ms no jogo ou a 100 ms nos menus
+//   2. a calibração: o desvio é medido a partir do centro de repouso (medido
+//      no boot e seguido devagar sempre que o joystick está solto) e
+//      multiplicado pela escala do seu lado, que leva o maior alcance já
+//      visto daquele lado a JOYSTICK_CENTER. Um joystick que não chega ao fim
+//      da escala, ou cujo centro não é o nominal, fica com as mesmas zonas
+//      mortas em porcentagem que um perfeito
+//   3. o classificador com histerese de src/joystick.c, contra os limiares
+//      da configuração elevados ao quadrado
+//
+// Os limiares, as escalas e as taxas dos filtros ficam guardados no
+// JoystickFilter e só são recalculados quando a configuração muda ou um lado
+// alcança mais longe, então cada leitura custa algumas multiplicações e
+// deslocamentos por eixo.
+// =============================================================
+
+static int32_t percent_of_center(uint percent) {
+  return JOYSTICK_CENTER * (int32_t) percent / 100;
+}
+
+// 1/tau em Q24 por µs, para que o peso de uma leitura saia de uma
+// multiplicação
+static uint32_t rate_of(uint32_t tau_us) {
+  return tau_us == 0 ? 0 : (1u << 24) / tau_us;
+}
+
+// peso em Q16 de uma leitura nova, elapsed_us depois da anterior, num
+// passa-baixa de constante de tempo tau_us
+static int32_t weight_of(uint64_t elapsed_us, uint32_t tau_us, uint32_t rate) {
+  if (tau_us == 0 || elapsed_us >= tau_us) {
+    return 1 << 16;
+  }
+
+  return (int32_t) (((uint32_t) elapsed_us * rate) >> 8);
+}
+
+static void axis_set_range(JoystickAxis* axis, int side, int32_t range) {
+  axis->range[side] = range < JOYSTICK_MIN_RANGE ? JOYSTICK_MIN_RANGE : range;
+  axis->scale[side] = JOYSTICK_CENTER * JOYSTICK_FILTER_ONE / axis->range[side];
+}
+
+static void axis_calibrate(JoystickAxis* axis, int32_t center, uint range_percent) {
+  axis->center = center * JOYSTICK_FILTER_ONE;
+  axis->filtered = axis->center;
+  axis_set_range(axis, 0, center * (int32_t) range_percent / 100);
+  axis_set_range(axis, 1, (JOYSTICK_MAX - center) * (int32_t) range_percent / 100);
+}
+
+// filtra uma leitura e devolve o desvio calibrado, em unidades de
+// JOYSTICK_CENTER
+static int32_t axis_update(JoystickAxis* axis, uint raw, int32_t weight) {
+  axis->filtered += ((int32_t) raw * JOYSTICK_FILTER_ONE - axis->filtered) * (weight >> 8) / JOYSTICK_FILTER_ONE;
+
+  int32_t deviation = (axis->filtered - axis->center) / JOYSTICK_FILTER_ONE;
+  int side = deviation > 0;
+  int32_t magnitude = abs(deviation);
+
+  if (magnitude > axis->range[side]) {
+    axis_set_range(axis, side, magnitude);
+  }
+
+  return deviation * axis->scale[side] / JOYSTICK_FILTER_ONE;
+}
+
+// aproxima o centro da leitura filtrada, com peso em Q16
+static void axis_follow(JoystickAxis* axis, int32_t weight) {
+  axis->center += (int32_t) ((int64_t) (axis->filtered - axis->center) * weight / (1 << 16));
+}
+
+// calcula os limiares da configuração e começa do centro nominal
+void joystick_filter_init(JoystickFilter* filter, const JoystickConfig* config) {
+  filter->config = *config;
+
+  int32_t enter = percent_of_center(config->enter_percent);
+  int32_t exit = percent_of_center(config->exit_percent);
+
+  filter->enter2 = enter * enter;
+  filter->exit2 = exit * exit;
+  // solto: dentro da metade da zona de saída
+  filter->rest2 = exit * exit / 4;
+  filter->axis_margin = percent_of_center(config->axis_margin_percent);
+  filter->filter_rate = rate_of(config->filter_us);
+  filter->center_rate = rate_of(config->center_us);
+
+  axis_calibrate(&filter->x, JOYSTICK_CENTER, config->initial_range_percent);
+  axis_calibrate(&filter->y, JOYSTICK_CENTER, config->initial_range_percent);
+  joystick_filter_reset(filter);
+}
+
+// adota (x_raw, y_raw) como centro de repouso, com o alcance inicial da
+// configuração; recusa (e retorna false) um centro longe demais do nominal
+bool joystick_filter_calibrate(JoystickFilter* filter, uint x_raw, uint y_raw) {
+  if (abs((int) x_raw - JOYSTICK_CENTER) > JOYSTICK_CALIBRATION_MAX_OFFSET ||
+      abs((int) y_raw - JOYSTICK_CENTER) > JOYSTICK_CALIBRATION_MAX_OFFSET) {
+    return false;
+  }
+
+  axis_calibrate(&filter->x, (int32_t) x_raw, filter->config.initial_range_percent);
+  axis_calibrate(&filter->y, (int32_t) y_raw, filter->config.initial_range_percent);
+  joystick_filter_reset(filter);
+
+  return true;
+}
+
+// esquece a direção e a última leitura, mantendo a calibração
+void joystick_filter_reset(JoystickFilter* filter) {
+  filter->direction = DIRECTION_NONE;
+  filter->primed = false;
+}
+
+// passa uma leitura pelo filtro, pela calibração e pelo classificador
+Direction joystick_filter_update(JoystickFilter* filter, uint x_raw, uint y_raw, uint64_t now_us) {
+  uint64_t elapsed_us = filter->primed ? now_us - filter->last_us : UINT64_MAX;
+  filter->last_us = now_us;
+  filter->primed = true;
+
+  int32_t weight = weight_of(elapsed_us, filter->config.filter_us, filter->filter_rate);
+  int32_t dx = axis_update(&filter->x, x_raw, weight);
+  int32_t dy = axis_update(&filter->y, y_raw, weight);
+
+  filter->direction = joystick_classify_deviation(filter->direction, dx, dy, filter->enter2, filter->exit2, filter->axis_margin);
+
+  // solto, o centro segue a deriva do joystick
+  if (filter->direction == DIRECTION_NONE && dx * dx + dy * dy < filter->rest2) {
+    int32_t center_weight = weight_of(elapsed_us, filter->config.center_us, filter->center_rate);
+    axis_follow(&filter->x, center_weight);
+    axis_follow(&filter->y, center_weight);
+  }
+
+  return filter->direction;
+}
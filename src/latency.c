@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "../inc/latency.h"
+
+// =============================================================
+// LATENCY
+// Sondas que medem onde vai o tempo entre mexer o joystick e ver a cobra
+// virar: joystick_get_direction (e joystick_get_info) marca o instante em
+// que a direção mudou, o loop do jogo marca o tick que aplicou a mudança,
+// npWrite fecha os trechos até os LEDs e ssd1306_send_buffer mede o envio
+// do buffer do OLED por I2C desde render_on_display (e o trecho desde a
+// entrada, nos menus). O trecho do som vai do último pedido de melodia até
+// o sequenciador (audio.c) esvaziar as filas. Com o core de saída
+// (output.c) os trechos até as saídas incluem a espera na fila do core1.
+// Cada trecho tem um histograma de tamanho fixo, impresso pela serial USB
+// quando chega um 'l' (e zerado com um 'r').
+//
+// As marcas são só do core0, e mexidas com as interrupções desligadas (as
+// sondas também rodam nos alarmes, e no M0+ um uint64_t é lido e escrito em
+// duas metades). Com o core de saída, o core0 tira as marcas ao enviar um
+// comando e elas vão junto dele até o core1 (LATENCY_TAKE e
+// LATENCY_RECORD). Cada histograma só é escrito pelo core que grava nele:
+// latency_reset só pede o recomeço, e o histograma é zerado na próxima
+// gravação; até lá a impressão o mostra vazio.
+//
+// Com SNAKE_LATENCY_PROBES desligado este arquivo fica vazio e as macros de
+// ../inc/latency.h não geram código.
+// =============================================================
+
+#if SNAKE_LATENCY_PROBES
+
+#define LATENCY_EXACT_US 8
+
+static const char* span_names[LATENCY_SPANS] = {
+  "input -> tick",
+  "tick -> leds",
+  "input -> leds",
+  "oled flush",
+  "input -> oled",
+  "audio",
+};
+
+static uint64_t marks[LATENCY_MARKS];
+static LatencyHistogram histograms[LATENCY_SPANS];
+// pedidos de latency_reset, e o último que cada histograma já atendeu
+static atomic_uint reset_generation;
+static atomic_uint histogram_generations[LATENCY_SPANS];
+static const LatencyHistogram empty_histogram;
+
+static int bucket_of(uint32_t us) {
+  if (us < LATENCY_EXACT_US) {
+    return (int) us;
+  }
+
+  int msb = 31 - __builtin_clz(us);
+  int sub = (int) (us >> (msb - 2)) & 3;
+
+  return LATENCY_EXACT_US + (msb - 3) * 4 + sub;
+}
+
+// maior valor que cai na faixa
+static uint32_t bucket_limit(int bucket) {
+  if (bucket < LATENCY_EXACT_US) {
+    return (uint32_t) bucket;
+  }
+
+  int msb = (bucket - LATENCY_EXACT_US) / 4 + 3;
+  int sub = (bucket - LATENCY_EXACT_US) % 4;
+  uint64_t limit = ((uint64_t) (4 + sub + 1) << (msb - 2)) - 1;
+
+  return limit > UINT32_MAX ? UINT32_MAX : (uint32_t) limit;
+}
+
+void latency_mark(int mark) {
+  // 0 quer dizer sem marca, então o instante 0 vira 1
+  uint64_t now = time_us_64();
+  uint32_t interrupts = save_and_disable_interrupts();
+  marks[mark] = now == 0 ? 1 : now;
+  restore_interrupts(interrupts);
+}
+
+// marca só se não houver uma marca pendente, para medir a partir da primeira
+void latency_mark_first(int mark) {
+  uint64_t now = time_us_64();
+  uint32_t interrupts = save_and_disable_interrupts();
+
+  if (marks[mark] == 0) {
+    marks[mark] = now == 0 ? 1 : now;
+  }
+
+  restore_interrupts(interrupts);
+}
+
+void latency_clear(int mark) {
+  uint32_t interrupts = save_and_disable_interrupts();
+  marks[mark] = 0;
+  restore_interrupts(interrupts);
+}
+
+// lê a marca e, com clear, a apaga
+static uint64_t mark_read(int mark, bool clear) {
+  uint32_t interrupts = save_and_disable_interrupts();
+  uint64_t since = marks[mark];
+
+  if (clear) {
+    marks[mark] = 0;
+  }
+
+  restore_interrupts(interrupts);
+
+  return since;
+}
+
+// registra o tempo desde since no histograma do trecho, se houver marca
+static void record_since(int span, uint64_t since) {
+  if (since == 0) {
+    return;
+  }
+
+  uint64_t elapsed = time_us_64() - since;
+  uint32_t us = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t) elapsed;
+  LatencyHistogram* histogram = &histograms[span];
+  unsigned generation = atomic_load_explicit(&reset_generation, memory_order_acquire);
+
+  // um latency_reset desde a última gravação: zera aqui, no core dono
+  if (atomic_load_explicit(&histogram_generations[span], memory_order_relaxed) != generation) {
+    memset(histogram, 0, sizeof(*histogram));
+    atomic_store_explicit(&histogram_generations[span], generation, memory_order_release);
+  }
+
+  histogram->buckets[bucket_of(us)]++;
+  histogram->count++;
+  histogram->max_us = us > histogram->max_us ? us : histogram->max_us;
+}
+
+// registra o tempo desde a marca no histograma do trecho, se houver marca
+void latency_span(int span, int mark) {
+  record_since(span, mark_read(mark, false));
+}
+
+// passa a marca (e a apaga) para os stamps de um comando do core de saída
+void latency_take(LatencyStamps* stamps, int mark) {
+  stamps->us[mark] = mark_read(mark, true);
+}
+
+// como latency_span, com a marca tirada por latency_take
+void latency_record(int span, const LatencyStamps* stamps, int mark) {
+  record_since(span, stamps->us[mark]);
+}
+
+void latency_reset(void) {
+  atomic_fetch_add_explicit(&reset_generation, 1, memory_order_release);
+
+  uint32_t interrupts = save_and_disable_interrupts();
+  memset(marks, 0, sizeof(marks));
+  restore_interrupts(interrupts);
+}
+
+// o histograma do trecho, ou um vazio se ele ainda não atendeu um
+// latency_reset
+const LatencyHistogram* latency_histogram(int span) {
+  if (atomic_load_explicit(&histogram_generations[span], memory_order_acquire) !=
+      atomic_load_explicit(&reset_generation, memory_order_acquire)) {
+    return &empty_histogram;
+  }
+
+  return &histograms[span];
+}
+
+// limite superior da faixa onde está o percentil (entre 0 e 1)
+uint32_t latency_percentile_us(const LatencyHistogram* histogram, double percentile) {
+  uint32_t wanted = (uint32_t) (histogram->count * percentile);
+  uint32_t seen = 0;
+
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += histogram->buckets[i];
+
+    if (seen > wanted) {
+      uint32_t limit = bucket_limit(i);
+      return limit < histogram->max_us ? limit : histogram->max_us;
+    }
+  }
+
+  return histogram->max_us;
+}
+
+void latency_dump(void) {
+  printf("latency: %-18s %8s %10s %10s %10s\n", "span", "count", "p50 us", "p99 us", "max us");
+
+  for (int span = 0; span < LATENCY_SPANS; span++) {
+    const LatencyHistogram* histogram = latency_histogram(span);
+
+    printf("latency: %-18s %8lu %10lu %10lu %10lu\n", span_names[span], (unsigned long) histogram->count,
+        (unsigned long) latency_percentile_us(histogram, 0.5), (unsigned long) latency_percentile_us(histogram, 0.99),
+        (unsigned long) histogram->max_us);
+  }
+}
+
+// atende, sem esperar, os comandos recebidos pela serial: 'l' imprime os
+// histogramas e 'r' os zera
+void latency_poll(void) {
+  int command = getchar_timeout_us(0);
+
+  if (command == 'l') {
+    latency_dump();
+  } else if (command == 'r') {
+    latency_reset();
+  }
+}
+
+#endif
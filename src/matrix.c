@@ -1,3 +1,6 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <malloc.h>
 #include "../inc/matrix.h"
 #include "../inc/utils.h"
@@ -5,10 +8,17 @@
 // ===========================================================================
 // MATRIX
 // Uma abstração da estrutura de dados matriz.
+// As células ficam num único bloco contíguo (row-major), cada uma ocupando um
+// byte, e são acessadas por índice linear (row * cols + col).
 // ===========================================================================
 
 // inicia a matriz
 Matrix* matrix_init(int n_rows, int n_cols) {
+  if (n_rows < 1 || n_cols < 1) {
+    fprintf(stderr, "Invalid matrix size: %ix%i.\n", n_rows, n_cols);
+    exit(EXIT_FAILURE);
+  }
+
   Matrix* matrix = malloc(sizeof(Matrix));
 
   if (matrix == NULL) {
@@ -17,36 +27,35 @@ Matrix* matrix_init(int n_rows, int n_cols) {
 
   matrix->rows = n_rows;
   matrix->cols = n_cols;
+  matrix->data = calloc((size_t) n_rows * (size_t) n_cols, sizeof(MatrixDataType));
 
-  MatrixDataType** data = malloc(sizeof(MatrixDataType*) * n_rows);
-
-  if (data == NULL) {
+  if (matrix->data == NULL) {
     memory_allocation_error();
   }
 
-  for (int i = 0; i < n_rows; i++) {
-    data[i] = calloc(n_cols, sizeof(MatrixDataType));
-
-    if (data[i] == NULL) {
-      memory_allocation_error();
-    }
-  }
-
-  matrix->data = data;
-
   return matrix;
 };
 
 // pega o valor de uma certa posição da matriz
 MatrixDataType matrix_get(Matrix* matrix, MatrixPosition position) {
   int row = position[0], col = position[1];
-  return matrix->data[row][col];
+  return matrix->data[matrix_index(matrix, row, col)];
 }
 
 // preenche uma posição da matriz
 void matrix_put(Matrix* matrix, MatrixPosition position, MatrixDataType val) {
   int row = position[0], col = position[1];
-  matrix->data[row][col] = val;
+  matrix->data[matrix_index(matrix, row, col)] = val;
+}
+
+// preenche a matriz inteira com um mesmo valor
+void matrix_fill(Matrix* matrix, MatrixDataType val) {
+  memset(matrix->data, val, matrix_size(matrix) * sizeof(MatrixDataType));
+}
+
+// quantidade de células da matriz
+size_t matrix_size(Matrix* matrix) {
+  return (size_t) matrix->rows * (size_t) matrix->cols;
 }
 
 // libera a memória alocada para a matriz
@@ -55,10 +64,6 @@ void matrix_free(Matrix* matrix) {
     return;
   }
 
-  for (int i = 0; i < matrix->rows; i++) {
-      free(matrix->data[i]);
-  }
-
   free(matrix->data);
   free(matrix);
 }
@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "../inc/utils.h"
+#include "../inc/constants.h"
+#include "../inc/canvas.h"
+#include "../inc/mcts.h"
+
+// =============================================================
+// MCTS
+// Escolhe a direção da cobra por busca em árvore de Monte Carlo (UCT). Cada
+// simulação restaura o jogo de um snapshot (src/snapshot.c) num GameState
+// reservado, desce a árvore pelas regras de game_step, expande um node e
+// termina com movimentos que evitam colisões imediatas, em geral na direção
+// da comida. O valor de uma simulação é 0.5 se a cobra sobreviver mais a
+// metade da soma das comidas, cada uma descontada por MCTS_DISCOUNT a cada
+// movimento até ela (até 0.5), ou 1 se a cobra vencer.
+//
+// As comidas das simulações são sorteadas com sementes do gerador da busca,
+// não com o gerador do jogo, então a busca não conhece as comidas futuras e,
+// com um limite de simulações no lugar do limite de tempo, a mesma semente
+// sempre produz as mesmas decisões. Como as comidas mudam de uma simulação
+// para outra, os nodes representam sequências de direções, não estados.
+//
+// Os nodes ficam numa arena de tamanho fixo, alocada no mcts_init e
+// reaproveitada a cada decisão; nenhuma decisão aloca memória.
+// =============================================================
+
+// quantos movimentos de cada 4 das simulações vão na direção da comida
+#define MCTS_GREEDY_ROLLOUT_MOVES 3
+
+// desconto por movimento do valor de cada comida, para que comer antes valha
+// mais do que comer depois
+#define MCTS_DISCOUNT 0.9f
+
+static void* allocate(size_t size) {
+  void* pointer = malloc(size);
+
+  if (pointer == NULL) {
+    memory_allocation_error();
+  }
+
+  return pointer;
+}
+
+static Direction index_direction(int index) {
+  return DIRECTION_NORTH + index;
+}
+
+MctsConfig mcts_default_config(int rows, int cols) {
+  return (MctsConfig) {
+    .node_capacity = MCTS_DEFAULT_NODE_CAPACITY,
+    .budget_us = MCTS_DEFAULT_BUDGET_US,
+    .max_rollouts = 0,
+    .rollout_depth = 2 * (rows + cols),
+    .exploration = 0.5f,
+    .seed = 0,
+  };
+}
+
+Mcts* mcts_init(int rows, int cols, MctsConfig config) {
+  if (rows * cols > SNAPSHOT_MAX_CELLS || config.node_capacity < 1 || (config.budget_us == 0 && config.max_rollouts == 0)) {
+    fprintf(stderr, "Invalid MCTS: %ix%i canvas, %u nodes, %u us and %u rollouts per decision.\n",
+        rows, cols, (unsigned) config.node_capacity, (unsigned) config.budget_us, (unsigned) config.max_rollouts);
+    exit(EXIT_FAILURE);
+  }
+
+  Mcts* mcts = allocate(sizeof(Mcts));
+
+  mcts->config = config;
+  mcts->nodes = allocate(sizeof(MctsNode) * config.node_capacity);
+  mcts->node_count = 0;
+  mcts->path = allocate(sizeof(uint32_t) * (config.node_capacity + 1));
+  mcts->scratch = game_state_init(rows, cols, 0);
+  mcts->stats = (MctsStats) { 0 };
+  random_seed(&mcts->random, config.seed);
+
+  return mcts;
+}
+
+void mcts_free(Mcts* mcts) {
+  if (mcts == NULL) {
+    return;
+  }
+
+  game_state_free(mcts->scratch);
+  free(mcts->path);
+  free(mcts->nodes);
+  free(mcts);
+}
+
+static uint32_t new_node(Mcts* mcts) {
+  if (mcts->node_count == mcts->config.node_capacity) {
+    return MCTS_NO_NODE;
+  }
+
+  MctsNode* node = &mcts->nodes[mcts->node_count];
+
+  for (int i = 0; i < MCTS_DIRECTIONS; i++) {
+    node->children[i] = MCTS_NO_NODE;
+  }
+
+  node->visits = 0;
+  node->value = 0;
+
+  return mcts->node_count++;
+}
+
+// escolhe por onde descer a partir do node: uma direção ainda não expandida
+// (sorteada), se houver e a arena tiver espaço, ou o filho de maior UCT;
+// retorna -1 se não houver para onde descer
+static int choose_child(Mcts* mcts, MctsNode* node) {
+  GameState* scratch = mcts->scratch;
+  bool can_expand = mcts->node_count < mcts->config.node_capacity;
+  int start = (int) random_bounded(&mcts->random, MCTS_DIRECTIONS);
+  int best = -1;
+  float best_score = 0;
+  float log_visits = logf((float) node->visits + 1);
+
+  for (int i = 0; i < MCTS_DIRECTIONS; i++) {
+    int index = (start + i) % MCTS_DIRECTIONS;
+
+    if (!game_direction_is_valid(scratch, index_direction(index))) {
+      continue;
+    }
+
+    uint32_t child = node->children[index];
+
+    if (child == MCTS_NO_NODE) {
+      if (can_expand) {
+        return index;
+      }
+
+      continue;
+    }
+
+    MctsNode* c = &mcts->nodes[child];
+    float score = c->value / c->visits + mcts->config.exploration * sqrtf(log_visits / c->visits);
+
+    if (best < 0 || score > best_score) {
+      best = index;
+      best_score = score;
+    }
+  }
+
+  return best;
+}
+
+// distância com a volta pelas bordas
+static int wrapped_distance(int from, int to, int size) {
+  int distance = abs(from - to);
+  return distance < size - distance ? distance : size - distance;
+}
+
+// movimento das simulações: entre as direções que não colidem no próximo
+// movimento, a mais perto da comida em MCTS_GREEDY_ROLLOUT_MOVES de cada 4
+// movimentos e uma qualquer nos demais (a atual, se todas colidirem)
+static Direction rollout_direction(Mcts* mcts) {
+  GameState* scratch = mcts->scratch;
+  Canvas* canvas = scratch->canvas;
+  Snake* snake = scratch->snake;
+  Food* food = scratch->food;
+  Direction current = snake->direction;
+  Direction best = current;
+  int best_distance = -1;
+  uint32_t draw = random_bounded(&mcts->random, MCTS_DIRECTIONS * MCTS_DIRECTIONS);
+  bool greedy = food->in_canvas && (int) (draw / MCTS_DIRECTIONS) < MCTS_GREEDY_ROLLOUT_MOVES;
+  int start = (int) (draw % MCTS_DIRECTIONS);
+
+  for (int i = 0; i < MCTS_DIRECTIONS; i++) {
+    Direction direction = index_direction((start + i) % MCTS_DIRECTIONS);
+
+    if (!game_direction_is_valid(scratch, direction)) {
+      continue;
+    }
+
+    Position next;
+    snake->direction = direction;
+    bool collides = snake_next_move_collides(snake, canvas);
+    get_next_node_position(snake, canvas, 0, next);
+    snake->direction = current;
+
+    if (collides) {
+      continue;
+    }
+
+    if (!greedy) {
+      return direction;
+    }
+
+    int distance = wrapped_distance(next[0], food->position[0], canvas->rows) +
+                   wrapped_distance(next[1], food->position[1], canvas->cols);
+
+    if (best_distance < 0 || distance < best_distance) {
+      best = direction;
+      best_distance = distance;
+    }
+  }
+
+  return best;
+}
+
+// uma simulação: seleção, expansão, movimentos até rollout_depth e propagação do
+// valor pelos nodes do caminho
+static void simulate(Mcts* mcts) {
+  GameState* scratch = mcts->scratch;
+  uint32_t node = 0;
+  int depth = 0;
+  float food = 0;
+  float discount = 1;
+
+  game_snapshot_load(scratch, &mcts->root);
+  canvas_seed(scratch->canvas, random_next64(&mcts->random));
+  mcts->path[depth++] = node;
+
+  while (!scratch->over) {
+    int index = choose_child(mcts, &mcts->nodes[node]);
+
+    if (index < 0) {
+      break;
+    }
+
+    uint32_t child = mcts->nodes[node].children[index];
+    bool expanded = child == MCTS_NO_NODE;
+
+    if (expanded) {
+      child = new_node(mcts);
+      mcts->nodes[node].children[index] = child;
+    }
+
+    discount *= MCTS_DISCOUNT;
+    food += game_step(scratch, (GameInput) { .direction = index_direction(index) }) & GAME_EVENT_ATE ? discount : 0;
+    node = child;
+    mcts->path[depth++] = node;
+
+    if (expanded) {
+      break;
+    }
+  }
+
+  int moves = 0;
+
+  for (; moves < mcts->config.rollout_depth && !scratch->over; moves++) {
+    discount *= MCTS_DISCOUNT;
+    food += game_step(scratch, (GameInput) { .direction = rollout_direction(mcts) }) & GAME_EVENT_ATE ? discount : 0;
+  }
+
+  mcts->stats.rollout_moves += moves;
+
+  float value = scratch->won ? 1 : (scratch->over ? 0 : 0.5f) + 0.5f * (food < 1 ? food : 1);
+
+  for (int i = 0; i < depth; i++) {
+    mcts->nodes[mcts->path[i]].visits++;
+    mcts->nodes[mcts->path[i]].value += value;
+  }
+}
+
+// simula a partir do estado até esgotar o tempo ou as simulações da decisão e
+// retorna a direção mais visitada
+Direction mcts_decide(Mcts* mcts, GameState* state) {
+  Snake* snake = state->snake;
+
+  if (state->over || !game_snapshot_save(state, &mcts->root)) {
+    return snake->direction;
+  }
+
+  uint64_t start = time_us_64();
+  uint32_t rollouts = 0;
+
+  mcts->node_count = 0;
+  new_node(mcts);
+
+  while (true) {
+    simulate(mcts);
+    rollouts++;
+
+    if (mcts->config.max_rollouts > 0 && rollouts >= mcts->config.max_rollouts) {
+      break;
+    }
+
+    if (mcts->config.budget_us > 0 && time_us_64() - start >= mcts->config.budget_us) {
+      break;
+    }
+  }
+
+  MctsNode* root = &mcts->nodes[0];
+  Direction best = snake->direction;
+  uint32_t best_visits = 0;
+
+  for (int i = 0; i < MCTS_DIRECTIONS; i++) {
+    uint32_t child = root->children[i];
+
+    if (child != MCTS_NO_NODE && mcts->nodes[child].visits > best_visits) {
+      best = index_direction(i);
+      best_visits = mcts->nodes[child].visits;
+    }
+  }
+
+  mcts->stats.decisions++;
+  mcts->stats.rollouts += rollouts;
+  mcts->stats.arena_full += mcts->node_count == mcts->config.node_capacity;
+  mcts->stats.elapsed_us += time_us_64() - start;
+
+  return best;
+}
@@ -3,68 +3,66 @@
 #include "hardware/clocks.h"
 #include "hardware/pwm.h"
 #include "pico/stdlib.h"
+#include "../inc/latency.h"
+#include "../inc/audio.h"
 
 // ===========================================================================
 // MELODY
-// Possui as melodias do jogo. Isso inclui as músicas e efeitos sonoros.
+// Possui as melodias do jogo. Isso inclui as músicas e efeitos sonoros, que
+// são escritos em src/melodies.score, convertidos em tabelas na compilação
+// e tocados pelo sequenciador de audio.c sem bloquear quem os pediu.
 // ===========================================================================
 
-// toca uma nota por um determinado tempo.
-// copiado do exemplo em https://github.com/BitDogLab/BitDogLab-C/blob/main/buzzer_pwm1/buzzer_pwm1.c.
+#if defined(SYS_CLK_KHZ) && SYS_CLK_KHZ * 1000 != MELODY_SYS_CLOCK_HZ
+#error "note_pwm was generated for another clk_sys: set SNAKE_SYS_CLOCK_HZ to SYS_CLK_KHZ * 1000"
+#endif
+
+// liga o buzzer numa nota (NOTE_*), até tone_off. O wrap e o divisor vêm da
+// tabela gerada na compilação, então não há divisão aqui.
+// Baseado no exemplo em https://github.com/BitDogLab/BitDogLab-C/blob/main/buzzer_pwm1/buzzer_pwm1.c.
 // Também pode ser encontrado no exemplo em https://github.com/BitDogLab/BitDogLab-C/blob/main/button-buzzer/button-buzzer.c.
-static void play_tone(uint pin, uint frequency, uint duration_ms) {
+void tone_on(uint pin, uint note) {
     uint slice_num = pwm_gpio_to_slice_num(pin);
-    uint32_t clock_freq = clock_get_hz(clk_sys);
-    uint32_t top = clock_freq / frequency - 1;
+    const NotePwm* pwm = &note_pwm[note];
 
-    pwm_set_wrap(slice_num, top);
-    pwm_set_gpio_level(pin, top / 2); // 50% de duty cycle
+    pwm_set_clkdiv_int_frac(slice_num, pwm->div_int, pwm->div_frac);
+    pwm_set_wrap(slice_num, pwm->wrap);
+    pwm_set_gpio_level(pin, (uint16_t) ((pwm->wrap + 1) / 2)); // 50% de duty cycle
+}
 
-    sleep_ms(duration_ms);
+void tone_off(uint pin) {
+    pwm_set_gpio_level(pin, 0);
+}
 
-    pwm_set_gpio_level(pin, 0); // Desliga o som após a duração
+// põe uma melodia na fila de uma camada do sequenciador (veja audio.c)
+static void play_on_layer(uint pin, const MelodyStep* melody, uint melody_length, int layer, int mode) {
+    LATENCY_MARK(LATENCY_MARK_AUDIO);
+    audio_play(pin, layer, melody, melody_length, mode);
 }
 
-// toca uma melodia. "melodia" aqui é entendido como um array de arrays { nota, duração }
-void play_melody(uint pin, Melody melody, uint melody_length) {
-    for (uint i = 0; i < melody_length; i++) {
-        uint note = melody[i][0];
-        uint duration = melody[i][1];
-        play_tone(pin, note, duration);
-    }
+// toca uma melodia depois das músicas que já estão na fila, e retorna na
+// hora. As melodias do jogo ficam em src/melodies.score; uma montada no
+// código é um array de MELODY_STEP(NOTE_*, ticks).
+void play_melody(uint pin, const MelodyStep* melody, uint melody_length) {
+    play_on_layer(pin, melody, melody_length, AUDIO_MUSIC, AUDIO_QUEUE);
 }
 
 // toca a melodia de vitória
 void play_game_won(uint pin) {
-    uint melody[][2] = {
-        { NOTE_C5, 300 },
-        { NOTE_D5, 300 },
-        { NOTE_G5, 300 },
-        { NOTE_C6, 600 },
-        { NOTE_D5, 300 },
-        { NOTE_C5, 600 },
-    };
-    play_melody(pin, melody, count_of(melody));
+    play_on_layer(pin, melody_game_won, MELODY_GAME_WON_LENGTH, AUDIO_MUSIC, AUDIO_PREEMPT);
 }
 
 // toca a melodia de derrota
 void play_game_over(uint pin) {
-    uint melody[][2] = {
-        { NOTE_A4, 300 },
-        { NOTE_G4, 300 },
-        { NOTE_F4, 400 },
-        { NOTE_E4, 600 },
-    };
-    play_melody(pin, melody, count_of(melody));
+    play_on_layer(pin, melody_game_over, MELODY_GAME_OVER_LENGTH, AUDIO_MUSIC, AUDIO_PREEMPT);
 }
 
-// toca a melodia de "mordida", para quando a cobra come
+// toca a melodia de "mordida", para quando a cobra come. Os efeitos
+// interrompem a música, e um efeito novo corta o anterior
 void play_bite(uint pin) {
-    Melody melody = { { 392, 50 } };
-    play_melody(pin, melody, count_of(melody));
+    play_on_layer(pin, melody_bite, MELODY_BITE_LENGTH, AUDIO_EFFECTS, AUDIO_PREEMPT);
 }
 
 void play_selection_move(uint pin) {
-    Melody melody = { { NOTE_Cs4, 50 } };
-    play_melody(pin, melody, count_of(melody));
-}
\ No newline at end of file
+    play_on_layer(pin, melody_selection_move, MELODY_SELECTION_MOVE_LENGTH, AUDIO_EFFECTS, AUDIO_PREEMPT);
+}
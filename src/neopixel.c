@@ -3,6 +3,8 @@
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
 #include "../inc/neopixel.h"
+#include "../inc/latency.h"
+#include "../inc/output.h"
 
 // =================================================================================
 // NEOPIXEL
@@ -66,14 +68,32 @@ void npClear() {
 }
 
 /**
- * Escreve os dados do buffer nos LEDs.
+ * Escreve os dados do buffer nos LEDs. Com o core de saída rodando (veja
+ * output.c), uma cópia do buffer é enviada para ele e a escrita acontece lá.
  */
 void npWrite() {
+  if (output_post_leds(leds)) {
+    return;
+  }
+
+  npWriteBuffer(leds);
+
+  // fim das medidas de latência até os LEDs (com o core de saída, em output.c)
+  LATENCY_SPAN(LATENCY_TICK_TO_LEDS, LATENCY_MARK_TICK);
+  LATENCY_CLEAR(LATENCY_MARK_TICK);
+  LATENCY_SPAN(LATENCY_INPUT_TO_LEDS, LATENCY_MARK_INPUT);
+  LATENCY_CLEAR(LATENCY_MARK_INPUT);
+}
+
+/**
+ * Escreve um buffer de pixels nos LEDs, esperando a máquina PIO.
+ */
+void npWriteBuffer(const npLED_t* buffer) {
   // Escreve cada dado de 8-bits dos pixels em sequência no buffer da máquina PIO.
   for (uint i = 0; i < LED_COUNT; ++i) {
-    pio_sm_put_blocking(np_pio, sm, leds[i].G);
-    pio_sm_put_blocking(np_pio, sm, leds[i].R);
-    pio_sm_put_blocking(np_pio, sm, leds[i].B);
+    pio_sm_put_blocking(np_pio, sm, buffer[i].G);
+    pio_sm_put_blocking(np_pio, sm, buffer[i].R);
+    pio_sm_put_blocking(np_pio, sm, buffer[i].B);
   }
   sleep_us(100); // Espera 100us, sinal de RESET do datasheet.
 }
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "../inc/neopixel.h"
+#include "../inc/latency.h"
+#include "../inc/display_oled/ssd1306.h"
+#include "../inc/output.h"
+
+// =============================================================
+// OUTPUT
+// Depois de output_start, o core1 é o dono da matriz de LEDs e do OLED.
+// npWrite, ssd1306_send_command_list e ssd1306_send_buffer, chamadas no
+// core0, copiam o que iam escrever num comando e o publicam numa fila de um
+// produtor e um consumidor; o core1 tira os comandos em ordem e faz as
+// escritas que bloqueiam (o FIFO da PIO, as transferências I2C), enquanto o
+// core0 segue com o tick. O buzzer fica no core0, com o sequenciador de
+// audio.c, que não bloqueia. As marcas das sondas de latência que uma saída
+// fecha vão dentro do comando, e o core1 não lê as do core0.
+//
+// A fila não usa travas: cada lado escreve só a sua posição, com ordem de
+// liberação (release) depois de escrever o comando e de aquisição (acquire)
+// antes de lê-lo. Com a fila cheia o core0 espera; com ela vazia o core1
+// dorme em __wfe até o __sev de uma publicação.
+//
+// Sem output_start tudo continua sendo escrito na hora, no core que chamou,
+// como nos benchmarks e ferramentas de host.
+// =============================================================
+
+static OutputQueue queue;
+// ligado pelo core0 em output_start e desligado pelo core1 ao parar
+static atomic_bool running;
+
+// =============================================================
+// FILA
+// =============================================================
+
+void output_queue_init(OutputQueue* queue) {
+  atomic_store(&queue->head, 0);
+  atomic_store(&queue->tail, 0);
+}
+
+// próximo comando livre para o produtor preencher, ou NULL com a fila cheia
+OutputCommand* output_queue_reserve(OutputQueue* queue) {
+  uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+  if (tail - atomic_load_explicit(&queue->head, memory_order_acquire) == OUTPUT_QUEUE_CAPACITY) {
+    return NULL;
+  }
+
+  return &queue->items[tail % OUTPUT_QUEUE_CAPACITY];
+}
+
+// entrega ao consumidor o comando preenchido depois de output_queue_reserve
+void output_queue_publish(OutputQueue* queue) {
+  uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+}
+
+// comando mais antigo ainda não liberado, ou NULL com a fila vazia
+OutputCommand* output_queue_peek(OutputQueue* queue) {
+  uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+  if (head == atomic_load_explicit(&queue->tail, memory_order_acquire)) {
+    return NULL;
+  }
+
+  return &queue->items[head % OUTPUT_QUEUE_CAPACITY];
+}
+
+// devolve ao produtor o comando de output_queue_peek, depois de executado
+void output_queue_release(OutputQueue* queue) {
+  uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
+
+bool output_queue_is_empty(OutputQueue* queue) {
+  return atomic_load_explicit(&queue->head, memory_order_acquire) == atomic_load_explicit(&queue->tail, memory_order_acquire);
+}
+
+// =============================================================
+// CORE1
+// =============================================================
+
+static void output_execute(const OutputCommand* command) {
+  switch (command->type) {
+    case OUTPUT_LEDS: {
+      npWriteBuffer(command->leds);
+      LATENCY_RECORD(LATENCY_TICK_TO_LEDS, &command->latency, LATENCY_MARK_TICK);
+      LATENCY_RECORD(LATENCY_INPUT_TO_LEDS, &command->latency, LATENCY_MARK_INPUT);
+      break;
+    } case OUTPUT_OLED_COMMANDS: {
+      ssd1306_write_command_list(command->oled_commands, command->length);
+      break;
+    } case OUTPUT_OLED_BUFFER: {
+      ssd1306_write_buffer(command->oled_buffer, command->length);
+      LATENCY_RECORD(LATENCY_OLED_FLUSH, &command->latency, LATENCY_MARK_OLED);
+      LATENCY_RECORD(LATENCY_INPUT_TO_OLED, &command->latency, LATENCY_MARK_INPUT);
+      break;
+    }
+  }
+}
+
+static void output_core_main(void) {
+  while (true) {
+    OutputCommand* command = output_queue_peek(&queue);
+
+    if (command == NULL) {
+      __wfe();
+      continue;
+    }
+
+    if (command->type == OUTPUT_STOP) {
+      output_queue_release(&queue);
+      atomic_store(&running, false);
+      return;
+    }
+
+    output_execute(command);
+    output_queue_release(&queue);
+  }
+}
+
+// =============================================================
+// CORE0
+// =============================================================
+
+// passa as saídas para o core1; chamada depois de iniciar os periféricos
+void output_start(void) {
+  if (output_is_running()) {
+    return;
+  }
+
+  output_queue_init(&queue);
+  atomic_store(&running, true);
+
+  multicore_launch_core1(output_core_main);
+}
+
+// espera os comandos enviados e devolve as saídas ao core0
+void output_stop(void) {
+  if (!output_is_running()) {
+    return;
+  }
+
+  OutputCommand* command;
+
+  while ((command = output_queue_reserve(&queue)) == NULL) {
+    tight_loop_contents();
+  }
+
+  command->type = OUTPUT_STOP;
+  output_queue_publish(&queue);
+  __sev();
+
+  while (atomic_load(&running)) {
+    tight_loop_contents();
+  }
+
+  multicore_reset_core1();
+}
+
+bool output_is_running(void) {
+  return atomic_load(&running);
+}
+
+// espera o core1 executar todos os comandos enviados até aqui
+void output_flush(void) {
+  while (output_is_running() && !output_queue_is_empty(&queue)) {
+    tight_loop_contents();
+  }
+}
+
+// espera um lugar na fila; os timers do core0 continuam disparando enquanto
+// isso
+static OutputCommand* output_reserve(uint16_t type, uint16_t length) {
+  OutputCommand* command;
+
+  while ((command = output_queue_reserve(&queue)) == NULL) {
+    tight_loop_contents();
+  }
+
+  command->type = type;
+  command->length = length;
+
+  return command;
+}
+
+static void output_publish(void) {
+  output_queue_publish(&queue);
+  __sev();
+}
+
+// as funções output_post_* retornam false sem o core de saída, e aí quem
+// chamou escreve na hora
+
+bool output_post_leds(const npLED_t* leds) {
+  if (!output_is_running()) {
+    return false;
+  }
+
+  OutputCommand* command = output_reserve(OUTPUT_LEDS, sizeof(npLED_t) * LED_COUNT);
+  memcpy(command->leds, leds, sizeof(npLED_t) * LED_COUNT);
+  LATENCY_TAKE(&command->latency, LATENCY_MARK_TICK);
+  LATENCY_TAKE(&command->latency, LATENCY_MARK_INPUT);
+  output_publish();
+
+  return true;
+}
+
+bool output_post_oled_commands(const uint8_t* commands, int count) {
+  if (!output_is_running()) {
+    return false;
+  }
+
+  for (int offset = 0; offset < count; offset += OUTPUT_OLED_MAX_COMMANDS) {
+    int length = count - offset < OUTPUT_OLED_MAX_COMMANDS ? count - offset : OUTPUT_OLED_MAX_COMMANDS;
+    OutputCommand* command = output_reserve(OUTPUT_OLED_COMMANDS, (uint16_t) length);
+    memcpy(command->oled_commands, commands + offset, (size_t) length);
+    output_publish();
+  }
+
+  return true;
+}
+
+bool output_post_oled_buffer(const uint8_t* buffer, int length) {
+  if (!output_is_running()) {
+    return false;
+  }
+
+  if (length < 0 || (uint) length > ssd1306_buffer_length) {
+    fprintf(stderr, "OLED buffer of %i bytes does not fit an output command.\n", length);
+    exit(EXIT_FAILURE);
+  }
+
+  OutputCommand* command = output_reserve(OUTPUT_OLED_BUFFER, (uint16_t) length);
+  memcpy(command->oled_buffer, buffer, (size_t) length);
+  LATENCY_TAKE(&command->latency, LATENCY_MARK_OLED);
+  LATENCY_TAKE(&command->latency, LATENCY_MARK_INPUT);
+  output_publish();
+
+  return true;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "../inc/random.h"
+
+// ===========================================================================
+// RANDOM
+// Gerador de números pseudo aleatórios com semente explícita (PCG32). Cada
+// jogo tem seu próprio gerador (dentro do canvas), então a mesma semente
+// sempre produz a mesma sequência de comidas. O gerador padrão, usado por
+// randint, recebe no boot uma semente tirada do ruído do ADC.
+// ===========================================================================
+
+#define PCG_MULTIPLIER 6364136223846793005ull
+
+// amostras do sensor de temperatura usadas para juntar entropia no boot
+#define ENTROPY_SAMPLES 128
+#define TEMPERATURE_SENSOR_INPUT 4
+
+// gerador padrão, começa numa semente fixa até que alguém o semeie
+static Random default_random = { 0x853c49e6748fea9bull, 0xda3e39cb94b95bdbull };
+
+// embaralha os bits de um inteiro de 64 bits (finalizador do splitmix64),
+// usado para derivar a sequência a partir da semente e para misturar entropia
+static uint64_t mix64(uint64_t value) {
+  value += 0x9e3779b97f4a7c15ull;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+// semeia o gerador, a semente define tanto o estado inicial quanto a sequência
+void random_seed(Random* random, uint64_t seed) {
+  random->state = 0;
+  random->increment = (mix64(seed) << 1) | 1;
+  random_next(random);
+  random->state += seed;
+  random_next(random);
+}
+
+// próximo número de 32 bits da sequência
+uint32_t random_next(Random* random) {
+  uint64_t state = random->state;
+  random->state = state * PCG_MULTIPLIER + random->increment;
+
+  uint32_t xorshifted = (uint32_t) (((state >> 18) ^ state) >> 27);
+  uint32_t rotation = (uint32_t) (state >> 59);
+
+  return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+}
+
+// próximo número de 64 bits da sequência
+uint64_t random_next64(Random* random) {
+  uint64_t high = random_next(random);
+  return (high << 32) | random_next(random);
+}
+
+// número no intervalo [0, bound) sem viés, pelo método de multiplicação de
+// Lemire: o resto só é rejeitado nos raros casos em que cairia na parte que
+// tornaria alguns valores mais prováveis
+uint32_t random_bounded(Random* random, uint32_t bound) {
+  uint64_t product = (uint64_t) random_next(random) * bound;
+  uint32_t low = (uint32_t) product;
+
+  if (low < bound) {
+    uint32_t threshold = -bound % bound;
+
+    while (low < threshold) {
+      product = (uint64_t) random_next(random) * bound;
+      low = (uint32_t) product;
+    }
+  }
+
+  return (uint32_t) (product >> 32);
+}
+
+// número no intervalo inclusivo [min, max]
+int random_range(Random* random, int min, int max) {
+  if (min > max) {
+    fprintf(stderr, "random_range called with min (%i) greater than max (%i).\n", min, max);
+    exit(EXIT_FAILURE);
+  }
+
+  return min + (int) random_bounded(random, (uint32_t) (max - min) + 1);
+}
+
+// gerador padrão, para quem não tem um gerador próprio
+Random* random_default() {
+  return &default_random;
+}
+
+// junta entropia do hardware para a semente de boot: o bit menos
+// significativo das leituras do sensor de temperatura (ruído do ADC) e o
+// tempo desde o boot. Deve ser chamado depois de adc_init.
+uint64_t random_entropy_seed() {
+  uint64_t seed = time_us_64();
+
+  adc_set_temp_sensor_enabled(true);
+  adc_select_input(TEMPERATURE_SENSOR_INPUT);
+
+  for (int i = 0; i < ENTROPY_SAMPLES; i++) {
+    seed = mix64(seed ^ (adc_read() & 1) ^ ((uint64_t) i << 32));
+  }
+
+  adc_set_temp_sensor_enabled(false);
+
+  return mix64(seed ^ time_us_64());
+}
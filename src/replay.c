@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "../inc/constants.h"
+#include "../inc/canvas.h"
+#include "../inc/replay.h"
+
+// =============================================================
+// REPLAY
+// Gravação das entradas de um jogo num formato binário compacto, e
+// reprodução dessas entradas na mesma simulação. Como o jogo é determinístico
+// a partir da semente, basta guardar a semente e as mudanças de direção e
+// botões, cada uma marcada com o tick em que aconteceu (como diferença para o
+// evento anterior, que quase sempre cabe num byte). O gravador escreve num
+// buffer fixo e pequeno e o entrega a um destino quando ele enche, então
+// gravar um evento nunca custa mais que alguns bytes copiados.
+// =============================================================
+
+#define REPLAY_CODE_BITS 3
+
+static void write_byte(ReplayWriter* writer, uint8_t byte) {
+  writer->buffer[writer->length++] = byte;
+  writer->written++;
+}
+
+static void write_varint(ReplayWriter* writer, uint64_t value) {
+  while (value >= 0x80) {
+    write_byte(writer, (uint8_t) (value | 0x80));
+    value >>= 7;
+  }
+
+  write_byte(writer, (uint8_t) value);
+}
+
+static void write_event(ReplayWriter* writer, unsigned long tick, int code) {
+  if (writer->length + REPLAY_MAX_EVENT_SIZE > REPLAY_BUFFER_SIZE) {
+    replay_writer_flush(writer);
+  }
+
+  unsigned long delta = tick >= writer->last_tick ? tick - writer->last_tick : 0;
+  writer->last_tick = tick;
+  write_varint(writer, ((uint64_t) delta << REPLAY_CODE_BITS) | (uint64_t) code);
+}
+
+// começa uma gravação, o cabeçalho fica no buffer até o primeiro flush
+void replay_writer_init(ReplayWriter* writer, int rows, int cols, uint64_t seed, ReplaySink sink, void* sink_context) {
+  if (rows < 1 || cols < 1 || rows > REPLAY_MAX_SIDE || cols > REPLAY_MAX_SIDE) {
+    fprintf(stderr, "A %ix%i board does not fit a replay header.\n", rows, cols);
+    exit(EXIT_FAILURE);
+  }
+
+  writer->length = 0;
+  writer->last_tick = 0;
+  writer->written = 0;
+  writer->sink = sink;
+  writer->sink_context = sink_context;
+
+  for (int i = 0; i < 4; i++) {
+    write_byte(writer, (uint8_t) REPLAY_MAGIC[i]);
+  }
+
+  write_byte(writer, REPLAY_VERSION);
+  write_byte(writer, CANVAS_BACKEND_ID);
+  write_byte(writer, (uint8_t) rows);
+  write_byte(writer, (uint8_t) (rows >> 8));
+  write_byte(writer, (uint8_t) cols);
+  write_byte(writer, (uint8_t) (cols >> 8));
+
+  for (int i = 0; i < 8; i++) {
+    write_byte(writer, (uint8_t) (seed >> (8 * i)));
+  }
+}
+
+// grava que a cobra passou a ir na direção dada no tick dado
+void replay_record_direction(ReplayWriter* writer, unsigned long tick, Direction direction) {
+  write_event(writer, tick, direction - DIRECTION_NORTH);
+}
+
+// grava que o botão dado (BUTTON_A ou BUTTON_B) interrompeu o jogo no tick dado
+void replay_record_button(ReplayWriter* writer, unsigned long tick, int button) {
+  write_event(writer, tick, button == BUTTON_A ? REPLAY_CODE_BUTTON_A : REPLAY_CODE_BUTTON_B);
+}
+
+// encerra a gravação no tick dado e entrega o que resta no buffer
+void replay_writer_finish(ReplayWriter* writer, unsigned long tick) {
+  write_event(writer, tick, REPLAY_CODE_END);
+  replay_writer_flush(writer);
+}
+
+// entrega o conteúdo do buffer ao destino e o esvazia
+void replay_writer_flush(ReplayWriter* writer) {
+  if (writer->length > 0 && writer->sink != NULL) {
+    writer->sink(writer->buffer, writer->length, writer->sink_context);
+  }
+
+  writer->length = 0;
+}
+
+// destino que escreve cada bloco como uma linha em hexadecimal na saída padrão
+// (a serial USB no dispositivo), de onde tools/replay.c sabe lê-los. A linha
+// é montada inteira e escrita de uma vez. A escrita pode esperar a serial:
+// no jogo, o bloco passa antes pela caixa de saída
+void replay_stdio_sink(const uint8_t* data, size_t length, void* context) {
+  static const char digits[] = "0123456789abcdef";
+  char line[sizeof(REPLAY_STDIO_PREFIX) + 2 * REPLAY_BUFFER_SIZE + 1];
+  size_t offset = sizeof(REPLAY_STDIO_PREFIX) - 1;
+
+  (void) context;
+
+  if (length > REPLAY_BUFFER_SIZE) {
+    fprintf(stderr, "Replay blocks are limited to %i bytes.\n", REPLAY_BUFFER_SIZE);
+    exit(EXIT_FAILURE);
+  }
+
+  memcpy(line, REPLAY_STDIO_PREFIX, offset);
+
+  for (size_t i = 0; i < length; i++) {
+    line[offset++] = digits[data[i] >> 4];
+    line[offset++] = digits[data[i] & 15];
+  }
+
+  line[offset++] = '\n';
+  fwrite(line, 1, offset, stdout);
+}
+
+// =============================================================
+// CAIXA DE SAÍDA
+// Destino para gravar dentro do tick: replay_outbox_sink só copia o bloco
+// para uma fila fixa, e o loop do jogo o escreve na serial com
+// replay_outbox_drain enquanto espera o próximo tick. Se a serial não
+// esvaziar a fila a tempo, o bloco que não cabe é descartado e, como o resto
+// da gravação não faria sentido sem ele, os seguintes também; a gravação sai
+// cortada e dropped conta os blocos perdidos.
+// =============================================================
+
+void replay_outbox_init(ReplayOutbox* outbox) {
+  outbox->head = 0;
+  outbox->tail = 0;
+  outbox->dropped = 0;
+}
+
+// destino do gravador, com context apontando a caixa
+void replay_outbox_sink(const uint8_t* data, size_t length, void* context) {
+  ReplayOutbox* outbox = context;
+
+  if (outbox->dropped > 0 || outbox->tail - outbox->head == REPLAY_OUTBOX_BLOCKS || length > REPLAY_BUFFER_SIZE) {
+    outbox->dropped++;
+    return;
+  }
+
+  uint32_t slot = outbox->tail % REPLAY_OUTBOX_BLOCKS;
+  memcpy(outbox->blocks[slot], data, length);
+  outbox->lengths[slot] = (uint8_t) length;
+  outbox->tail++;
+}
+
+// escreve o bloco mais antigo na serial; retorna false com a caixa vazia
+bool replay_outbox_drain(ReplayOutbox* outbox) {
+  if (outbox->head == outbox->tail) {
+    return false;
+  }
+
+  uint32_t slot = outbox->head % REPLAY_OUTBOX_BLOCKS;
+  replay_stdio_sink(outbox->blocks[slot], outbox->lengths[slot], NULL);
+  outbox->head++;
+
+  return true;
+}
+
+// escreve tudo o que resta, fora do jogo, e avisa se blocos foram perdidos
+// (numa linha que tools/replay.c ignora)
+void replay_outbox_flush(ReplayOutbox* outbox) {
+  while (outbox->head != outbox->tail) {
+    replay_outbox_drain(outbox);
+  }
+
+  if (outbox->dropped > 0) {
+    printf("replay dropped %lu blocks, the recording is cut\n", outbox->dropped);
+  }
+}
+
+// lê o cabeçalho de uma gravação, retorna false se ele não for válido
+bool replay_reader_init(ReplayReader* reader, const uint8_t* data, size_t length) {
+  reader->data = data;
+  reader->length = length;
+  reader->offset = REPLAY_HEADER_SIZE;
+  reader->tick = 0;
+  reader->ended = false;
+
+  if (length < REPLAY_HEADER_SIZE || memcmp(data, REPLAY_MAGIC, 4) != 0 || data[4] != REPLAY_VERSION) {
+    return false;
+  }
+
+  reader->backend = data[5];
+  reader->rows = data[6] | data[7] << 8;
+  reader->cols = data[8] | data[9] << 8;
+  reader->seed = 0;
+
+  for (int i = 0; i < 8; i++) {
+    reader->seed |= (uint64_t) data[10 + i] << (8 * i);
+  }
+
+  return reader->rows > 0 && reader->cols > 0;
+}
+
+// lê o próximo evento, retorna false no fim da gravação (reader->ended diz se
+// ela terminou com REPLAY_CODE_END ou foi cortada)
+bool replay_reader_next(ReplayReader* reader, ReplayEvent* event) {
+  if (reader->ended) {
+    return false;
+  }
+
+  uint64_t value = 0;
+  int shift = 0;
+
+  while (true) {
+    if (reader->offset >= reader->length || shift >= 64) {
+      return false;
+    }
+
+    uint8_t byte = reader->data[reader->offset++];
+    value |= (uint64_t) (byte & 0x7f) << shift;
+    shift += 7;
+
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+
+  reader->tick += (unsigned long) (value >> REPLAY_CODE_BITS);
+  event->tick = reader->tick;
+  event->code = (int) (value & ((1 << REPLAY_CODE_BITS) - 1));
+
+  if (event->code == REPLAY_CODE_END) {
+    reader->ended = true;
+  }
+
+  return true;
+}
+
+Direction replay_code_to_direction(int code) {
+  return code <= REPLAY_CODE_WEST ? DIRECTION_NORTH + code : DIRECTION_NONE;
+}
+
+// reproduz uma gravação, chamando on_tick (se houver) depois de cada passo e
+// esperando tick_ms entre os passos (0 reproduz o mais rápido possível)
+ReplayResult replay_play(const uint8_t* data, size_t length, uint32_t tick_ms, ReplayTickCallback on_tick, void* context) {
+  ReplayResult result = { .valid = false, .button = -1 };
+  ReplayReader reader;
+
+  if (!replay_reader_init(&reader, data, length)) {
+    return result;
+  }
+
+  if (reader.backend != CANVAS_BACKEND_ID) {
+    result.wrong_backend = true;
+    return result;
+  }
+
+  GameState* state = game_state_init(reader.rows, reader.cols, reader.seed);
+  ReplayEvent event;
+  bool has_event = replay_reader_next(&reader, &event);
+  bool stopped = false;
+
+  while (!state->over && has_event && !stopped) {
+    Direction direction = state->snake->direction;
+
+    // aplica os eventos deste tick, na ordem em que foram gravados
+    while (has_event && event.tick <= state->ticks) {
+      if (event.code <= REPLAY_CODE_WEST) {
+        direction = replay_code_to_direction(event.code);
+      } else if (event.code == REPLAY_CODE_BUTTON_A || event.code == REPLAY_CODE_BUTTON_B) {
+        result.button = event.code == REPLAY_CODE_BUTTON_A ? BUTTON_A : BUTTON_B;
+        stopped = true;
+      } else if (event.code == REPLAY_CODE_END) {
+        stopped = true;
+      }
+
+      has_event = !stopped && replay_reader_next(&reader, &event);
+    }
+
+    if (stopped || !has_event) {
+      break;
+    }
+
+    GameEvents events = game_step(state, (GameInput) { .direction = direction });
+
+    if (on_tick != NULL) {
+      on_tick(state, events, context);
+    }
+
+    if (tick_ms > 0) {
+      sleep_ms(tick_ms);
+    }
+  }
+
+  // o jogo acabou ou a gravação terminou com um botão ou com o marcador de
+  // fim; uma gravação cortada no meio não é válida
+  result.valid = state->over || stopped;
+  result.ticks = state->ticks;
+  result.snake_size = state->snake->size;
+  result.won = state->won;
+  result.lost = state->over && !state->won;
+
+  game_state_free(state);
+
+  return result;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "../inc/scheduler.h"
+
+// =============================================================
+// SCHEDULER
+// Marca as fronteiras dos ticks do jogo com um alarme repetitivo do timer de
+// hardware (add_repeating_timer_us com intervalo negativo, que conta cada
+// intervalo a partir do disparo anterior). O tempo gasto renderizando e
+// tocando sons entre um tick e outro não se soma ao intervalo, e o loop pode
+// ler as entradas o tempo todo enquanto espera, perguntando com
+// tick_scheduler_take se a fronteira já passou.
+//
+// Se o loop demorar mais de um intervalo (uma melodia tocada até o fim, por
+// exemplo), os ticks acumulados viram um só e os demais são contados em
+// missed, em vez de a cobra andar várias células de uma vez.
+// =============================================================
+
+static bool tick_scheduler_alarm(repeating_timer_t* timer) {
+  TickScheduler* scheduler = timer->user_data;
+  uint64_t now = time_us_64();
+  uint64_t expected = scheduler->expected_us;
+
+  if (now > expected && now - expected > scheduler->max_jitter_us) {
+    scheduler->max_jitter_us = (uint32_t) (now - expected);
+  }
+
+  scheduler->fired_us = now;
+  scheduler->fired++;
+
+  // acorda o loop, se ele estiver esperando em __wfe
+  __sev();
+
+  // o alarme atual já estava armado com o intervalo anterior; uma mudança de
+  // intervalo vale a partir do próximo
+  timer->delay_us = -(int64_t) scheduler->interval_us;
+  scheduler->expected_us = expected + scheduler->interval_us;
+
+  return scheduler->running;
+}
+
+// começa a marcar ticks a cada interval_us, o primeiro daqui a interval_us
+void tick_scheduler_start(TickScheduler* scheduler, uint32_t interval_us) {
+  scheduler->fired = 0;
+  scheduler->consumed = 0;
+  scheduler->interval_us = interval_us;
+  scheduler->max_jitter_us = 0;
+  scheduler->missed = 0;
+  scheduler->running = true;
+  scheduler->expected_us = time_us_64() + interval_us;
+  scheduler->fired_us = 0;
+
+  if (!add_repeating_timer_us(-(int64_t) interval_us, tick_scheduler_alarm, scheduler, &scheduler->timer)) {
+    fprintf(stderr, "No alarm slots available for the tick scheduler.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+void tick_scheduler_stop(TickScheduler* scheduler) {
+  if (scheduler->running) {
+    scheduler->running = false;
+    cancel_repeating_timer(&scheduler->timer);
+  }
+}
+
+// recomeça a contagem a partir de agora, depois de um tick adiantado pelo
+// loop, para que o próximo venha um intervalo inteiro depois dele
+void tick_scheduler_restart(TickScheduler* scheduler) {
+  uint32_t max_jitter_us = scheduler->max_jitter_us;
+  uint32_t missed = scheduler->missed;
+
+  tick_scheduler_stop(scheduler);
+  tick_scheduler_start(scheduler, scheduler->interval_us);
+
+  scheduler->max_jitter_us = max_jitter_us;
+  scheduler->missed = missed;
+}
+
+void tick_scheduler_set_interval(TickScheduler* scheduler, uint32_t interval_us) {
+  scheduler->interval_us = interval_us;
+}
+
+// diz se uma fronteira de tick passou desde a última chamada que retornou
+// true; as fronteiras excedentes são descartadas e contadas em missed
+bool tick_scheduler_take(TickScheduler* scheduler) {
+  uint32_t fired = scheduler->fired;
+
+  if (fired == scheduler->consumed) {
+    return false;
+  }
+
+  scheduler->missed += fired - scheduler->consumed - 1;
+  scheduler->consumed = fired;
+
+  return true;
+}
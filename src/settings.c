@@ -3,14 +3,17 @@
 static bool initialized = false;
 
 static GameSettings default_settings = {
-    .sound = (GameSettingsSound) {
-        (GameSettingsSoundEffects) {
+    .sound = {
+        .sound_effects = {
             .mute = false,
         },
-        (GameSettingsSoundMusic) {
+        .music = {
             .mute = false,
         },
     },
+    .autopilot = {
+        .enabled = false,
+    },
 };
 
 GameSettings settings;
@@ -12,12 +12,26 @@
 // Representação da cobra, contém várias funções análogas as de ./food.c.
 // "node" neste arquivo significa uma parte da cobrinha, podendo ser a cabeça
 // ou uma parte do corpo.
+// As posições dos nodes ficam num buffer circular alocado uma única vez, com
+// espaço para o canvas inteiro. Mover a cobra só escreve a nova cabeça e apaga
+// a cauda antiga, e crescer só deixa de apagar a cauda, então ambos são O(1).
 // =================================================================================
 
+// índice no buffer circular do node na posição node_index (0 é a cabeça)
+static int snake_node_slot(Snake* snake, int node_index) {
+  int slot = snake->head - node_index;
+  return slot < 0 ? slot + snake->capacity : slot;
+}
+
+// pega a posição de um node
+void snake_get_node_position(Snake* snake, int node_index, Position node_position) {
+  copy_position(snake->node_positions[snake_node_slot(snake, node_index)], node_position);
+}
+
 // remove a cobra do canvas
 void snake_remove(Snake* snake, Canvas* canvas) {
   for (int i = 0; i < snake->size; i++) {
-    Position *node_position = &snake->node_positions[i];
+    Position *node_position = &snake->node_positions[snake_node_slot(snake, i)];
     CanvasCell cell = canvas_get(canvas, *node_position);
 
     if (cell == CELL_SNAKE_BODY || cell == CELL_SNAKE_HEAD) {
@@ -41,17 +55,12 @@ static void snake_put(Snake* snake, Canvas* canvas) {
   // as, for example, a way to implement an easier game mode).
   for (int i = snake->size - 1; i >= 0; i--) {
     CanvasCell cell = snake_node_is_head(snake, i) ? CELL_SNAKE_HEAD : CELL_SNAKE_BODY;
-    canvas_put(canvas, cell, snake->node_positions[i]);
+    canvas_put(canvas, cell, snake->node_positions[snake_node_slot(snake, i)]);
   }
 
   snake->in_canvas = true;
 }
 
-// pega a posição do node anterior a outro node
-static void snake_get_previous_node_position(Snake* snake, int node_index, Position previous_node_position) {
-  copy_position(snake->node_positions[node_index - 1], previous_node_position);
-}
-
 // pega uma posição relativa à posição de outro node, usando uma direção como
 // referência, e coloca a posição no array relative_position.
 // Por exemplo: se node_position é (1, 1) e direction é DIRECTION_NORTH, a
@@ -73,71 +82,20 @@ static void get_relative_position(Canvas* canvas, Position node_position, Direct
   copy_position((int [2]){ row, col }, relative_position);
 }
 
-// pega a direção de um node
-static Direction get_node_direction(Snake* snake, int node_index) {
-  Position node_position;
-  copy_position(snake->node_positions[node_index], node_position);
-
-  if (snake_node_is_head(snake, node_index)) {
-    return snake->direction;
-  } else {
-    Position previous_node_position;
-    snake_get_previous_node_position(snake, node_index, previous_node_position);
-
-    if (previous_node_position[0] < node_position[0]) {
-      return DIRECTION_NORTH;
-    } else if (previous_node_position[0] > node_position[0]) {
-      return DIRECTION_SOUTH;
-    } else if (previous_node_position[1] < node_position[1]) {
-      return DIRECTION_WEST;
-    } else if (previous_node_position[1] > node_position[1]) {
-      return DIRECTION_EAST;
-    } else {
-      fprintf(stderr, "Function get_node_direction() found overlapping nodes.\n");
-      exit(EXIT_FAILURE);
-    }
-  }
-};
-
 // pega a posição da cabeça da cobra
 void snake_get_head_position(Snake* snake, Position head_position) {
-  copy_position(snake->node_positions[0], head_position);
+  copy_position(snake->node_positions[snake->head], head_position);
 }
 
-// pega a posição em que será inserido um novo node, assume-se que pelo a
-// cabeça da cobra já exista.
-void snake_get_new_node_position(Snake* snake, Canvas* canvas, Position node_position) {
-  Direction last_node_direction = get_node_direction(snake, snake->size - 1);
-  get_relative_position(
-    canvas,
-    snake->node_positions[snake->size - 1],
-    get_opposite_direction(last_node_direction),
-    node_position
-  );
-}
-
-// faz a cobra crescer
+// faz a cobra crescer: o próximo movimento mantém a cauda no lugar, então o
+// novo node aparece onde a cauda estava
 void snake_grow(Snake *snake, Canvas* canvas) {
-  snake_remove(snake, canvas);
-
-  Position new_node_position;
-  snake_get_new_node_position(snake, canvas, new_node_position);
-
-  snake->size++;
-  snake->node_positions = realloc(snake->node_positions, (snake->size) * sizeof(Position));
-
-  if (snake->node_positions == NULL) {
-    memory_allocation_error();
+  if (snake->size + snake->pending_growth >= snake->capacity) {
+    fprintf(stderr, "Function snake_grow() called but the snake already fills the canvas.\n");
+    exit(EXIT_FAILURE);
   }
 
-  copy_position(new_node_position, snake->node_positions[snake->size - 1]);
-
-  snake_put(snake, canvas);
-}
-
-// pega a posição inicial da cobra
-static void snake_get_initial_position(Canvas* canvas, Position position) {
-  return canvas_get_random_free_position(canvas, position);
+  snake->pending_growth++;
 }
 
 // libera a memória alocada para a cobra
@@ -153,49 +111,80 @@ void snake_free(Snake* snake) {
 // pega a posição do próximo node
 void get_next_node_position(Snake* snake, Canvas* canvas, int node_index, Position next_node_position) {
   if (snake_node_is_head(snake, node_index)) {
-    Direction direction = get_node_direction(snake, node_index);
-    get_relative_position(canvas, snake->node_positions[node_index], direction, next_node_position);
+    get_relative_position(canvas, snake->node_positions[snake->head], snake->direction, next_node_position);
   } else {
-    copy_position(snake->node_positions[node_index - 1], next_node_position);
+    snake_get_node_position(snake, node_index - 1, next_node_position);
   }
 }
 
-// move um node na direção que a cobra está indo
-static void snake_move_node(Snake* snake, Canvas* canvas, int node_index) {
-  get_next_node_position(snake, canvas, node_index, snake->node_positions[node_index]);
-}
-
-// move a cobra inteira
-void snake_move(Snake* snake, Canvas* canvas) {
-  snake_remove(snake, canvas);
+// checa se a cobra colide com uma posição específica, consultando a ocupação
+// do canvas em vez de percorrer os nodes. A cauda só conta como colisão se a
+// cobra estiver crescendo, já que no movimento normal ela sai da célula no
+// mesmo passo em que a cabeça entra.
+static bool snake_collides(Snake* snake, Canvas* canvas, Position position) {
+  CanvasCell cell = canvas_get(canvas, position);
 
-  for (int i = snake->size - 1; i >= 0; i--) {
-    snake_move_node(snake, canvas, i);
+  if (cell != CELL_SNAKE_BODY && cell != CELL_SNAKE_HEAD) {
+    return false;
   }
 
-  snake_put(snake, canvas);
-}
+  if (snake->pending_growth == 0) {
+    Position tail_position;
+    snake_get_node_position(snake, snake->size - 1, tail_position);
 
-// checa se a cobra colide com uma posição específica
-static bool snake_collides(Snake* snake, Position position) {
-  for (int i = 0; i < snake->size; i++) {
-    if (positions_collide(position, snake->node_positions[i])) {
-      return true;
+    if (positions_collide(position, tail_position)) {
+      return false;
     }
   }
 
-  return false;
+  return true;
 }
 
-// checa se a cobra colide consigo mesma
-bool snake_self_collides(Snake* snake) {
-  for (int i = 1; i < snake->size; i++) {
-    if (positions_collide(snake->node_positions[0], snake->node_positions[i])) {
-      return true;
+// checa se o próximo movimento vai levar a cabeça para o próprio corpo, antes
+// que ele seja aplicado
+bool snake_next_move_collides(Snake* snake, Canvas* canvas) {
+  Position next_head_position;
+  get_next_node_position(snake, canvas, 0, next_head_position);
+  return snake_collides(snake, canvas, next_head_position);
+}
+
+// move a cobra inteira. Só a cauda (a menos que a cobra esteja crescendo), a
+// cabeça antiga e a cabeça nova mudam no canvas.
+void snake_move(Snake* snake, Canvas* canvas) {
+  Position next_head_position;
+  get_next_node_position(snake, canvas, 0, next_head_position);
+
+  snake->self_collided = snake_collides(snake, canvas, next_head_position);
+
+  if (snake->pending_growth > 0) {
+    snake->pending_growth--;
+    snake->size++;
+  } else {
+    Position* tail_position = &snake->node_positions[snake_node_slot(snake, snake->size - 1)];
+    CanvasCell cell = canvas_get(canvas, *tail_position);
+
+    if (cell == CELL_SNAKE_BODY || cell == CELL_SNAKE_HEAD) {
+      canvas_put(canvas, CELL_UNUSED, *tail_position);
     }
   }
 
-  return false;
+  // a cabeça antiga vira corpo, a menos que ela fosse também a cauda que
+  // acabou de sair
+  if (snake->size > 1) {
+    canvas_put(canvas, CELL_SNAKE_BODY, snake->node_positions[snake->head]);
+  }
+
+  snake->head = snake->head + 1 == snake->capacity ? 0 : snake->head + 1;
+  copy_position(next_head_position, snake->node_positions[snake->head]);
+  canvas_put(canvas, CELL_SNAKE_HEAD, next_head_position);
+
+  snake->in_canvas = true;
+}
+
+// checa se a cobra colidiu consigo mesma no último movimento (a checagem é
+// feita por snake_move, antes de aplicar o movimento)
+bool snake_self_collides(Snake* snake) {
+  return snake->self_collided;
 }
 
 // inicia a cobra
@@ -215,18 +204,27 @@ Snake* snake_init(Canvas* canvas, Position position, Direction direction, int in
     memory_allocation_error();
   }
 
-  snake->size = 1;
-  snake->node_positions = malloc(snake->size * sizeof(Position));
+  snake->capacity = canvas->rows * canvas->cols;
+  snake->node_positions = malloc(snake->capacity * sizeof(Position));
 
   if (snake->node_positions == NULL) {
     memory_allocation_error();
   }
 
-  copy_position(position, snake->node_positions[0]);
   snake->direction = direction;
-
-  while (snake->size < initial_size) {
-    snake_grow(snake, canvas);
+  snake->size = initial_size;
+  snake->pending_growth = 0;
+  snake->self_collided = false;
+  snake->head = initial_size - 1;
+
+  // o corpo inicial se estende em linha reta atrás da cabeça, no sentido
+  // oposto ao da direção da cobra
+  Direction backwards = get_opposite_direction(direction);
+  copy_position(position, snake->node_positions[snake->head]);
+
+  for (int i = 1; i < initial_size; i++) {
+    Position* previous_position = &snake->node_positions[snake_node_slot(snake, i - 1)];
+    get_relative_position(canvas, *previous_position, backwards, snake->node_positions[snake_node_slot(snake, i)]);
   }
 
   snake_put(snake, canvas);
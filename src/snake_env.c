@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "../inc/utils.h"
+#include "../inc/random.h"
+#include "../inc/snake_env.h"
+
+// =============================================================
+// SNAKE ENV
+// As regras de game_step (cobra, comida e canvas) reescritas para avançar
+// muitos jogos de uma vez, como um ambiente vetorizado de aprendizado por
+// reforço. Cada campo do estado fica num array próprio indexado pelo
+// ambiente (structure of arrays): o corpo é um buffer circular de índices de
+// células, a ocupação é um bitboard e a comida é o índice de uma célula.
+//
+// Os sorteios seguem a ordem do backend bitboard do canvas (a k-ésima célula
+// livre em ordem de linha), então um ambiente com a semente s joga o mesmo
+// jogo que game_state_init(rows, cols, s) com CANVAS_BACKEND=bitboard.
+//
+// Um ambiente cujo episódio termina é recomeçado no mesmo passo, com a
+// semente anterior mais o número de ambientes, e a observação seguinte já é a
+// do novo episódio.
+// =============================================================
+
+#define NO_CELL 0xffff
+#define DIRECTIONS 4
+#define DIRECTION_EAST_INDEX 1
+#define DIRECTION_WEST_INDEX 3
+
+struct SnakeEnv {
+  int count;
+  int rows;
+  int cols;
+  int cells;
+  int words;
+  uint64_t padding_mask;
+  uint32_t max_ticks;
+  // vizinho de cada célula em cada direção, com a volta pelas bordas
+  uint16_t (*neighbors)[DIRECTIONS];
+
+  // um elemento por ambiente
+  Random* random;
+  uint64_t* seed;
+  uint16_t* head;
+  uint16_t* length;
+  uint16_t* growth;
+  uint16_t* food;
+  uint8_t* direction;
+  uint32_t* ticks;
+
+  // cells elementos por ambiente (índices de células, buffer circular)
+  uint16_t* body;
+  // words palavras por ambiente, com os bits de preenchimento sempre ligados
+  uint64_t* occupied;
+};
+
+static void* allocate(size_t size) {
+  void* pointer = malloc(size);
+
+  if (pointer == NULL) {
+    memory_allocation_error();
+  }
+
+  return pointer;
+}
+
+static inline bool bit_get(const uint64_t* words, int bit) {
+  return (words[bit >> 6] >> (bit & 63)) & 1;
+}
+
+static inline void bit_set(uint64_t* words, int bit) {
+  words[bit >> 6] |= 1ull << (bit & 63);
+}
+
+static inline void bit_clear(uint64_t* words, int bit) {
+  words[bit >> 6] &= ~(1ull << (bit & 63));
+}
+
+// índice do k-ésimo bit ligado de word
+static inline int select_bit(uint64_t word, int k) {
+  for (; k > 0; k--) {
+    word &= word - 1;
+  }
+
+  return __builtin_ctzll(word);
+}
+
+// k-ésima célula livre, em ordem de linha
+static int select_free_cell(const SnakeEnv* env, const uint64_t* occupied, int k) {
+  for (int w = 0; w < env->words; w++) {
+    uint64_t free = ~occupied[w];
+    int count = __builtin_popcountll(free);
+
+    if (k < count) {
+      return w * 64 + select_bit(free, k);
+    }
+
+    k -= count;
+  }
+
+  return NO_CELL;
+}
+
+static void place_food(SnakeEnv* env, int index) {
+  int free = env->cells - env->length[index];
+
+  if (free <= 0) {
+    env->food[index] = NO_CELL;
+    return;
+  }
+
+  int k = (int) random_bounded(&env->random[index], (uint32_t) free);
+  env->food[index] = (uint16_t) select_free_cell(env, env->occupied + (size_t) index * env->words, k);
+}
+
+// começa um episódio: a cobra de tamanho 2 indo para leste, com a cabeça numa
+// célula sorteada, e depois a comida, como em game_state_init
+static void reset_one(SnakeEnv* env, int index, uint64_t seed) {
+  uint64_t* occupied = env->occupied + (size_t) index * env->words;
+  uint16_t* body = env->body + (size_t) index * env->cells;
+
+  random_seed(&env->random[index], seed);
+  env->seed[index] = seed;
+
+  memset(occupied, 0, sizeof(uint64_t) * env->words);
+  occupied[env->words - 1] |= env->padding_mask;
+
+  int head = (int) random_bounded(&env->random[index], (uint32_t) env->cells);
+  int tail = env->neighbors[head][DIRECTION_WEST_INDEX];
+
+  body[0] = (uint16_t) tail;
+  body[1] = (uint16_t) head;
+  bit_set(occupied, tail);
+  bit_set(occupied, head);
+
+  env->head[index] = 1;
+  env->length[index] = 2;
+  env->growth[index] = 0;
+  env->direction[index] = DIRECTION_EAST_INDEX;
+  env->ticks[index] = 0;
+
+  place_food(env, index);
+}
+
+SnakeEnv* snake_env_create(int count, int rows, int cols) {
+  if (count < 1 || rows < 1 || cols < 2 || rows * cols < 3 || rows * cols >= NO_CELL) {
+    fprintf(stderr, "Invalid snake env: %i environments of %ix%i.\n", count, rows, cols);
+    exit(EXIT_FAILURE);
+  }
+
+  SnakeEnv* env = allocate(sizeof(SnakeEnv));
+  int cells = rows * cols;
+  int words = (cells + 63) / 64;
+
+  env->count = count;
+  env->rows = rows;
+  env->cols = cols;
+  env->cells = cells;
+  env->words = words;
+  env->padding_mask = cells % 64 == 0 ? 0 : ~0ull << (cells % 64);
+  env->max_ticks = 0;
+
+  env->neighbors = allocate(sizeof(uint16_t[DIRECTIONS]) * cells);
+  env->random = allocate(sizeof(Random) * count);
+  env->seed = allocate(sizeof(uint64_t) * count);
+  env->head = allocate(sizeof(uint16_t) * count);
+  env->length = allocate(sizeof(uint16_t) * count);
+  env->growth = allocate(sizeof(uint16_t) * count);
+  env->food = allocate(sizeof(uint16_t) * count);
+  env->direction = allocate(sizeof(uint8_t) * count);
+  env->ticks = allocate(sizeof(uint32_t) * count);
+  env->body = allocate(sizeof(uint16_t) * (size_t) count * cells);
+  env->occupied = allocate(sizeof(uint64_t) * (size_t) count * words);
+
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      uint16_t* neighbors = env->neighbors[row * cols + col];
+      neighbors[0] = wrap(row - 1, 0, rows - 1) * cols + col;
+      neighbors[1] = row * cols + wrap(col + 1, 0, cols - 1);
+      neighbors[2] = wrap(row + 1, 0, rows - 1) * cols + col;
+      neighbors[3] = row * cols + wrap(col - 1, 0, cols - 1);
+    }
+  }
+
+  snake_env_reset(env, 0);
+
+  return env;
+}
+
+void snake_env_destroy(SnakeEnv* env) {
+  if (env == NULL) {
+    return;
+  }
+
+  free(env->neighbors);
+  free(env->random);
+  free(env->seed);
+  free(env->head);
+  free(env->length);
+  free(env->growth);
+  free(env->food);
+  free(env->direction);
+  free(env->ticks);
+  free(env->body);
+  free(env->occupied);
+  free(env);
+}
+
+int snake_env_count(const SnakeEnv* env) {
+  return env->count;
+}
+
+int snake_env_plane_words(const SnakeEnv* env) {
+  return env->words;
+}
+
+// episódios que chegam a max_ticks terminam como SNAKE_ENV_TRUNCATED (0 não
+// limita)
+void snake_env_set_max_ticks(SnakeEnv* env, uint32_t max_ticks) {
+  env->max_ticks = max_ticks;
+}
+
+// recomeça todos os ambientes, o ambiente i com a semente seed + i
+void snake_env_reset(SnakeEnv* env, uint64_t seed) {
+  for (int i = 0; i < env->count; i++) {
+    reset_one(env, i, seed + (uint64_t) i);
+  }
+}
+
+// avança todos os ambientes um tick com as ações dadas (uma por ambiente) e
+// escreve a recompensa e o motivo do fim (SNAKE_ENV_*) de cada um
+void snake_env_step(SnakeEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones) {
+  int cells = env->cells;
+
+  for (int i = 0; i < env->count; i++) {
+    uint64_t* occupied = env->occupied + (size_t) i * env->words;
+    uint16_t* body = env->body + (size_t) i * cells;
+    int direction = env->direction[i];
+    int action = actions[i];
+
+    // a cobra não dá meia volta
+    if (action < DIRECTIONS && action != (direction ^ 2)) {
+      direction = action;
+      env->direction[i] = (uint8_t) direction;
+    }
+
+    int head_slot = env->head[i];
+    int length = env->length[i];
+    int next = env->neighbors[body[head_slot]][direction];
+    bool ate = next == env->food[i];
+
+    if (ate) {
+      env->growth[i]++;
+      env->food[i] = NO_CELL;
+    }
+
+    int tail_slot = head_slot - (length - 1);
+    tail_slot = tail_slot < 0 ? tail_slot + cells : tail_slot;
+    int tail = body[tail_slot];
+
+    // a cauda só conta como colisão se a cobra estiver crescendo
+    bool collided = bit_get(occupied, next) && !(env->growth[i] == 0 && next == tail);
+
+    if (env->growth[i] > 0) {
+      env->growth[i]--;
+      length++;
+    } else {
+      bit_clear(occupied, tail);
+    }
+
+    head_slot = head_slot + 1 == cells ? 0 : head_slot + 1;
+    body[head_slot] = (uint16_t) next;
+    bit_set(occupied, next);
+
+    env->head[i] = (uint16_t) head_slot;
+    env->length[i] = (uint16_t) length;
+    env->ticks[i]++;
+
+    float reward = 0;
+    uint8_t done = SNAKE_ENV_RUNNING;
+
+    if (ate) {
+      reward += SNAKE_ENV_REWARD_FOOD;
+      place_food(env, i);
+    }
+
+    if (collided) {
+      reward += SNAKE_ENV_REWARD_LOSS;
+      done = SNAKE_ENV_LOST;
+    } else if (length == cells && env->food[i] == NO_CELL) {
+      reward += SNAKE_ENV_REWARD_WIN;
+      done = SNAKE_ENV_WON;
+    } else if (env->max_ticks > 0 && env->ticks[i] >= env->max_ticks) {
+      done = SNAKE_ENV_TRUNCATED;
+    }
+
+    rewards[i] = reward;
+    dones[i] = done;
+
+    if (done != SNAKE_ENV_RUNNING) {
+      reset_one(env, i, env->seed[i] + (uint64_t) env->count);
+    }
+  }
+}
+
+// escreve as observações de todos os ambientes em planes: para cada ambiente,
+// SNAKE_ENV_PLANES planos seguidos de snake_env_plane_words palavras cada
+void snake_env_observe(const SnakeEnv* env, uint64_t* planes) {
+  int words = env->words;
+  size_t plane_size = sizeof(uint64_t) * words;
+
+  for (int i = 0; i < env->count; i++) {
+    uint64_t* body_plane = planes + ((size_t) i * SNAKE_ENV_PLANES + SNAKE_ENV_PLANE_BODY) * words;
+    uint64_t* head_plane = planes + ((size_t) i * SNAKE_ENV_PLANES + SNAKE_ENV_PLANE_HEAD) * words;
+    uint64_t* food_plane = planes + ((size_t) i * SNAKE_ENV_PLANES + SNAKE_ENV_PLANE_FOOD) * words;
+
+    memcpy(body_plane, env->occupied + (size_t) i * words, plane_size);
+    body_plane[words - 1] &= ~env->padding_mask;
+
+    memset(head_plane, 0, plane_size);
+    bit_set(head_plane, env->body[(size_t) i * env->cells + env->head[i]]);
+
+    memset(food_plane, 0, plane_size);
+
+    if (env->food[i] != NO_CELL) {
+      bit_set(food_plane, env->food[i]);
+    }
+  }
+}
+
+// tamanho atual da cobra em cada ambiente
+const uint16_t* snake_env_lengths(const SnakeEnv* env) {
+  return env->length;
+}
+
+// ticks do episódio atual em cada ambiente
+const uint32_t* snake_env_ticks(const SnakeEnv* env) {
+  return env->ticks;
+}
+
+// semente do episódio atual em cada ambiente
+const uint64_t* snake_env_seeds(const SnakeEnv* env) {
+  return env->seed;
+}
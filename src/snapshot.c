@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <string.h>
+#include "../inc/constants.h"
+#include "../inc/canvas.h"
+#include "../inc/snake.h"
+#include "../inc/food.h"
+#include "../inc/snapshot.h"
+
+// =============================================================
+// SNAPSHOT
+// Cópia plana do estado de um jogo: tamanho fixo, sem ponteiros e sem bytes
+// de preenchimento. Pode ser copiada com memcpy para clonar um jogo (bots que
+// testam jogadas, voltar no tempo) e gravada byte a byte num arquivo; os
+// inteiros ficam na ordem da máquina, little endian tanto no RP2040 quanto no
+// host. Além das células, o snapshot guarda o gerador e a ordem das células
+// livres do canvas, então o jogo restaurado sorteia as mesmas comidas que o
+// original.
+// =============================================================
+
+static uint16_t position_to_cell(Canvas* canvas, Position position) {
+  return (uint16_t) (position[0] * canvas->cols + position[1]);
+}
+
+static void cell_to_position(Canvas* canvas, int cell, Position position) {
+  position[0] = cell / canvas->cols;
+  position[1] = cell % canvas->cols;
+}
+
+// copia o estado do jogo para o snapshot; retorna false se o canvas não
+// couber num snapshot
+bool game_snapshot_save(GameState* state, GameSnapshot* snapshot) {
+  Canvas* canvas = state->canvas;
+  Snake* snake = state->snake;
+  Food* food = state->food;
+
+  if (canvas->rows * canvas->cols > SNAPSHOT_MAX_CELLS) {
+    return false;
+  }
+
+  // zera tudo, inclusive as sobras dos arrays, para que o mesmo estado gere
+  // sempre os mesmos bytes
+  memset(snapshot, 0, sizeof(GameSnapshot));
+
+  snapshot->magic = SNAPSHOT_MAGIC;
+  snapshot->version = SNAPSHOT_VERSION;
+  snapshot->rows = (uint8_t) canvas->rows;
+  snapshot->cols = (uint8_t) canvas->cols;
+  snapshot->seed = state->seed;
+  snapshot->random_state = canvas->random.state;
+  snapshot->random_increment = canvas->random.increment;
+  snapshot->ticks = (uint32_t) state->ticks;
+  snapshot->snake_size = (uint16_t) snake->size;
+  snapshot->snake_pending_growth = (uint16_t) snake->pending_growth;
+  snapshot->food_cell = position_to_cell(canvas, food->position);
+  snapshot->snake_direction = (uint8_t) snake->direction;
+  snapshot->flags = (state->over ? SNAPSHOT_FLAG_OVER : 0) |
+                    (state->won ? SNAPSHOT_FLAG_WON : 0) |
+                    (snake->self_collided ? SNAPSHOT_FLAG_SELF_COLLIDED : 0) |
+                    (food->in_canvas ? SNAPSHOT_FLAG_FOOD_IN_CANVAS : 0);
+
+  for (int i = 0; i < snake->size; i++) {
+    Position position;
+    snake_get_node_position(snake, i, position);
+    snapshot->body[i] = position_to_cell(canvas, position);
+  }
+
+  snapshot->free_count = (uint16_t) canvas_save(canvas, snapshot->cells, snapshot->free_order);
+
+  return true;
+}
+
+// confere, antes de tocar no jogo, que todos os índices do snapshot caem
+// dentro do canvas, que as células e a direção têm valores que o jogo
+// conhece e que as células livres, a cobra e a comida batem com as células.
+// Os arrays do canvas e da cobra são indexados por esses campos sem outras
+// conferências, então um arquivo corrompido que passasse daqui escreveria
+// fora deles depois
+static bool snapshot_is_valid(Canvas* canvas, Snake* snake, const GameSnapshot* snapshot) {
+  int size = canvas->rows * canvas->cols;
+  bool seen[SNAPSHOT_MAX_CELLS] = { false };
+  int unused = 0;
+
+  if (
+      snapshot->magic != SNAPSHOT_MAGIC ||
+      snapshot->version != SNAPSHOT_VERSION ||
+      snapshot->rows != canvas->rows ||
+      snapshot->cols != canvas->cols ||
+      size > SNAPSHOT_MAX_CELLS ||
+      snapshot->snake_size < 1 ||
+      snapshot->snake_size + snapshot->snake_pending_growth > snake->capacity ||
+      snapshot->food_cell >= size ||
+      snapshot->snake_direction < DIRECTION_NORTH ||
+      snapshot->snake_direction > DIRECTION_WEST
+  ) {
+    return false;
+  }
+
+  for (int i = 0; i < size; i++) {
+    if (snapshot->cells[i] > CELL_OBSTACLE) {
+      return false;
+    }
+
+    unused += snapshot->cells[i] == CELL_UNUSED;
+  }
+
+  // as células livres são exatamente as vazias, cada uma uma vez só
+  if (snapshot->free_count != unused) {
+    return false;
+  }
+
+  for (int i = 0; i < snapshot->free_count; i++) {
+    uint16_t cell = snapshot->free_order[i];
+
+    if (cell >= size || seen[cell] || snapshot->cells[cell] != CELL_UNUSED) {
+      return false;
+    }
+
+    seen[cell] = true;
+  }
+
+  for (int i = 0; i < snapshot->snake_size; i++) {
+    uint16_t cell = snapshot->body[i];
+
+    if (cell >= size || (snapshot->cells[cell] != CELL_SNAKE_BODY && snapshot->cells[cell] != CELL_SNAKE_HEAD)) {
+      return false;
+    }
+  }
+
+  if ((snapshot->flags & SNAPSHOT_FLAG_FOOD_IN_CANVAS) && snapshot->cells[snapshot->food_cell] != CELL_FOOD) {
+    return false;
+  }
+
+  return true;
+}
+
+// restaura um snapshot num jogo com um canvas do mesmo tamanho, em tempo
+// proporcional ao canvas; retorna false se o snapshot não for válido para ele
+bool game_snapshot_load(GameState* state, const GameSnapshot* snapshot) {
+  Canvas* canvas = state->canvas;
+  Snake* snake = state->snake;
+  Food* food = state->food;
+
+  if (!snapshot_is_valid(canvas, snake, snapshot)) {
+    return false;
+  }
+
+  state->seed = snapshot->seed;
+  state->ticks = snapshot->ticks;
+  state->over = (snapshot->flags & SNAPSHOT_FLAG_OVER) != 0;
+  state->won = (snapshot->flags & SNAPSHOT_FLAG_WON) != 0;
+
+  canvas->random.state = snapshot->random_state;
+  canvas->random.increment = snapshot->random_increment;
+  canvas_load(canvas, snapshot->cells, snapshot->free_order, snapshot->free_count);
+
+  // a cabeça vai para o último slot usado do buffer circular e os nodes
+  // seguintes para os slots anteriores
+  snake->size = snapshot->snake_size;
+  snake->head = snake->size - 1;
+  snake->pending_growth = snapshot->snake_pending_growth;
+  snake->direction = snapshot->snake_direction;
+  snake->self_collided = (snapshot->flags & SNAPSHOT_FLAG_SELF_COLLIDED) != 0;
+  snake->in_canvas = true;
+
+  for (int i = 0; i < snake->size; i++) {
+    cell_to_position(canvas, snapshot->body[i], snake->node_positions[snake->head - i]);
+  }
+
+  cell_to_position(canvas, snapshot->food_cell, food->position);
+  food->in_canvas = (snapshot->flags & SNAPSHOT_FLAG_FOOD_IN_CANVAS) != 0;
+
+  return true;
+}
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../inc/synth.h"
+
+// =============================================================
+// SYNTH
+// Mixer de vozes para o buzzer, só com contas inteiras: cada voz é uma onda
+// quadrada, triangular, ruído ou um PCM curto, com volume próprio, e
+// synth_mix soma as vozes e converte a soma em níveis de PWM de 0 a top,
+// com o silêncio no meio. Não mexe em hardware, e roda igual no host; quem
+// leva os níveis ao PWM é src/synth_stream.c.
+//
+// Cada voz é somada sozinha num bloco de SYNTH_MIX_BLOCK amostras, num laço
+// sem desvio por forma de onda, e o bloco é escalado uma vez no fim. A
+// escala deixa as SYNTH_VOICES vozes no volume máximo, juntas, no limite do
+// PWM, então a soma nunca satura.
+// =============================================================
+
+// amplitude das formas de onda: de -128 a 127
+#define SYNTH_WAVE_MAX 128
+
+static void voice_square(SynthVoice* voice, int32_t* mix, uint count) {
+  uint32_t phase = voice->phase;
+  int32_t volume = voice->volume;
+
+  for (uint i = 0; i < count; i++) {
+    // 127 na primeira metade do ciclo e -128 na segunda
+    mix[i] += (127 ^ ((int32_t) phase >> 31)) * volume;
+    phase += voice->step;
+  }
+
+  voice->phase = phase;
+}
+
+static void voice_triangle(SynthVoice* voice, int32_t* mix, uint count) {
+  uint32_t phase = voice->phase;
+  int32_t volume = voice->volume;
+
+  for (uint i = 0; i < count; i++) {
+    int32_t t = (int32_t) (phase >> 23);
+    mix[i] += ((t < 256 ? t : 511 - t) - SYNTH_WAVE_MAX) * volume;
+    phase += voice->step;
+  }
+
+  voice->phase = phase;
+}
+
+static void voice_noise(SynthVoice* voice, int32_t* mix, uint count) {
+  uint32_t phase = voice->phase;
+  uint16_t noise = voice->noise;
+  int32_t volume = voice->volume;
+
+  for (uint i = 0; i < count; i++) {
+    mix[i] += (noise & 1 ? 127 : -SYNTH_WAVE_MAX) * volume;
+    uint32_t next = phase + voice->step;
+
+    // a fase deu a volta: um passo do LFSR
+    if (next < phase) {
+      noise = (uint16_t) ((noise >> 1) | (((noise ^ (noise >> 1)) & 1) << 14));
+    }
+
+    phase = next;
+  }
+
+  voice->phase = phase;
+  voice->noise = noise;
+}
+
+// retorna quantas amostras o PCM ainda tinha, até count
+static uint voice_pcm(SynthVoice* voice, int32_t* mix, uint count) {
+  uint32_t phase = voice->phase;
+  int32_t volume = voice->volume;
+  uint i;
+
+  for (i = 0; i < count && phase < voice->pcm_end; i++) {
+    mix[i] += voice->pcm[phase >> 16] * volume;
+    phase += voice->step;
+  }
+
+  voice->phase = phase;
+
+  return i;
+}
+
+// soma uma voz em count amostras do bloco
+static void voice_mix(SynthVoice* voice, int32_t* mix, uint count) {
+  if (voice->remaining > 0 && voice->remaining < count) {
+    count = voice->remaining;
+  }
+
+  uint played = count;
+
+  switch (voice->wave) {
+    case SYNTH_SQUARE: {
+      voice_square(voice, mix, count);
+      break;
+    } case SYNTH_TRIANGLE: {
+      voice_triangle(voice, mix, count);
+      break;
+    } case SYNTH_NOISE: {
+      voice_noise(voice, mix, count);
+      break;
+    } case SYNTH_PCM: {
+      played = voice_pcm(voice, mix, count);
+      break;
+    }
+  }
+
+  if (played < count || (voice->remaining > 0 && (voice->remaining -= played) == 0)) {
+    voice->wave = SYNTH_OFF;
+  }
+}
+
+void synth_init(Synth* synth, uint sample_rate) {
+  synth->sample_rate = sample_rate;
+
+  for (uint i = 0; i < SYNTH_VOICES; i++) {
+    synth->voices[i] = (SynthVoice) { .wave = SYNTH_OFF, .noise = 1 };
+  }
+}
+
+// toca uma onda (quadrada, triangular ou ruído) por duration_us, ou até
+// synth_stop com 0
+void synth_play(Synth* synth, uint voice, uint8_t wave, uint frequency, uint8_t volume, uint32_t duration_us) {
+  SynthVoice* v = &synth->voices[voice];
+
+  v->wave = wave;
+  v->volume = volume;
+  v->phase = 0;
+  v->step = (uint32_t) (((uint64_t) frequency << 32) / synth->sample_rate);
+  v->remaining = (uint32_t) ((uint64_t) duration_us * synth->sample_rate / 1000000);
+
+  // uma duração mais curta que uma amostra ainda toca uma
+  if (duration_us > 0 && v->remaining == 0) {
+    v->remaining = 1;
+  }
+}
+
+// toca length amostras de pcm, gravadas a pcm_rate, uma vez
+void synth_play_pcm(Synth* synth, uint voice, const int8_t* pcm, uint length, uint pcm_rate, uint8_t volume) {
+  if (length > UINT16_MAX) {
+    fprintf(stderr, "PCM samples are limited to %u samples.\n", UINT16_MAX);
+    exit(EXIT_FAILURE);
+  }
+
+  SynthVoice* v = &synth->voices[voice];
+
+  v->wave = SYNTH_PCM;
+  v->volume = volume;
+  v->phase = 0;
+  v->step = (uint32_t) (((uint64_t) pcm_rate << 16) / synth->sample_rate);
+  v->pcm = pcm;
+  v->pcm_end = (uint32_t) length << 16;
+  v->remaining = 0;
+}
+
+void synth_stop(Synth* synth, uint voice) {
+  synth->voices[voice].wave = SYNTH_OFF;
+}
+
+bool synth_is_playing(const Synth* synth, uint voice) {
+  return synth->voices[voice].wave != SYNTH_OFF;
+}
+
+// mixa count amostras em níveis de PWM de 0 a top
+void synth_mix(Synth* synth, uint16_t* levels, uint count, uint16_t top) {
+  int32_t center = (top + 1) / 2;
+  // a soma máxima das vozes vai a (top + 1) / 2 do centro, em Q16
+  int32_t scale = (int32_t) (((int64_t) center << 16) / (SYNTH_WAVE_MAX * SYNTH_VOLUME_MAX * SYNTH_VOICES));
+  int32_t mix[SYNTH_MIX_BLOCK];
+
+  for (uint start = 0; start < count; start += SYNTH_MIX_BLOCK) {
+    uint block = count - start < SYNTH_MIX_BLOCK ? count - start : SYNTH_MIX_BLOCK;
+
+    for (uint i = 0; i < block; i++) {
+      mix[i] = 0;
+    }
+
+    for (uint v = 0; v < SYNTH_VOICES; v++) {
+      if (synth->voices[v].wave != SYNTH_OFF) {
+        voice_mix(&synth->voices[v], mix, block);
+      }
+    }
+
+    for (uint i = 0; i < block; i++) {
+      int32_t level = center + (mix[i] * scale >> 16);
+      levels[start + i] = (uint16_t) (level < 0 ? 0 : level > top ? top : level);
+    }
+  }
+}
@@ -0,0 +1,158 @@
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "../inc/synth_stream.h"
+
+// =============================================================
+// SYNTH STREAM
+// Leva os níveis de src/synth.c ao PWM do buzzer sem a CPU no caminho de
+// cada amostra: um timer de ritmo do DMA pede uma transferência por amostra,
+// na taxa do Synth, e dois canais de DMA encadeados copiam as duas metades
+// do buffer para o registrador de nível da fatia, um disparando o outro ao
+// terminar. Quando uma metade acaba de tocar, a interrupção de DMA a mixa de
+// novo (enquanto a outra toca) e volta o endereço de leitura do seu canal
+// para o começo dela.
+//
+// A escrita de 16 bits no registrador de nível vale para os dois canais da
+// fatia (o barramento do RP2040 repete escritas estreitas nas duas metades),
+// e só o canal do pino, que está na função PWM, aparece.
+//
+// Com o stream rodando, as vozes do Synth são mexidas pela interrupção:
+// mude-as com as interrupções desligadas.
+// =============================================================
+
+static uint16_t buffer[SYNTH_BUFFER_SAMPLES];
+static Synth* stream_synth = NULL;
+static int channels[2] = { -1, -1 };
+static int pacing_timer = -1;
+static uint stream_pin;
+static uint stream_rate;
+
+// a fração numerator / denominator do clk_sys mais perto de rate, com os
+// dois em 16 bits; retorna a taxa que ela dá
+static uint pacing_fraction(uint32_t clock_hz, uint rate, uint16_t* numerator, uint16_t* denominator) {
+  uint64_t best_error = UINT64_MAX;
+
+  for (uint n = 1; n <= 64; n++) {
+    uint64_t d = ((uint64_t) clock_hz * n + rate / 2) / rate;
+
+    if (d == 0 || d > UINT16_MAX) {
+      continue;
+    }
+
+    // erro em mHz, para comparar frações próximas
+    uint64_t actual = (uint64_t) clock_hz * n * 1000 / d;
+    uint64_t error = actual > (uint64_t) rate * 1000 ? actual - (uint64_t) rate * 1000 : (uint64_t) rate * 1000 - actual;
+
+    if (error < best_error) {
+      best_error = error;
+      *numerator = (uint16_t) n;
+      *denominator = (uint16_t) d;
+    }
+  }
+
+  return best_error == UINT64_MAX ? 0 : (uint) ((uint64_t) clock_hz * *numerator / *denominator);
+}
+
+// uma metade acabou de tocar (e a outra já começou): mixa a próxima vez dela
+static void synth_stream_irq(void) {
+  for (int half = 0; half < 2; half++) {
+    if (!dma_channel_get_irq0_status(channels[half])) {
+      continue;
+    }
+
+    dma_channel_acknowledge_irq0(channels[half]);
+    uint16_t* levels = &buffer[half * SYNTH_HALF_SAMPLES];
+    synth_mix(stream_synth, levels, SYNTH_HALF_SAMPLES, SYNTH_PWM_TOP);
+    dma_channel_set_read_addr(channels[half], levels, false);
+  }
+}
+
+// começa a tocar synth no pino; retorna false se já há um stream ou a taxa
+// não cabe no timer de ritmo
+bool synth_stream_start(Synth* synth, uint pin) {
+  uint16_t numerator = 0;
+  uint16_t denominator = 0;
+
+  if (synth_stream_is_running()) {
+    return false;
+  }
+
+  stream_rate = pacing_fraction(clock_get_hz(clk_sys), synth->sample_rate, &numerator, &denominator);
+
+  if (stream_rate == 0) {
+    return false;
+  }
+
+  stream_synth = synth;
+  stream_pin = pin;
+
+  uint slice = pwm_gpio_to_slice_num(pin);
+  gpio_set_function(pin, GPIO_FUNC_PWM);
+  pwm_config config = pwm_get_default_config();
+  pwm_config_set_clkdiv(&config, 1.0f);
+  pwm_config_set_wrap(&config, SYNTH_PWM_TOP);
+  pwm_init(slice, &config, true);
+
+  // as duas metades já começam mixadas
+  synth_mix(synth, buffer, SYNTH_BUFFER_SAMPLES, SYNTH_PWM_TOP);
+
+  pacing_timer = dma_claim_unused_timer(true);
+  channels[0] = dma_claim_unused_channel(true);
+  channels[1] = dma_claim_unused_channel(true);
+
+  for (int half = 0; half < 2; half++) {
+    dma_channel_config c = dma_channel_get_default_config(channels[half]);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, dma_get_timer_dreq(pacing_timer));
+    channel_config_set_chain_to(&c, channels[1 - half]);
+    dma_channel_configure(channels[half], &c, &pwm_hw->slice[slice].cc, &buffer[half * SYNTH_HALF_SAMPLES], SYNTH_HALF_SAMPLES, false);
+    dma_channel_set_irq0_enabled(channels[half], true);
+  }
+
+  irq_set_exclusive_handler(DMA_IRQ_0, synth_stream_irq);
+  irq_set_enabled(DMA_IRQ_0, true);
+  dma_timer_set_fraction(pacing_timer, numerator, denominator);
+  dma_channel_start(channels[0]);
+
+  return true;
+}
+
+// para o DMA e cala o buzzer
+void synth_stream_stop(void) {
+  if (!synth_stream_is_running()) {
+    return;
+  }
+
+  // sem pedidos do timer os canais param onde estão, e abortá-los não
+  // dispara o encadeado
+  dma_timer_set_fraction(pacing_timer, 0, 0);
+  irq_set_enabled(DMA_IRQ_0, false);
+
+  for (int half = 0; half < 2; half++) {
+    dma_channel_set_irq0_enabled(channels[half], false);
+    dma_channel_abort(channels[half]);
+    dma_channel_acknowledge_irq0(channels[half]);
+    dma_channel_unclaim(channels[half]);
+    channels[half] = -1;
+  }
+
+  irq_remove_handler(DMA_IRQ_0, synth_stream_irq);
+  dma_timer_unclaim(pacing_timer);
+  pacing_timer = -1;
+  pwm_set_gpio_level(stream_pin, 0);
+  stream_synth = NULL;
+}
+
+bool synth_stream_is_running(void) {
+  return stream_synth != NULL;
+}
+
+// amostras por segundo que o timer de ritmo entrega
+uint synth_stream_rate(void) {
+  return stream_rate;
+}
@@ -1,5 +1,4 @@
 #include <stdbool.h>
-#include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <constants.h>
@@ -11,6 +10,8 @@
 #include "../inc/joystick.h"
 #include "../inc/melody.h"
 #include "../inc/settings.h"
+#include "../inc/input_events.h"
+#include "../inc/random.h"
 #include <string.h>
 
 // =============================================================
@@ -65,22 +66,17 @@ int wrap(int n, int min, int max) {
   return n;
 }
 
-// pega um valor inteiro pseudo aleatório (um algoritmo verdadeiramente
-// aleatório não vale a pena devido à complexidade) no intervalo inclusivo
-// [min, max], útil para escolhas aleatórias.
+// pega um valor inteiro pseudo aleatório no intervalo inclusivo [min, max],
+// útil para escolhas aleatórias. Usa o gerador padrão (../inc/random.h), que
+// é semeado no boot; quem precisa de uma sequência reproduzível deve usar um
+// gerador próprio.
 int randint(int min, int max) {
   if (min > max) {
     fprintf(stderr, "randint called with min (%i) greater than max (%i).\n", min, max);
     exit(EXIT_FAILURE);
   }
 
-  static bool initilized = false;
-
-  if (!initilized) {
-    srand(time(NULL));
-  }
-
-  return min + rand() % (max - min + 1);
+  return random_range(random_default(), min, max);
 }
 
 void display_show_lines(uint8_t *ssd, uint8_t ssd_size, char* lines[], uint8_t lines_size, RenderArea frame_area) {
@@ -112,17 +108,15 @@ bool is_button_down(uint8_t button) {
 }
 
 int wait_button_a_or_b() {
+    InputEvent event;
+    input_events_clear();
+
     while (true) {
-        bool button_a_down = is_button_down(BUTTON_A);
-        bool button_b_down = is_button_down(BUTTON_B);
+        input_wait_event(&event);
 
-        if (button_a_down) {
-            return BUTTON_A;
-        } else if (button_b_down) {
-            return BUTTON_B;
+        if (event.type == INPUT_EVENT_BUTTON_DOWN) {
+            return event.button;
         }
-
-        sleep_ms(50);
     }
 
     return -1;
@@ -137,44 +131,40 @@ void pwm_init_buzzer(uint pin) {
     pwm_set_gpio_level(pin, 0); // Desliga o PWM inicialmente
 }
 
+// espera a escolha de uma opção do menu: o joystick (para cima e para
+// baixo) move a seleção e o botão B escolhe, quando é solto. Entre um evento
+// e outro o processador dorme (veja input_events.c)
 uint wait_menu_text_choice(MenuText* menu_text, uint8_t* ssd, RenderArea render_area) {
-    int joystick_wait = 150;
-    int button_wait = 50;
-
     display_menu_text(*menu_text, ssd, render_area);
 
-    for (int i = 0; true; i = (i + 1) * button_wait >= joystick_wait ? 0 : i + 1) {
-        if ((i + 1) * button_wait >= joystick_wait) {
-            JoystickInfo joystick_info = joystick_get_info();
-            Direction joystick_direction = joystick_info.direction;
+    input_events_clear();
+    input_menu_sampler_start();
 
-            if (joystick_direction == DIRECTION_SOUTH || joystick_direction == DIRECTION_NORTH) {
-                if (joystick_direction == DIRECTION_SOUTH) {
-                    menu_text_move_selection_down(menu_text);
-                } else {
-                    menu_text_move_selection_up(menu_text);
-                }
+    InputEvent event;
 
-                if (!game_settings_get()->sound.sound_effects.mute) {
-                  play_selection_move(BUZZER_PIN);
-                }
+    while (true) {
+        input_wait_event(&event);
 
-                display_menu_text(*menu_text, ssd, render_area);
+        if (event.type == INPUT_EVENT_JOYSTICK && (event.direction == DIRECTION_SOUTH || event.direction == DIRECTION_NORTH)) {
+            if (event.direction == DIRECTION_SOUTH) {
+                menu_text_move_selection_down(menu_text);
+            } else {
+                menu_text_move_selection_up(menu_text);
             }
-        }
 
-        bool button_b_down = is_button_down(BUTTON_B);
+            // redesenha antes do som, que sem o core de saída bloqueia
+            display_menu_text(*menu_text, ssd, render_area);
 
-        if (button_b_down) {
+            if (!game_settings_get()->sound.sound_effects.mute) {
+                play_selection_move(BUZZER_PIN);
+            }
+        } else if (event.type == INPUT_EVENT_BUTTON_DOWN && event.button == BUTTON_B) {
             uint selected_action = menu_text_get_selected_option(*menu_text).action;
 
-            while (is_button_down(BUTTON_B)) {
-              sleep_ms(150);
-            };
+            input_wait_release(BUTTON_B);
+            input_menu_sampler_stop();
 
             return selected_action;
         }
-
-        sleep_ms(button_wait);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+# =============================================================
+# GEN MELODIES
+# Gera, na compilação, as tabelas das melodias a partir de uma partitura
+# (src/melodies.score):
+#
+#   - note_pwm: para cada nota usada, o wrap e o divisor de clock (8.4) do
+#     PWM que a tocam com o clk_sys configurado, para que tone_on só copie
+#     valores da flash em vez de dividir o clock pela frequência
+#   - uma lista de passos por melodia, cada um um uint16_t com o índice da
+#     nota na tabela e a duração em ticks (veja MELODY_STEP em inc/melody.h)
+#
+#   gen_melodies.py --sys-clock-hz HZ PARTITURA HEADER FONTE
+# =============================================================
+
+import argparse
+import math
+import os
+import re
+import sys
+
+# os mesmos de MELODY_STEP em inc/melody.h
+NOTE_BITS = 6
+TICK_BITS = 10
+MAX_NOTES = (1 << NOTE_BITS) - 1
+MAX_TICKS = (1 << TICK_BITS) - 1
+MAX_WRAP = 0xffff
+# divisor em 1/16: de 1.0 a 255 + 15/16
+MIN_DIV16 = 16
+MAX_DIV16 = 255 * 16 + 15
+
+# C0: a oitava -1 não tem nome de macro válido
+MIN_MIDI = 12
+
+SEMITONES = {"C": 0, "D": 2, "E": 4, "F": 5, "G": 7, "A": 9, "B": 11}
+SHARP_NAMES = ["C", "Cs", "D", "Ds", "E", "F", "Fs", "G", "Gs", "A", "As", "B"]
+NOTE_PATTERN = re.compile(r"^([A-G])([#b]?)(-?\d)$")
+# '#' no começo de uma palavra; dentro de uma nota (C#4) é sustenido
+COMMENT_PATTERN = re.compile(r"(?:^|\s)#")
+
+
+class ScoreError(Exception):
+    pass
+
+
+def parse_note(text):
+    """Número MIDI de um nome (C4, C#4, Db4) ou de um número (60); None
+    para a pausa R."""
+    if text == "R":
+        return None
+
+    if text.isdigit():
+        midi = int(text)
+    else:
+        match = NOTE_PATTERN.match(text)
+
+        if match is None:
+            raise ScoreError(f"invalid note '{text}'")
+
+        letter, accidental, octave = match.groups()
+        midi = (int(octave) + 1) * 12 + SEMITONES[letter] + {"": 0, "#": 1, "b": -1}[accidental]
+
+    if not 0 <= midi <= 127:
+        raise ScoreError(f"note '{text}' out of the MIDI range")
+
+    # a oitava -1 daria nomes como NOTE_C-1, que não são identificadores em C
+    if midi < MIN_MIDI:
+        raise ScoreError(f"note '{text}' is below C0")
+
+    return midi
+
+
+def note_name(midi):
+    return f"{SHARP_NAMES[midi % 12]}{midi // 12 - 1}"
+
+
+def note_frequency(midi):
+    return 440.0 * 2 ** ((midi - 69) / 12)
+
+
+def note_pwm(midi, sys_clock_hz):
+    """(wrap, divisor em 1/16, frequência tocada) com o menor divisor que
+    deixa o wrap caber em 16 bits, para a maior resolução."""
+    frequency = note_frequency(midi)
+    div16 = max(MIN_DIV16, math.ceil(sys_clock_hz * 16 / (frequency * (MAX_WRAP + 1))))
+
+    if div16 > MAX_DIV16:
+        raise ScoreError(f"note {note_name(midi)} is too low for a {sys_clock_hz} Hz clock")
+
+    wrap = round(sys_clock_hz * 16 / (div16 * frequency)) - 1
+
+    if wrap > MAX_WRAP:
+        div16 += 1
+        wrap = round(sys_clock_hz * 16 / (div16 * frequency)) - 1
+
+    if wrap < 1:
+        raise ScoreError(f"note {note_name(midi)} is too high for a {sys_clock_hz} Hz clock")
+
+    return wrap, div16, sys_clock_hz * 16 / (div16 * (wrap + 1))
+
+
+def parse_score(path):
+    """(tick_ms, notas avulsas, [(nome, [(midi ou None, ticks)])])"""
+    tick_ms = None
+    extra_notes = set()
+    melodies = []
+
+    with open(path, encoding="utf-8") as score:
+        for number, line in enumerate(score, 1):
+            words = COMMENT_PATTERN.split(line, 1)[0].split()
+
+            if not words:
+                continue
+
+            try:
+                if words[0] == "tick_ms":
+                    if len(words) != 2 or not words[1].isdigit() or int(words[1]) == 0:
+                        raise ScoreError("tick_ms takes one positive integer")
+                    tick_ms = int(words[1])
+                elif words[0] == "notes":
+                    extra_notes.update(n for n in (parse_note(w) for w in words[1:]) if n is not None)
+                elif words[0] == "melody":
+                    if len(words) != 2 or not re.match(r"^[a-z_][a-z0-9_]*$", words[1]):
+                        raise ScoreError("melody takes one lowercase identifier")
+                    if any(name == words[1] for name, _ in melodies):
+                        raise ScoreError(f"melody '{words[1]}' defined twice")
+                    melodies.append((words[1], []))
+                else:
+                    if not melodies:
+                        raise ScoreError("steps before the first melody")
+
+                    for word in words:
+                        note, _, ticks = word.partition(":")
+
+                        if not ticks.isdigit() or not 1 <= int(ticks) <= MAX_TICKS:
+                            raise ScoreError(f"step '{word}' needs a duration of 1 to {MAX_TICKS} ticks")
+
+                        melodies[-1][1].append((parse_note(note), int(ticks)))
+            except ScoreError as error:
+                raise ScoreError(f"{path}:{number}: {error}") from None
+
+    if tick_ms is None:
+        raise ScoreError(f"{path}: missing tick_ms")
+
+    for name, steps in melodies:
+        if not steps:
+            raise ScoreError(f"{path}: melody '{name}' has no steps")
+
+    return tick_ms, extra_notes, melodies
+
+
+def generate(score_path, sys_clock_hz, header_path, source_path):
+    tick_ms, extra_notes, melodies = parse_score(score_path)
+    used = sorted(extra_notes | {note for _, steps in melodies for note, _ in steps if note is not None})
+
+    if len(used) > MAX_NOTES:
+        raise ScoreError(f"{score_path}: {len(used)} distinct notes, at most {MAX_NOTES} fit in a step")
+
+    # o índice 0 é a pausa
+    index = {midi: i + 1 for i, midi in enumerate(used)}
+    source_name = os.path.basename(score_path)
+    banner = f"// Gerado por tools/gen_melodies.py a partir de {source_name}, para um clk_sys de\n" \
+             f"// {sys_clock_hz} Hz. Não edite: mude a partitura.\n"
+
+    header = [banner, "#pragma once\n", "// incluído no fim de melody.h, que define NotePwm e MelodyStep\n"]
+    header.append(f"#define MELODY_SYS_CLOCK_HZ {sys_clock_hz}")
+    header.append(f"#define MELODY_TICK_US {tick_ms * 1000}")
+    header.append(f"#define NOTE_COUNT {len(used) + 1}\n")
+    header.append("#define NOTE_REST 0")
+
+    for midi in used:
+        header.append(f"#define NOTE_{note_name(midi)} {index[midi]}")
+
+    header.append("\nextern const NotePwm note_pwm[NOTE_COUNT];\n")
+
+    for name, steps in melodies:
+        header.append(f"#define MELODY_{name.upper()}_LENGTH {len(steps)}")
+        header.append(f"extern const MelodyStep melody_{name}[MELODY_{name.upper()}_LENGTH];\n")
+
+    source = [banner, '#include "melody.h"\n']
+    source.append("const NotePwm note_pwm[NOTE_COUNT] = {")
+    source.append("  { 0, 0, 0 }, // pausa")
+
+    for midi in used:
+        wrap, div16, played = note_pwm(midi, sys_clock_hz)
+        cents = 1200 * math.log2(played / note_frequency(midi))
+        source.append(f"  {{ {wrap}, {div16 >> 4}, {div16 & 15} }}, "
+                      f"// {note_name(midi)}: {note_frequency(midi):.2f} Hz, toca {played:.2f} Hz ({cents:+.2f} cents)")
+
+    source.append("};\n")
+
+    for name, steps in melodies:
+        source.append(f"const MelodyStep melody_{name}[MELODY_{name.upper()}_LENGTH] = {{")
+
+        for note, ticks in steps:
+            source.append(f"  MELODY_STEP(NOTE_{note_name(note) if note is not None else 'REST'}, {ticks}),")
+
+        source.append("};\n")
+
+    write(header_path, "\n".join(header).rstrip() + "\n")
+    write(source_path, "\n".join(source).rstrip() + "\n")
+
+
+def write(path, text):
+    with open(path, "w", encoding="utf-8") as output:
+        output.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the PWM note table and packed melodies from a score.")
+    parser.add_argument("--sys-clock-hz", type=int, required=True)
+    parser.add_argument("score")
+    parser.add_argument("header")
+    parser.add_argument("source")
+    args = parser.parse_args()
+
+    try:
+        generate(args.score, args.sys_clock_hz, args.header, args.source)
+    except ScoreError as error:
+        print(f"gen_melodies: {error}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,498 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "../inc/constants.h"
+#include "../inc/random.h"
+#include "../inc/joystick.h"
+#include "../inc/joystick_filter.h"
+
+// =============================================================
+// JOYSTICK TRACE (host)
+// Reproduz leituras do joystick por cada caminho de classificação e mede
+// quantas leituras saem com a direção errada, quantas inclinações se perdem
+// e quanto tempo cada caminho leva para ver uma inclinação.
+//
+//   joystick_trace [ARQUIVO...]
+//     ARQUIVO é um log da serial de um firmware com SNAKE_JOYSTICK_TRACE,
+//     com as linhas "joystick: <us> <x> <y>", opcionalmente seguidas da
+//     direção que a pessoa queria (N, E, S, W ou -). Sem ela, a referência é
+//     a de quem vê a gravação inteira: média centrada de REFERENCE_US, centro
+//     pela mediana das leituras, alcance pelos extremos e 50% do alcance.
+//
+//   joystick_trace
+//     sem arquivos, gera e reproduz traços de joysticks simulados (centro
+//     fora do nominal, curso curto, ruído com picos, centro que anda), no
+//     ritmo do amostrador do jogo e com a média do anel de DMA, e confere o
+//     resultado do caminho calibrado.
+//
+// Os caminhos: o centro e os limiares fixos (joystick_classify_hysteresis) e
+// o filtro de src/joystick_filter.c com e sem o passa-baixa. Todos são
+// calibrados no boot como no jogo, pelas leituras dos primeiros
+// BOOT_CALIBRATION_US.
+// =============================================================
+
+#define TRACE_DURATION_US 60000000
+// o ritmo do amostrador do jogo e as amostras por eixo na média do anel
+#define READ_US INPUT_SAMPLE_US
+#define RING_PAIRS (JOYSTICK_RING_SAMPLES / 2)
+#define CONVERSION_PAIR_US (2 * 1000000 / JOYSTICK_CONVERSIONS_HZ)
+#define BOOT_CALIBRATION_US 64000
+// leituras logo depois de uma mudança da direção desejada não contam como
+// erradas (o joystick ainda está no caminho)
+#define GRACE_US 60000
+#define REFERENCE_US 20000
+
+typedef struct Reading {
+  uint64_t us;
+  uint16_t x;
+  uint16_t y;
+  Direction label;
+} Reading;
+
+typedef struct Trace {
+  const char* name;
+  Reading* readings;
+  size_t count;
+} Trace;
+
+// um joystick simulado: centro (que pode andar), fração do caminho até o fim
+// da escala que ele alcança, ruído por conversão e picos até o fim da escala
+typedef struct StickModel {
+  const char* name;
+  int center_x;
+  int center_y;
+  int drift_x;
+  int drift_y;
+  int reach_percent;
+  int noise;
+  // picos por milhão de conversões
+  int spikes_ppm;
+  // sem o anel, cada leitura é uma conversão só (sem o amostrador de DMA)
+  bool single;
+} StickModel;
+
+typedef struct Path {
+  const char* name;
+  bool fixed;
+  uint32_t filter_us;
+} Path;
+
+typedef struct Score {
+  size_t counted;
+  size_t wrong;
+  int spurious;
+  int tilts;
+  int missed;
+  uint64_t latency_total_us;
+  uint64_t latency_max_us;
+  int caught;
+} Score;
+
+static const StickModel models[] = {
+  { .name = "centered", .center_x = 2047, .center_y = 2047, .drift_x = 0, .drift_y = 0,
+    .reach_percent = 100, .noise = 30, .spikes_ppm = 0, .single = false },
+  { .name = "off-center", .center_x = 2400, .center_y = 1700, .drift_x = 0, .drift_y = 0,
+    .reach_percent = 100, .noise = 40, .spikes_ppm = 0, .single = false },
+  { .name = "short throw", .center_x = 2047, .center_y = 2047, .drift_x = 0, .drift_y = 0,
+    .reach_percent = 65, .noise = 30, .spikes_ppm = 0, .single = false },
+  { .name = "noisy, spikes", .center_x = 2150, .center_y = 1950, .drift_x = 0, .drift_y = 0,
+    .reach_percent = 90, .noise = 250, .spikes_ppm = 1000, .single = false },
+  { .name = "wandering center", .center_x = 2047, .center_y = 2047, .drift_x = 400, .drift_y = -250,
+    .reach_percent = 90, .noise = 40, .spikes_ppm = 0, .single = false },
+  { .name = "noisy, no ring", .center_x = 2150, .center_y = 1950, .drift_x = 0, .drift_y = 0,
+    .reach_percent = 90, .noise = 250, .spikes_ppm = 1000, .single = true },
+};
+
+static const Path paths[] = {
+  { "fixed center", true, 0 },
+  { "calibrated", false, 0 },
+  { "calibrated + iir 4 ms", false, 4000 },
+  { "calibrated + iir 12 ms", false, 12000 },
+};
+
+static const Direction directions[] = { DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST };
+
+static Reading* allocate_readings(size_t capacity) {
+  Reading* readings = malloc(sizeof(Reading) * capacity);
+
+  if (readings == NULL) {
+    fprintf(stderr, "Could not allocate %zu readings.\n", capacity);
+    exit(EXIT_FAILURE);
+  }
+
+  return readings;
+}
+
+static uint16_t clamp_adc(int value) {
+  return (uint16_t) (value < 0 ? 0 : value > JOYSTICK_MAX ? JOYSTICK_MAX : value);
+}
+
+// =============================================================
+// TRAÇOS SIMULADOS
+// =============================================================
+
+// a inclinação desejada num instante, em milésimos do alcance de cada lado
+typedef struct Gesture {
+  uint64_t start_us;
+  uint64_t hold_us;
+  uint64_t end_us;
+  Direction direction;
+  int amount;
+  int across;
+} Gesture;
+
+#define RAMP_US 30000
+
+static void next_gesture(Random* random, Gesture* gesture, uint64_t after_us) {
+  gesture->start_us = after_us + 250000 + random_bounded(random, 450000);
+  gesture->hold_us = gesture->start_us + RAMP_US;
+  gesture->end_us = gesture->hold_us + 120000 + random_bounded(random, 280000);
+  gesture->direction = directions[random_bounded(random, 4)];
+  gesture->amount = 600 + (int) random_bounded(random, 401);
+  gesture->across = (int) random_bounded(random, 601) - 300;
+  gesture->across = gesture->across * gesture->amount / 1000;
+}
+
+// (along, across) em milésimos no instante us
+static void gesture_at(const Gesture* gesture, uint64_t us, int* along, int* across) {
+  int64_t scale;
+
+  if (us < gesture->start_us || us >= gesture->end_us + RAMP_US) {
+    scale = 0;
+  } else if (us < gesture->hold_us) {
+    scale = (int64_t) (us - gesture->start_us) * 1000 / RAMP_US;
+  } else if (us < gesture->end_us) {
+    scale = 1000;
+  } else {
+    scale = 1000 - (int64_t) (us - gesture->end_us) * 1000 / RAMP_US;
+  }
+
+  *along = (int) (gesture->amount * scale / 1000);
+  *across = (int) (gesture->across * scale / 1000);
+}
+
+// uma conversão de um eixo: centro mais a fração do alcance do lado
+static int convert(const StickModel* model, Random* random, int center, int permille) {
+  int rail = permille < 0 ? center : JOYSTICK_MAX - center;
+  int value = center + permille * rail / 1000 * model->reach_percent / 100;
+  value += (int) random_bounded(random, 2 * model->noise + 1) - model->noise;
+
+  if (model->spikes_ppm > 0 && (int) random_bounded(random, 1000000) < model->spikes_ppm) {
+    value = random_bounded(random, 2) ? JOYSTICK_MAX : 0;
+  }
+
+  return value;
+}
+
+static Trace simulate(const StickModel* model, uint64_t seed) {
+  Random random;
+  random_seed(&random, seed);
+
+  size_t pairs = TRACE_DURATION_US / CONVERSION_PAIR_US;
+  size_t capacity = TRACE_DURATION_US / READ_US;
+  Trace trace = { model->name, allocate_readings(capacity), 0 };
+  uint16_t ring_x[RING_PAIRS], ring_y[RING_PAIRS];
+  Gesture gesture;
+
+  next_gesture(&random, &gesture, 300000);
+
+  for (size_t pair = 0; pair < pairs; pair++) {
+    uint64_t us = (uint64_t) pair * CONVERSION_PAIR_US;
+
+    if (us >= gesture.end_us + RAMP_US) {
+      next_gesture(&random, &gesture, us);
+    }
+
+    int along, across;
+    gesture_at(&gesture, us, &along, &across);
+
+    int x = 0, y = 0;
+
+    switch (gesture.direction) {
+      case DIRECTION_NORTH: y = along; x = across; break;
+      case DIRECTION_SOUTH: y = -along; x = across; break;
+      case DIRECTION_EAST: x = along; y = across; break;
+      case DIRECTION_WEST: x = -along; y = across; break;
+    }
+
+    int center_x = model->center_x + (int) ((int64_t) model->drift_x * (int64_t) us / TRACE_DURATION_US);
+    int center_y = model->center_y + (int) ((int64_t) model->drift_y * (int64_t) us / TRACE_DURATION_US);
+    ring_y[pair % RING_PAIRS] = clamp_adc(convert(model, &random, center_y, y));
+    ring_x[pair % RING_PAIRS] = clamp_adc(convert(model, &random, center_x, x));
+
+    // o amostrador lê a média do anel a cada READ_US
+    if ((us + CONVERSION_PAIR_US) % READ_US == 0 && pair + 1 >= RING_PAIRS) {
+      uint x_sum = 0, y_sum = 0;
+
+      for (int i = 0; i < RING_PAIRS; i++) {
+        x_sum += model->single ? ring_x[pair % RING_PAIRS] : ring_x[i];
+        y_sum += model->single ? ring_y[pair % RING_PAIRS] : ring_y[i];
+      }
+
+      bool held = us >= gesture.start_us && us < gesture.end_us;
+      trace.readings[trace.count++] = (Reading) {
+        us + CONVERSION_PAIR_US,
+        (uint16_t) (x_sum / RING_PAIRS),
+        (uint16_t) (y_sum / RING_PAIRS),
+        held ? gesture.direction : DIRECTION_NONE,
+      };
+    }
+  }
+
+  return trace;
+}
+
+// =============================================================
+// GRAVAÇÕES
+// =============================================================
+
+static int compare_uint16(const void* a, const void* b) {
+  return (int) *(const uint16_t*) a - (int) *(const uint16_t*) b;
+}
+
+static uint16_t median(const Reading* readings, size_t count, bool x) {
+  uint16_t* values = malloc(sizeof(uint16_t) * count);
+
+  for (size_t i = 0; i < count; i++) {
+    values[i] = x ? readings[i].x : readings[i].y;
+  }
+
+  qsort(values, count, sizeof(uint16_t), compare_uint16);
+  uint16_t middle = values[count / 2];
+  free(values);
+
+  return middle;
+}
+
+// a direção de referência de uma gravação sem as direções desejadas
+static void label_offline(Reading* readings, size_t count) {
+  int center_x = median(readings, count, true);
+  int center_y = median(readings, count, false);
+  int* x = malloc(sizeof(int) * count);
+  int* y = malloc(sizeof(int) * count);
+  // um lado nunca inclinado fica com o alcance mínimo, como no filtro
+  int range[4] = { JOYSTICK_MIN_RANGE, JOYSTICK_MIN_RANGE, JOYSTICK_MIN_RANGE, JOYSTICK_MIN_RANGE };
+
+  for (size_t i = 0; i < count; i++) {
+    int64_t x_sum = 0, y_sum = 0;
+    int n = 0;
+
+    for (size_t j = i; j > 0 && readings[i].us - readings[j - 1].us <= REFERENCE_US / 2; j--, n++) {
+      x_sum += readings[j - 1].x;
+      y_sum += readings[j - 1].y;
+    }
+
+    for (size_t j = i; j < count && readings[j].us - readings[i].us <= REFERENCE_US / 2; j++, n++) {
+      x_sum += readings[j].x;
+      y_sum += readings[j].y;
+    }
+
+    x[i] = (int) (x_sum / n) - center_x;
+    y[i] = (int) (y_sum / n) - center_y;
+    range[x[i] > 0] = abs(x[i]) > range[x[i] > 0] ? abs(x[i]) : range[x[i] > 0];
+    range[2 + (y[i] > 0)] = abs(y[i]) > range[2 + (y[i] > 0)] ? abs(y[i]) : range[2 + (y[i] > 0)];
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    int dx = x[i] * JOYSTICK_CENTER / range[x[i] > 0];
+    int dy = y[i] * JOYSTICK_CENTER / range[2 + (y[i] > 0)];
+    readings[i].label = joystick_classify_deviation(DIRECTION_NONE, dx, dy,
+        JOYSTICK_ENTER_DISTANCE * JOYSTICK_ENTER_DISTANCE, 0, 0);
+  }
+
+  free(x);
+  free(y);
+}
+
+static Direction parse_direction(const char* text) {
+  switch (text[0]) {
+    case 'N': return DIRECTION_NORTH;
+    case 'E': return DIRECTION_EAST;
+    case 'S': return DIRECTION_SOUTH;
+    case 'W': return DIRECTION_WEST;
+  }
+
+  return DIRECTION_NONE;
+}
+
+static Trace load(const char* path) {
+  FILE* file = fopen(path, "r");
+
+  if (file == NULL) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+
+  size_t capacity = 4096;
+  Trace trace = { path, allocate_readings(capacity), 0 };
+  size_t prefix_length = strlen(JOYSTICK_TRACE_PREFIX);
+  bool labeled = true;
+  char line[256];
+
+  while (fgets(line, sizeof(line), file) != NULL) {
+    unsigned long long us;
+    unsigned x, y;
+    char label[8] = "";
+
+    if (strncmp(line, JOYSTICK_TRACE_PREFIX, prefix_length) != 0 ||
+        sscanf(line + prefix_length, "%llu %u %u %7s", &us, &x, &y, label) < 3) {
+      continue;
+    }
+
+    if (trace.count == capacity) {
+      capacity *= 2;
+      trace.readings = realloc(trace.readings, sizeof(Reading) * capacity);
+    }
+
+    labeled = labeled && label[0] != '\0';
+    trace.readings[trace.count++] = (Reading) { us, clamp_adc((int) x), clamp_adc((int) y), parse_direction(label) };
+  }
+
+  fclose(file);
+
+  if (trace.count == 0) {
+    fprintf(stderr, "%s has no \"%s\" lines.\n", path, JOYSTICK_TRACE_PREFIX);
+    exit(EXIT_FAILURE);
+  }
+
+  if (!labeled) {
+    label_offline(trace.readings, trace.count);
+  }
+
+  return trace;
+}
+
+// =============================================================
+// REPRODUÇÃO
+// =============================================================
+
+static Score replay(const Trace* trace, const Path* path) {
+  JoystickConfig config = JOYSTICK_CONFIG_DEFAULT;
+  config.filter_us = path->filter_us;
+
+  JoystickFilter filter;
+  joystick_filter_init(&filter, &config);
+
+  // calibração do boot, com o joystick solto
+  uint64_t start_us = trace->readings[0].us;
+  uint x_sum = 0, y_sum = 0, n = 0;
+
+  for (size_t i = 0; i < trace->count && trace->readings[i].us - start_us < BOOT_CALIBRATION_US; i++, n++) {
+    x_sum += trace->readings[i].x;
+    y_sum += trace->readings[i].y;
+  }
+
+  joystick_filter_calibrate(&filter, x_sum / n, y_sum / n);
+
+  Score score = { 0 };
+  Direction output = DIRECTION_NONE;
+  Direction label = DIRECTION_NONE;
+  uint64_t label_us = start_us;
+  bool seen = false;
+
+  for (size_t i = 0; i < trace->count; i++) {
+    const Reading* reading = &trace->readings[i];
+    Direction previous = output;
+
+    output = path->fixed ? joystick_classify_hysteresis(output, reading->x, reading->y) :
+        joystick_filter_update(&filter, reading->x, reading->y, reading->us);
+
+    if (reading->label != label) {
+      score.missed += label != DIRECTION_NONE && !seen;
+      label = reading->label;
+      label_us = reading->us;
+      seen = false;
+      score.tilts += label != DIRECTION_NONE;
+    }
+
+    if (label != DIRECTION_NONE && output == label && !seen) {
+      uint64_t latency = reading->us - label_us;
+      seen = true;
+      score.caught++;
+      score.latency_total_us += latency;
+      score.latency_max_us = latency > score.latency_max_us ? latency : score.latency_max_us;
+    }
+
+    if (reading->us - label_us < GRACE_US) {
+      continue;
+    }
+
+    score.counted++;
+    score.wrong += output != label;
+    score.spurious += output != previous && output != DIRECTION_NONE && output != label;
+  }
+
+  score.missed += label != DIRECTION_NONE && !seen;
+
+  return score;
+}
+
+static void print_score(const char* trace, const char* path, Score score) {
+  printf("%-18s %-24s %8.2f %9i %7i/%-4i %9.1f %9.1f\n", trace, path,
+      score.counted > 0 ? 100.0 * score.wrong / score.counted : 0.0, score.spurious, score.missed, score.tilts,
+      score.caught > 0 ? score.latency_total_us / (double) score.caught / 1e3 : 0.0, score.latency_max_us / 1e3);
+}
+
+static void print_header(void) {
+  printf("%-18s %-24s %8s %9s %12s %9s %9s\n", "trace", "path", "wrong %", "spurious", "missed", "mean ms", "max ms");
+}
+
+int main(int argc, char** argv) {
+  print_header();
+
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      Trace trace = load(argv[i]);
+
+      for (size_t p = 0; p < count_of(paths); p++) {
+        print_score(trace.name, paths[p].name, replay(&trace, &paths[p]));
+      }
+
+      free(trace.readings);
+    }
+
+    return EXIT_SUCCESS;
+  }
+
+  Score totals[count_of(paths)] = { 0 };
+  bool no_more_missed = true;
+
+  for (size_t m = 0; m < count_of(models); m++) {
+    Trace trace = simulate(&models[m], m + 1);
+    Score scores[count_of(paths)];
+
+    for (size_t p = 0; p < count_of(paths); p++) {
+      scores[p] = replay(&trace, &paths[p]);
+      print_score(trace.name, paths[p].name, scores[p]);
+
+      totals[p].counted += scores[p].counted;
+      totals[p].wrong += scores[p].wrong;
+      totals[p].spurious += scores[p].spurious;
+      totals[p].tilts += scores[p].tilts;
+      totals[p].missed += scores[p].missed;
+      totals[p].caught += scores[p].caught;
+      totals[p].latency_total_us += scores[p].latency_total_us;
+      totals[p].latency_max_us = scores[p].latency_max_us > totals[p].latency_max_us ? scores[p].latency_max_us : totals[p].latency_max_us;
+    }
+
+    // o caminho do jogo (a configuração padrão) contra o centro fixo
+    no_more_missed = no_more_missed && scores[2].missed <= scores[0].missed;
+    free(trace.readings);
+  }
+
+  for (size_t p = 0; p < count_of(paths); p++) {
+    print_score("all", paths[p].name, totals[p]);
+  }
+
+  double added_ms = (totals[2].latency_total_us / (double) totals[2].caught - totals[1].latency_total_us / (double) totals[1].caught) / 1e3;
+  bool fewer_wrong = totals[2].wrong < totals[0].wrong && totals[2].spurious <= totals[0].spurious;
+  bool cheap_filter = added_ms <= 5;
+
+  printf("iir 4 ms adds %.1f ms mean latency to the calibrated path\n", added_ms);
+  printf("calibrated path misses no more tilts than the fixed center on any trace: %s\n", no_more_missed ? "yes" : "no");
+  printf("calibrated path has fewer wrong readings overall: %s\n", fewer_wrong ? "yes" : "no");
+  printf("default filter adds at most 5 ms: %s\n", cheap_filter ? "yes" : "no");
+
+  return no_more_missed && fewer_wrong && cheap_filter ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../inc/constants.h"
+#include "../inc/random.h"
+#include "../inc/replay.h"
+
+// =============================================================
+// REPLAY (host)
+// Reproduz gravações de jogos (src/replay.c) na simulação do host.
+//
+//   replay [--realtime] ARQUIVO
+//     ARQUIVO é uma gravação binária ou um log da serial com as linhas
+//     "replay: <hex>" escritas pelo jogo; cada gravação encontrada é
+//     reproduzida, o mais rápido possível ou, com --realtime, a um tick a
+//     cada 500 ms como no dispositivo.
+//
+//   replay --record SEMENTE ARQUIVO
+//     joga um jogo 5x5 com uma política aleatória, grava-o em ARQUIVO pelo
+//     gravador de buffer fixo, e confere se a reprodução chega ao mesmo fim.
+// =============================================================
+
+#define REALTIME_TICK_MS 500
+#define RECORD_MAX_TICKS 100000
+
+static const Direction directions[] = { DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST };
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+static uint8_t* read_file(const char* path, size_t* length) {
+  FILE* file = fopen(path, "rb");
+
+  if (file == NULL) {
+    perror(path);
+    exit(EXIT_FAILURE);
+  }
+
+  size_t capacity = 4096;
+  uint8_t* data = malloc(capacity);
+  *length = 0;
+  size_t read;
+
+  while ((read = fread(data + *length, 1, capacity - *length, file)) > 0) {
+    *length += read;
+
+    if (*length == capacity) {
+      capacity *= 2;
+      data = realloc(data, capacity);
+    }
+  }
+
+  fclose(file);
+
+  return data;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// junta os bytes das linhas "replay: <hex>" de um log da serial, ignorando as
+// demais, e retorna quantos bytes foram escritos em data
+static size_t decode_log(uint8_t* data, size_t length) {
+  size_t prefix_length = strlen(REPLAY_STDIO_PREFIX);
+  size_t out = 0;
+  size_t i = 0;
+
+  while (i < length) {
+    size_t line_end = i;
+
+    while (line_end < length && data[line_end] != '\n') {
+      line_end++;
+    }
+
+    if (line_end - i >= prefix_length && memcmp(data + i, REPLAY_STDIO_PREFIX, prefix_length) == 0) {
+      size_t j = i + prefix_length;
+
+      while (j + 1 < line_end && hex_value(data[j]) >= 0 && hex_value(data[j + 1]) >= 0) {
+        data[out++] = (uint8_t) (hex_value(data[j]) << 4 | hex_value(data[j + 1]));
+        j += 2;
+      }
+    }
+
+    i = line_end + 1;
+  }
+
+  return out;
+}
+
+// tamanho da gravação que começa em data, até o marcador de fim (ou até o fim
+// dos dados, se ela foi cortada)
+static size_t recording_length(const uint8_t* data, size_t length) {
+  ReplayReader reader;
+  ReplayEvent event;
+
+  if (!replay_reader_init(&reader, data, length)) {
+    return 0;
+  }
+
+  while (replay_reader_next(&reader, &event)) {
+  }
+
+  return reader.offset;
+}
+
+static void print_tick(GameState* state, GameEvents events, void* context) {
+  printf("tick %lu: size %i%s%s%s\n", state->ticks, state->snake->size,
+      events & GAME_EVENT_ATE ? ", ate" : "",
+      events & GAME_EVENT_LOST ? ", lost" : "",
+      events & GAME_EVENT_WON ? ", won" : "");
+}
+
+static const char* result_label(ReplayResult result) {
+  if (result.wrong_backend) return "bad backend";
+  if (!result.valid) return "truncated";
+  if (result.won) return "won";
+  if (result.lost) return "lost";
+  if (result.button == BUTTON_A) return "quit (A)";
+  if (result.button == BUTTON_B) return "restart (B)";
+  return "ended";
+}
+
+static int play(const char* path, bool realtime) {
+  size_t length;
+  uint8_t* data = read_file(path, &length);
+
+  if (length < 4 || memcmp(data, REPLAY_MAGIC, 4) != 0) {
+    length = decode_log(data, length);
+  }
+
+  int recordings = 0;
+  size_t offset = 0;
+
+  printf("%-4s %-18s %-6s %8s %6s %8s %-12s %14s\n", "#", "seed", "board", "bytes", "size", "ticks", "result", "ticks/s");
+
+  while (offset < length) {
+    size_t recording = recording_length(data + offset, length - offset);
+
+    if (recording == 0) {
+      fprintf(stderr, "%s: invalid recording at byte %zu\n", path, offset);
+      free(data);
+      return EXIT_FAILURE;
+    }
+
+    ReplayReader reader;
+    replay_reader_init(&reader, data + offset, recording);
+
+    uint64_t start = now_ns();
+    ReplayResult result = replay_play(data + offset, recording, realtime ? REALTIME_TICK_MS : 0, realtime ? print_tick : NULL, NULL);
+    double seconds = (now_ns() - start) / 1e9;
+
+    char board[16];
+    snprintf(board, sizeof(board), "%ix%i", reader.rows, reader.cols);
+    printf("%-4i %-18.16llx %-6s %8zu %6i %8lu %-12s %14.0f\n", recordings, (unsigned long long) reader.seed, board,
+        recording, result.snake_size, result.ticks, result_label(result), seconds > 0 ? result.ticks / seconds : 0);
+
+    recordings++;
+    offset += recording;
+  }
+
+  free(data);
+
+  return recordings > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void file_sink(const uint8_t* data, size_t length, void* context) {
+  fwrite(data, 1, length, context);
+}
+
+// direção aleatória entre as que não colidem no próximo passo, como o jogador
+// mudaria com o joystick
+static Direction random_safe_direction(GameState* state, Random* random) {
+  Snake* snake = state->snake;
+  Direction current = snake->direction;
+  int start = (int) random_bounded(random, 4);
+
+  for (int i = 0; i < 4; i++) {
+    Direction direction = directions[(start + i) % 4];
+
+    if (!game_direction_is_valid(state, direction)) {
+      continue;
+    }
+
+    snake->direction = direction;
+    bool collides = snake_next_move_collides(snake, state->canvas);
+    snake->direction = current;
+
+    if (!collides) {
+      return direction;
+    }
+  }
+
+  return current;
+}
+
+static int record(uint64_t seed, const char* path) {
+  FILE* file = fopen(path, "wb");
+
+  if (file == NULL) {
+    perror(path);
+    return EXIT_FAILURE;
+  }
+
+  GameState* state = game_state_init(5, 5, seed);
+  Random policy;
+  random_seed(&policy, seed);
+
+  ReplayWriter writer;
+  replay_writer_init(&writer, state->canvas->rows, state->canvas->cols, state->seed, file_sink, file);
+
+  while (!state->over && state->ticks < RECORD_MAX_TICKS) {
+    // como um jogador, muda de direção só de vez em quando
+    Direction direction = state->snake->direction;
+
+    if (random_bounded(&policy, 3) == 0 || snake_next_move_collides(state->snake, state->canvas)) {
+      direction = random_safe_direction(state, &policy);
+    }
+
+    if (direction != state->snake->direction) {
+      replay_record_direction(&writer, state->ticks, direction);
+    }
+
+    game_step(state, (GameInput) { .direction = direction });
+  }
+
+  replay_writer_finish(&writer, state->ticks);
+  fclose(file);
+
+  size_t length;
+  uint8_t* data = read_file(path, &length);
+  ReplayResult result = replay_play(data, length, 0, NULL, NULL);
+  bool matches = result.valid && result.ticks == state->ticks && result.snake_size == state->snake->size && result.won == state->won;
+
+  printf("recorded %lu ticks, size %i, %s, in %zu bytes (%zu-byte buffer)\n", state->ticks, state->snake->size,
+      state->won ? "won" : state->over ? "lost" : "ended", writer.written, (size_t) REPLAY_BUFFER_SIZE);
+  printf("replay matches: %s\n", matches ? "yes" : "no");
+
+  free(data);
+  game_state_free(state);
+
+  return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv) {
+  if (argc == 4 && strcmp(argv[1], "--record") == 0) {
+    return record(strtoull(argv[2], NULL, 0), argv[3]);
+  }
+
+  if (argc == 3 && strcmp(argv[1], "--realtime") == 0) {
+    return play(argv[2], true);
+  }
+
+  if (argc == 2) {
+    return play(argv[1], false);
+  }
+
+  fprintf(stderr, "usage: %s [--realtime] FILE\n       %s --record SEED FILE\n", argv[0], argv[0]);
+
+  return EXIT_FAILURE;
+}
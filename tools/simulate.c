@@ -0,0 +1,413 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/random.h"
+#include "../inc/game_engine.h"
+
+// =============================================================
+// SIMULATE (host)
+// Roda muitos jogos independentes em todas as threads do host, cada um com
+// sua semente (seed + índice do jogo) e uma política de entrada, e junta os
+// resultados: tamanho alcançado, ticks sobrevividos e taxa de vitória.
+//
+// Os jogos são divididos em faixas contíguas, uma por thread. Cada thread
+// tira blocos de CHUNK_GAMES do começo da sua faixa e, quando ela acaba,
+// rouba metade do que resta no fim da faixa de outra thread. Cada thread tem
+// sua própria "arena": um GameState reaproveitado entre os jogos, o gerador da
+// política e os acumuladores, alinhados para não dividir linhas de cache.
+//
+//   simulate [--games N] [--size N] [--threads N] [--seed S]
+//            [--policy random|greedy] [--max-ticks N] [--scaling]
+//
+// Com --scaling, o mesmo lote roda com 1, 2, 4, ... até N threads e o
+// relatório mostra jogos/s, aceleração e eficiência, e confere que os
+// resultados não dependem do número de threads.
+// =============================================================
+
+#define CHUNK_GAMES 16
+#define CACHE_LINE 64
+
+typedef enum Policy {
+  POLICY_RANDOM,
+  POLICY_GREEDY,
+} Policy;
+
+typedef struct BatchConfig {
+  long games;
+  int size;
+  int threads;
+  uint64_t seed;
+  Policy policy;
+  unsigned long max_ticks;
+} BatchConfig;
+
+typedef struct BatchResult {
+  unsigned long long games;
+  unsigned long long wins;
+  unsigned long long timeouts;
+  unsigned long long ticks;
+  unsigned long long lengths;
+  int max_length;
+} BatchResult;
+
+typedef struct Worker {
+  _Alignas(CACHE_LINE) pthread_mutex_t lock;
+  // faixa de jogos [next, end) ainda não tirada por ninguém
+  long next;
+  long end;
+
+  int id;
+  pthread_t thread;
+  struct Batch* batch;
+  GameState* state;
+  Random policy;
+  BatchResult result;
+  unsigned long steals;
+} Worker;
+
+typedef struct Batch {
+  BatchConfig config;
+  Worker* workers;
+} Batch;
+
+static const Direction directions[] = { DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST };
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+static bool direction_collides(GameState* state, Direction direction) {
+  Snake* snake = state->snake;
+  Direction current = snake->direction;
+
+  snake->direction = direction;
+  bool collides = snake_next_move_collides(snake, state->canvas);
+  snake->direction = current;
+
+  return collides;
+}
+
+// distância com a volta pelas bordas, já que a cobra atravessa de um lado
+// para o outro do canvas
+static int wrapped_distance(int from, int to, int size) {
+  int distance = abs(from - to);
+  return distance < size - distance ? distance : size - distance;
+}
+
+// escolhe, entre as direções que não colidem no próximo passo, a que deixa a
+// cabeça mais perto da comida; sorteia entre as empatadas
+static Direction choose_direction(GameState* state, Random* random, Policy policy) {
+  Canvas* canvas = state->canvas;
+  Snake* snake = state->snake;
+  Direction best = snake->direction;
+  int best_distance = -1;
+  int start = (int) random_bounded(random, 4);
+
+  for (int i = 0; i < 4; i++) {
+    Direction direction = directions[(start + i) % 4];
+
+    if (!game_direction_is_valid(state, direction) || direction_collides(state, direction)) {
+      continue;
+    }
+
+    if (policy == POLICY_RANDOM) {
+      return direction;
+    }
+
+    int distance = 0;
+
+    if (state->food->in_canvas) {
+      Direction current = snake->direction;
+      Position next;
+      snake->direction = direction;
+      get_next_node_position(snake, canvas, 0, next);
+      snake->direction = current;
+
+      distance = wrapped_distance(next[0], state->food->position[0], canvas->rows) +
+                 wrapped_distance(next[1], state->food->position[1], canvas->cols);
+    }
+
+    if (best_distance < 0 || distance < best_distance) {
+      best = direction;
+      best_distance = distance;
+    }
+  }
+
+  return best;
+}
+
+static void play_game(Worker* worker, long index) {
+  BatchConfig* config = &worker->batch->config;
+  uint64_t seed = config->seed + (uint64_t) index;
+  GameState* state = worker->state;
+
+  game_state_reset(state, seed);
+  random_seed(&worker->policy, ~seed);
+
+  while (!state->over && state->ticks < config->max_ticks) {
+    Direction direction = choose_direction(state, &worker->policy, config->policy);
+    game_step(state, (GameInput) { .direction = direction });
+  }
+
+  BatchResult* result = &worker->result;
+  result->games++;
+  result->wins += state->won;
+  result->timeouts += !state->over;
+  result->ticks += state->ticks;
+  result->lengths += state->snake->size;
+
+  if (state->snake->size > result->max_length) {
+    result->max_length = state->snake->size;
+  }
+}
+
+// tira um bloco do começo da própria faixa
+static bool take_chunk(Worker* worker, long* begin, long* end) {
+  pthread_mutex_lock(&worker->lock);
+  *begin = worker->next;
+  *end = worker->next + CHUNK_GAMES < worker->end ? worker->next + CHUNK_GAMES : worker->end;
+  worker->next = *end;
+  pthread_mutex_unlock(&worker->lock);
+
+  return *begin < *end;
+}
+
+// rouba a metade final do que resta na faixa de outra thread e a torna a
+// própria faixa; retorna false quando não há mais nada para roubar
+static bool steal(Worker* worker) {
+  Batch* batch = worker->batch;
+  int threads = batch->config.threads;
+
+  for (int i = 1; i < threads; i++) {
+    Worker* victim = &batch->workers[(worker->id + i) % threads];
+    long begin = 0, end = 0;
+
+    pthread_mutex_lock(&victim->lock);
+    long remaining = victim->end - victim->next;
+
+    if (remaining > 0) {
+      begin = victim->next + remaining / 2;
+      end = victim->end;
+      victim->end = begin;
+    }
+
+    pthread_mutex_unlock(&victim->lock);
+
+    if (begin < end) {
+      pthread_mutex_lock(&worker->lock);
+      worker->next = begin;
+      worker->end = end;
+      pthread_mutex_unlock(&worker->lock);
+      worker->steals++;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void* worker_run(void* argument) {
+  Worker* worker = argument;
+  BatchConfig* config = &worker->batch->config;
+  long begin, end;
+
+  worker->state = game_state_init(config->size, config->size, config->seed);
+
+  do {
+    while (take_chunk(worker, &begin, &end)) {
+      for (long index = begin; index < end; index++) {
+        play_game(worker, index);
+      }
+    }
+  } while (steal(worker));
+
+  game_state_free(worker->state);
+
+  return NULL;
+}
+
+// roda o lote e retorna os resultados somados de todas as threads
+static BatchResult run_batch(BatchConfig config, double* seconds, unsigned long* steals) {
+  Batch batch = { .config = config };
+  batch.workers = aligned_alloc(CACHE_LINE, sizeof(Worker) * config.threads);
+
+  if (batch.workers == NULL) {
+    memory_allocation_error();
+  }
+
+  for (int i = 0; i < config.threads; i++) {
+    Worker* worker = &batch.workers[i];
+    memset(worker, 0, sizeof(Worker));
+    pthread_mutex_init(&worker->lock, NULL);
+    worker->id = i;
+    worker->batch = &batch;
+    worker->next = config.games * i / config.threads;
+    worker->end = config.games * (i + 1) / config.threads;
+  }
+
+  uint64_t start = now_ns();
+
+  for (int i = 0; i < config.threads; i++) {
+    pthread_create(&batch.workers[i].thread, NULL, worker_run, &batch.workers[i]);
+  }
+
+  BatchResult total = { 0 };
+  *steals = 0;
+
+  for (int i = 0; i < config.threads; i++) {
+    Worker* worker = &batch.workers[i];
+    pthread_join(worker->thread, NULL);
+    pthread_mutex_destroy(&worker->lock);
+
+    total.games += worker->result.games;
+    total.wins += worker->result.wins;
+    total.timeouts += worker->result.timeouts;
+    total.ticks += worker->result.ticks;
+    total.lengths += worker->result.lengths;
+    total.max_length = worker->result.max_length > total.max_length ? worker->result.max_length : total.max_length;
+    *steals += worker->steals;
+  }
+
+  *seconds = (now_ns() - start) / 1e9;
+  free(batch.workers);
+
+  return total;
+}
+
+static void print_results(BatchResult result) {
+  double games = (double) result.games;
+
+  printf("games:        %llu\n", result.games);
+  printf("win rate:     %.2f%%\n", 100.0 * result.wins / games);
+  printf("mean length:  %.2f (max %i)\n", result.lengths / games, result.max_length);
+  printf("mean ticks:   %.1f\n", result.ticks / games);
+
+  if (result.timeouts > 0) {
+    printf("timeouts:     %llu\n", result.timeouts);
+  }
+}
+
+static bool same_results(BatchResult a, BatchResult b) {
+  return a.games == b.games && a.wins == b.wins && a.timeouts == b.timeouts &&
+         a.ticks == b.ticks && a.lengths == b.lengths && a.max_length == b.max_length;
+}
+
+// 1, 2, 4, ... terminando sempre em max_threads
+static int next_thread_count(int threads, int max_threads) {
+  if (threads == max_threads) {
+    return max_threads + 1;
+  }
+
+  return threads * 2 < max_threads ? threads * 2 : max_threads;
+}
+
+static void usage(const char* program) {
+  fprintf(stderr, "usage: %s [--games N] [--size N] [--threads N] [--seed S] [--policy random|greedy] [--max-ticks N] [--scaling]\n", program);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  BatchConfig config = {
+    .games = 100000,
+    .size = 5,
+    .threads = cores > 0 ? (int) cores : 1,
+    .seed = 1,
+    .policy = POLICY_GREEDY,
+    .max_ticks = 0,
+  };
+  bool scaling = false;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+
+    if (strcmp(argv[i], "--scaling") == 0) {
+      scaling = true;
+    } else if (strcmp(argv[i], "--games") == 0 && has_value) {
+      config.games = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--size") == 0 && has_value) {
+      config.size = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+      config.threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+      config.seed = strtoull(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "--max-ticks") == 0 && has_value) {
+      config.max_ticks = strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "--policy") == 0 && has_value) {
+      i++;
+
+      if (strcmp(argv[i], "random") == 0) {
+        config.policy = POLICY_RANDOM;
+      } else if (strcmp(argv[i], "greedy") == 0) {
+        config.policy = POLICY_GREEDY;
+      } else {
+        usage(argv[0]);
+      }
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  if (config.games < 1 || config.size < 2 || config.size > 255 || config.threads < 1) {
+    usage(argv[0]);
+  }
+
+  // sem limite explícito, um jogo para depois de 100 ticks por célula do canvas
+  // (uma política pode girar em círculos para sempre)
+  if (config.max_ticks == 0) {
+    config.max_ticks = 100ul * config.size * config.size;
+  }
+
+  printf("# batch simulation: %li games, %ix%i, policy %s, seed %llu, %li cores\n", config.games, config.size, config.size,
+      config.policy == POLICY_RANDOM ? "random" : "greedy", (unsigned long long) config.seed, cores);
+
+  if (!scaling) {
+    double seconds;
+    unsigned long steals;
+    BatchResult result = run_batch(config, &seconds, &steals);
+
+    print_results(result);
+    printf("threads:      %i (%lu steals)\n", config.threads, steals);
+    printf("games/s:      %.0f\n", result.games / seconds);
+
+    return EXIT_SUCCESS;
+  }
+
+  int max_threads = config.threads;
+  BatchResult baseline = { 0 };
+  double baseline_rate = 0;
+  bool identical = true;
+
+  printf("%-8s %12s %10s %10s %8s\n", "threads", "games/s", "speedup", "efficiency", "steals");
+
+  for (int threads = 1; threads <= max_threads; threads = next_thread_count(threads, max_threads)) {
+    config.threads = threads;
+
+    double seconds;
+    unsigned long steals;
+    BatchResult result = run_batch(config, &seconds, &steals);
+    double rate = result.games / seconds;
+
+    if (threads == 1) {
+      baseline = result;
+      baseline_rate = rate;
+    } else {
+      identical = identical && same_results(result, baseline);
+    }
+
+    double speedup = rate / baseline_rate;
+    printf("%-8i %12.0f %9.2fx %9.1f%% %8lu\n", threads, rate, speedup, 100.0 * speedup / threads, steals);
+  }
+
+  print_results(baseline);
+  printf("results identical across thread counts: %s\n", identical ? "yes" : "no");
+
+  return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,892 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../inc/constants.h"
+#include "../inc/utils.h"
+#include "../inc/random.h"
+#include "../inc/game_engine.h"
+
+// =============================================================
+// SOLVE (host)
+// Resolve exaustivamente o jogo num canvas pequeno: a partir do início de
+// game_state_init (cobra de tamanho 2 indo para leste), calcula o maior
+// tamanho que a cobra garante alcançar jogando da melhor forma quando a
+// comida aparece sempre na pior célula livre. Se esse tamanho for o canvas
+// inteiro, existe uma vitória garantida.
+//
+// As regras são as de game_step: a cobra anda pelas bordas com volta, não dá
+// meia volta, pode entrar na célula da cauda quando não está crescendo e
+// cresce no mesmo movimento em que come. Como o canvas é um toro, todas as
+// posições iniciais são equivalentes e o solver usa a cabeça em (0, 1).
+//
+// A comida fica parada até ser comida, então o jogo se divide em "entradas"
+// (a cobra logo depois de uma comida aparecer): o valor de uma entrada é o
+// maior, entre as saídas (movimentos que comem) alcançáveis sem comer, do
+// menor valor entre as entradas seguintes (uma por célula livre), ou o
+// tamanho atual se nenhuma saída for melhor. As entradas resolvidas ficam
+// numa tabela de transposição dividida em SHARDS partes, cada uma com seu
+// mutex, endereçada pelo hash de Zobrist do estado (atualizado a cada
+// movimento em O(1)) e conferida pela chave exata do estado (a cauda, a
+// direção de cada node até o seguinte, o tamanho e a comida, em 63 bits).
+// As threads dividem as comidas iniciais e compartilham a tabela.
+//
+// Com --export, grava um header C com a política ótima para ser embarcada na
+// flash: as chaves dos estados alcançáveis seguindo a política (com qualquer
+// comida), ordenadas para busca binária, e a direção de cada uma. Antes,
+// confere a política jogando com game_step.
+//
+//   solve [--rows N] [--cols N] [--threads N] [--export FILE]
+//
+// O canvas de 5x5 do jogo tem estados demais para o host (a quantidade cresce
+// com o número de caminhos da cobra no toro): o solver aceita até 25 células,
+// mas 4x4 já leva alguns segundos e 150 MB, e 4x5 não termina em minutos.
+// =============================================================
+
+#define MAX_CELLS 25
+#define DIRECTIONS 4
+#define SHARDS 64
+#define SHARD_BITS 6
+#define INITIAL_TABLE_SLOTS 1024
+#define VALIDATION_GAMES 200
+
+// layout da chave exata de um estado
+#define KEY_DIRECTIONS_SHIFT 5
+#define KEY_LENGTH_SHIFT 53
+#define KEY_FOOD_SHIFT 58
+#define KEY_CELL_MASK 31ull
+
+typedef struct Board {
+  int rows;
+  int cols;
+  int cells;
+  uint8_t neighbors[MAX_CELLS][DIRECTIONS];
+  // chaves de Zobrist: node em cada célula apontando para o node seguinte em
+  // cada direção, cabeça em cada célula e comida em cada célula
+  uint64_t zobrist_node[MAX_CELLS][DIRECTIONS];
+  uint64_t zobrist_head[MAX_CELLS];
+  uint64_t zobrist_food[MAX_CELLS];
+} Board;
+
+// a cobra da cauda (cells[0]) até a cabeça (cells[length - 1])
+typedef struct Body {
+  uint8_t cells[MAX_CELLS];
+  // direção de cada node até o seguinte (a da cabeça é a direção atual)
+  uint8_t directions[MAX_CELLS];
+  int length;
+  int food;
+  uint32_t occupied;
+} Body;
+
+// tabela hash com endereçamento aberto, de chave (nunca 0) para um byte
+typedef struct Table {
+  uint64_t* keys;
+  uint8_t* values;
+  size_t slots;
+  size_t count;
+} Table;
+
+typedef struct Shard {
+  pthread_mutex_t lock;
+  Table table;
+} Shard;
+
+typedef struct QueueItem {
+  uint64_t key;
+  uint64_t hash;
+  // índice do estado anterior na fila e direção que levou a este (só usados
+  // na exportação)
+  uint32_t parent;
+  uint8_t direction;
+} QueueItem;
+
+// fila e conjunto de visitados da busca de uma entrada, um por tamanho da
+// cobra, já que a busca de uma entrada chama a das entradas seguintes
+typedef struct Search {
+  QueueItem* queue;
+  size_t queue_capacity;
+  Table visited;
+} Search;
+
+typedef struct Solver Solver;
+
+typedef struct Worker {
+  Solver* solver;
+  pthread_t thread;
+  Search searches[MAX_CELLS + 1];
+  unsigned long long states;
+  unsigned long long entries;
+} Worker;
+
+struct Solver {
+  Board board;
+  Shard shards[SHARDS];
+  pthread_mutex_t tasks_lock;
+  int next_task;
+  int value;
+  int threads;
+  Worker* workers;
+};
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+static void* allocate(size_t size) {
+  void* pointer = calloc(1, size);
+
+  if (pointer == NULL) {
+    memory_allocation_error();
+  }
+
+  return pointer;
+}
+
+// =============================================================
+// TABELAS
+// =============================================================
+
+static void table_init(Table* table, size_t slots) {
+  table->keys = allocate(sizeof(uint64_t) * slots);
+  table->values = allocate(slots);
+  table->slots = slots;
+  table->count = 0;
+}
+
+static void table_free(Table* table) {
+  free(table->keys);
+  free(table->values);
+}
+
+static size_t table_bytes(const Table* table) {
+  return table->slots * (sizeof(uint64_t) + 1);
+}
+
+static void table_clear(Table* table) {
+  memset(table->keys, 0, sizeof(uint64_t) * table->slots);
+  table->count = 0;
+}
+
+// slot da chave ou o slot vazio onde ela entraria
+static size_t table_slot(const Table* table, uint64_t key, uint64_t hash) {
+  size_t mask = table->slots - 1;
+  size_t slot = (size_t) hash & mask;
+
+  while (table->keys[slot] != 0 && table->keys[slot] != key) {
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+static void table_put(Table* table, uint64_t key, uint64_t hash, uint8_t value);
+
+// dobra a tabela quando ela passa da metade, para as buscas continuarem curtas
+static void table_grow(Table* table, uint64_t (*hash_of)(uint64_t key)) {
+  Table old = *table;
+  table_init(table, old.slots * 2);
+
+  for (size_t i = 0; i < old.slots; i++) {
+    if (old.keys[i] != 0) {
+      table_put(table, old.keys[i], hash_of(old.keys[i]), old.values[i]);
+    }
+  }
+
+  table_free(&old);
+}
+
+static void table_put(Table* table, uint64_t key, uint64_t hash, uint8_t value) {
+  size_t slot = table_slot(table, key, hash);
+
+  if (table->keys[slot] == 0) {
+    table->keys[slot] = key;
+    table->count++;
+  }
+
+  table->values[slot] = value;
+}
+
+// insere a chave, se ainda não estiver na tabela; retorna se inseriu
+static bool table_insert(Table* table, uint64_t key, uint64_t hash, uint64_t (*hash_of)(uint64_t key)) {
+  if ((table->count + 1) * 2 > table->slots) {
+    table_grow(table, hash_of);
+  }
+
+  size_t slot = table_slot(table, key, hash);
+
+  if (table->keys[slot] == key) {
+    return false;
+  }
+
+  table->keys[slot] = key;
+  table->count++;
+
+  return true;
+}
+
+// =============================================================
+// ESTADOS
+// =============================================================
+
+static void board_init(Board* board, int rows, int cols) {
+  Random random;
+  random_seed(&random, 0x5a0b1457);
+
+  board->rows = rows;
+  board->cols = cols;
+  board->cells = rows * cols;
+
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      uint8_t* neighbors = board->neighbors[row * cols + col];
+      neighbors[0] = wrap(row - 1, 0, rows - 1) * cols + col;
+      neighbors[1] = row * cols + wrap(col + 1, 0, cols - 1);
+      neighbors[2] = wrap(row + 1, 0, rows - 1) * cols + col;
+      neighbors[3] = row * cols + wrap(col - 1, 0, cols - 1);
+    }
+  }
+
+  for (int cell = 0; cell < MAX_CELLS; cell++) {
+    for (int d = 0; d < DIRECTIONS; d++) {
+      board->zobrist_node[cell][d] = random_next64(&random);
+    }
+
+    board->zobrist_head[cell] = random_next64(&random);
+    board->zobrist_food[cell] = random_next64(&random);
+  }
+}
+
+static uint64_t body_key(const Body* body) {
+  uint64_t key = body->cells[0];
+
+  for (int i = 0; i < body->length - 1; i++) {
+    key |= (uint64_t) body->directions[i] << (KEY_DIRECTIONS_SHIFT + 2 * i);
+  }
+
+  return key | (uint64_t) body->length << KEY_LENGTH_SHIFT | (uint64_t) body->food << KEY_FOOD_SHIFT;
+}
+
+static void body_decode(const Board* board, uint64_t key, Body* body) {
+  body->length = (int) (key >> KEY_LENGTH_SHIFT & KEY_CELL_MASK);
+  body->food = (int) (key >> KEY_FOOD_SHIFT & KEY_CELL_MASK);
+  body->cells[0] = (uint8_t) (key & KEY_CELL_MASK);
+  body->occupied = 1u << body->cells[0];
+
+  for (int i = 0; i < body->length - 1; i++) {
+    body->directions[i] = (uint8_t) (key >> (KEY_DIRECTIONS_SHIFT + 2 * i) & 3);
+    body->cells[i + 1] = board->neighbors[body->cells[i]][body->directions[i]];
+    body->occupied |= 1u << body->cells[i + 1];
+  }
+
+  // a direção atual é a do último movimento, do pescoço para a cabeça
+  body->directions[body->length - 1] = body->directions[body->length - 2];
+}
+
+static uint64_t body_hash(const Board* board, const Body* body) {
+  uint64_t hash = board->zobrist_head[body->cells[body->length - 1]] ^ board->zobrist_food[body->food];
+
+  for (int i = 0; i < body->length - 1; i++) {
+    hash ^= board->zobrist_node[body->cells[i]][body->directions[i]];
+  }
+
+  return hash;
+}
+
+// o hash é guardado só nas filas; as tabelas o recalculam a partir da chave
+// quando crescem
+static Board* hash_board;
+
+static uint64_t key_hash(uint64_t key) {
+  Body body;
+  body_decode(hash_board, key, &body);
+  return body_hash(hash_board, &body);
+}
+
+// hash do estado depois de mover a cabeça na direção d, comendo ou não: a
+// cabeça antiga vira um node apontando para a nova cabeça e, sem comer, o
+// node da cauda sai
+static uint64_t move_hash(const Board* board, const Body* body, uint64_t hash, int d, bool ate) {
+  int head = body->cells[body->length - 1];
+  int next = board->neighbors[head][d];
+
+  hash ^= board->zobrist_head[head] ^ board->zobrist_node[head][d] ^ board->zobrist_head[next];
+
+  if (!ate) {
+    hash ^= board->zobrist_node[body->cells[0]][body->directions[0]];
+  }
+
+  return hash;
+}
+
+// chave do estado depois de mover a cabeça na direção d
+static uint64_t move_key(const Body* body, uint64_t key, int d, bool ate) {
+  int length = body->length;
+  uint64_t directions = key >> KEY_DIRECTIONS_SHIFT & ((1ull << 2 * (length - 1)) - 1);
+  directions |= (uint64_t) d << 2 * (length - 1);
+
+  if (ate) {
+    return body->cells[0] | directions << KEY_DIRECTIONS_SHIFT | (uint64_t) (length + 1) << KEY_LENGTH_SHIFT;
+  }
+
+  return body->cells[1] | (directions >> 2) << KEY_DIRECTIONS_SHIFT | (uint64_t) length << KEY_LENGTH_SHIFT |
+      (uint64_t) body->food << KEY_FOOD_SHIFT;
+}
+
+static uint64_t with_food(const Board* board, uint64_t key, uint64_t hash, int food, uint64_t* food_hash) {
+  *food_hash = hash ^ board->zobrist_food[food];
+  return key | (uint64_t) food << KEY_FOOD_SHIFT;
+}
+
+// =============================================================
+// TABELA DE TRANSPOSIÇÃO
+// =============================================================
+
+static Shard* shard_of(Solver* solver, uint64_t hash) {
+  return &solver->shards[hash >> (64 - SHARD_BITS)];
+}
+
+// valor da entrada, ou 0 se ela ainda não foi resolvida
+static int transposition_get(Solver* solver, uint64_t key, uint64_t hash) {
+  Shard* shard = shard_of(solver, hash);
+  pthread_mutex_lock(&shard->lock);
+  size_t slot = table_slot(&shard->table, key, hash);
+  int value = shard->table.keys[slot] == key ? shard->table.values[slot] : 0;
+  pthread_mutex_unlock(&shard->lock);
+
+  return value;
+}
+
+static void transposition_put(Solver* solver, uint64_t key, uint64_t hash, int value) {
+  Shard* shard = shard_of(solver, hash);
+  pthread_mutex_lock(&shard->lock);
+
+  if ((shard->table.count + 1) * 2 > shard->table.slots) {
+    table_grow(&shard->table, key_hash);
+  }
+
+  table_put(&shard->table, key, hash, (uint8_t) value);
+  pthread_mutex_unlock(&shard->lock);
+}
+
+// =============================================================
+// BUSCA
+// =============================================================
+
+static void search_reset(Search* search) {
+  if (search->visited.slots == 0) {
+    table_init(&search->visited, INITIAL_TABLE_SLOTS);
+  } else {
+    table_clear(&search->visited);
+  }
+}
+
+static bool search_visit(Search* search, uint64_t key, uint64_t hash) {
+  return table_insert(&search->visited, key, hash, key_hash);
+}
+
+static void search_push(Search* search, size_t* size, QueueItem item) {
+  if (*size == search->queue_capacity) {
+    search->queue_capacity = search->queue_capacity == 0 ? INITIAL_TABLE_SLOTS : search->queue_capacity * 2;
+    search->queue = realloc(search->queue, sizeof(QueueItem) * search->queue_capacity);
+
+    if (search->queue == NULL) {
+      memory_allocation_error();
+    }
+  }
+
+  search->queue[(*size)++] = item;
+}
+
+static int solve_entry(Worker* worker, uint64_t key, uint64_t hash);
+
+// menor valor entre as entradas que seguem uma saída (uma por célula livre
+// para a nova comida); para assim que ele não passar de floor, já que a saída
+// não seria melhor do que a que já foi encontrada
+static int exit_value(Worker* worker, const Body* body, uint64_t key, uint64_t hash, int d, int floor) {
+  const Board* board = &worker->solver->board;
+  int next = board->neighbors[body->cells[body->length - 1]][d];
+  uint32_t occupied = body->occupied | 1u << next;
+  uint64_t grown_key = move_key(body, key, d, true);
+  uint64_t grown_hash = move_hash(board, body, hash ^ board->zobrist_food[body->food], d, true);
+  int value = board->cells;
+
+  if (body->length + 1 == board->cells) {
+    return value;
+  }
+
+  for (int food = 0; food < board->cells && value > floor; food++) {
+    if (occupied & 1u << food) {
+      continue;
+    }
+
+    uint64_t food_hash;
+    uint64_t food_key = with_food(board, grown_key, grown_hash, food, &food_hash);
+    int entry = solve_entry(worker, food_key, food_hash);
+    value = entry < value ? entry : value;
+  }
+
+  return value;
+}
+
+// busca em largura pelos estados alcançáveis sem comer a partir da entrada,
+// avaliando cada saída, e guarda o valor da entrada na tabela de transposição
+static int solve_entry(Worker* worker, uint64_t key, uint64_t hash) {
+  Solver* solver = worker->solver;
+  const Board* board = &solver->board;
+  int value = transposition_get(solver, key, hash);
+
+  if (value != 0) {
+    return value;
+  }
+
+  Body body;
+  body_decode(board, key, &body);
+
+  int length = body.length;
+  Search* search = &worker->searches[length];
+  size_t size = 0;
+  int best = length;
+
+  search_reset(search);
+  search_visit(search, key, hash);
+  search_push(search, &size, (QueueItem) { .key = key, .hash = hash });
+  worker->entries++;
+
+  for (size_t i = 0; i < size && best < board->cells; i++) {
+    QueueItem item = search->queue[i];
+    body_decode(board, item.key, &body);
+    worker->states++;
+
+    int head = body.cells[length - 1];
+    int reverse = body.directions[length - 1] ^ 2;
+
+    for (int d = 0; d < DIRECTIONS && best < board->cells; d++) {
+      int next = board->neighbors[head][d];
+
+      if (d == reverse) {
+        continue;
+      }
+
+      if (next == body.food) {
+        int exit = exit_value(worker, &body, item.key, item.hash, d, best);
+        best = exit > best ? exit : best;
+      } else if (!(body.occupied & 1u << next) || next == body.cells[0]) {
+        uint64_t next_key = move_key(&body, item.key, d, false);
+        uint64_t next_hash = move_hash(board, &body, item.hash, d, false);
+
+        if (search_visit(search, next_key, next_hash)) {
+          search_push(search, &size, (QueueItem) { .key = next_key, .hash = next_hash });
+        }
+      }
+    }
+  }
+
+  transposition_put(solver, key, hash, best);
+
+  return best;
+}
+
+// a cobra do início do jogo, com a cabeça em (0, 1) e a cauda em (0, 0)
+static void start_body(const Board* board, Body* body, int food) {
+  body->length = 2;
+  body->cells[0] = 0;
+  body->cells[1] = (uint8_t) board->neighbors[0][1];
+  body->directions[0] = 1;
+  body->directions[1] = 1;
+  body->food = food;
+  body->occupied = 1u << body->cells[0] | 1u << body->cells[1];
+}
+
+static void* worker_run(void* argument) {
+  Worker* worker = argument;
+  Solver* solver = worker->solver;
+  const Board* board = &solver->board;
+
+  while (true) {
+    pthread_mutex_lock(&solver->tasks_lock);
+    int food = solver->next_task++;
+    pthread_mutex_unlock(&solver->tasks_lock);
+
+    if (food >= board->cells) {
+      return NULL;
+    }
+
+    Body body;
+    start_body(board, &body, food);
+
+    if (body.occupied & 1u << food) {
+      continue;
+    }
+
+    int value = solve_entry(worker, body_key(&body), body_hash(board, &body));
+
+    pthread_mutex_lock(&solver->tasks_lock);
+    solver->value = value < solver->value ? value : solver->value;
+    pthread_mutex_unlock(&solver->tasks_lock);
+  }
+}
+
+// =============================================================
+// POLÍTICA
+// =============================================================
+
+// direção ótima de cada estado alcançável seguindo a política
+typedef struct Policy {
+  Table moves;
+  Table entries;
+} Policy;
+
+static void policy_put(Policy* policy, uint64_t key, uint64_t hash, uint8_t direction) {
+  // o primeiro caminho que passa por um estado fica com ele: todo caminho
+  // gravado leva a uma saída com o valor da sua entrada, e um estado que está
+  // no caminho de duas entradas alcança as mesmas saídas que elas, então
+  // seguir os caminhos gravados sempre alcança o valor
+  if (table_insert(&policy->moves, key, hash, key_hash)) {
+    policy->moves.values[table_slot(&policy->moves, key, hash)] = direction;
+  }
+}
+
+// refaz a busca da entrada até a primeira saída com o valor da entrada, grava
+// as direções do caminho e segue para as entradas depois dessa saída
+static void policy_visit(Worker* worker, Policy* policy, uint64_t key, uint64_t hash) {
+  const Board* board = &worker->solver->board;
+
+  if (!table_insert(&policy->entries, key, hash, key_hash)) {
+    return;
+  }
+
+  Body body;
+  body_decode(board, key, &body);
+
+  int length = body.length;
+  int value = solve_entry(worker, key, hash);
+
+  if (value == length) {
+    return;
+  }
+
+  Search* search = &worker->searches[length];
+  size_t size = 0;
+  search_reset(search);
+  search_visit(search, key, hash);
+  search_push(search, &size, (QueueItem) { .key = key, .hash = hash, .parent = UINT32_MAX });
+
+  for (size_t i = 0; i < size; i++) {
+    QueueItem item = search->queue[i];
+    body_decode(board, item.key, &body);
+
+    int head = body.cells[length - 1];
+    int reverse = body.directions[length - 1] ^ 2;
+
+    for (int d = 0; d < DIRECTIONS; d++) {
+      int next = board->neighbors[head][d];
+
+      if (d == reverse) {
+        continue;
+      }
+
+      if (next == body.food) {
+        if (exit_value(worker, &body, item.key, item.hash, d, value - 1) < value) {
+          continue;
+        }
+
+        uint8_t direction = (uint8_t) d;
+
+        for (size_t j = i; j != UINT32_MAX; j = search->queue[j].parent) {
+          policy_put(policy, search->queue[j].key, search->queue[j].hash, direction);
+          direction = search->queue[j].direction;
+        }
+
+        uint64_t grown_key = move_key(&body, item.key, d, true);
+        uint64_t grown_hash = move_hash(board, &body, item.hash ^ board->zobrist_food[body.food], d, true);
+        uint32_t occupied = body.occupied | 1u << next;
+
+        for (int food = 0; food < board->cells && length + 1 < board->cells; food++) {
+          if (!(occupied & 1u << food)) {
+            uint64_t food_hash;
+            uint64_t food_key = with_food(board, grown_key, grown_hash, food, &food_hash);
+            policy_visit(worker, policy, food_key, food_hash);
+          }
+        }
+
+        return;
+      } else if (!(body.occupied & 1u << next) || next == body.cells[0]) {
+        uint64_t next_key = move_key(&body, item.key, d, false);
+        uint64_t next_hash = move_hash(board, &body, item.hash, d, false);
+
+        if (search_visit(search, next_key, next_hash)) {
+          search_push(search, &size, (QueueItem) { .key = next_key, .hash = next_hash, .parent = (uint32_t) i, .direction = (uint8_t) d });
+        }
+      }
+    }
+  }
+}
+
+static int compare_keys(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+  return x < y ? -1 : x > y;
+}
+
+// ordena a política por chave, para busca binária
+static size_t policy_sorted(const Policy* policy, uint64_t** keys, uint8_t** moves) {
+  size_t count = 0;
+  *keys = allocate(sizeof(uint64_t) * (policy->moves.count + 1));
+  *moves = allocate(policy->moves.count + 1);
+
+  for (size_t i = 0; i < policy->moves.slots; i++) {
+    if (policy->moves.keys[i] != 0) {
+      (*keys)[count++] = policy->moves.keys[i];
+    }
+  }
+
+  qsort(*keys, count, sizeof(uint64_t), compare_keys);
+
+  for (size_t i = 0; i < count; i++) {
+    (*moves)[i] = policy->moves.values[table_slot(&policy->moves, (*keys)[i], key_hash((*keys)[i]))];
+  }
+
+  return count;
+}
+
+static void policy_export(const char* path, const Board* board, const uint64_t* keys, const uint8_t* moves, size_t count) {
+  FILE* file = fopen(path, "w");
+
+  if (file == NULL) {
+    fprintf(stderr, "Could not write %s.\n", path);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(file, "#pragma once\n\n");
+  fprintf(file, "#include <stdint.h>\n\n");
+  fprintf(file, "// gerado por tools/solve --rows %i --cols %i\n", board->rows, board->cols);
+  fprintf(file, "//\n");
+  fprintf(file, "// política ótima para um canvas de %ix%i, com as coordenadas transladadas\n", board->rows, board->cols);
+  fprintf(file, "// para que a cabeça comece em (0, 1). Chave de cada estado: bits 0-4 a\n");
+  fprintf(file, "// célula da cauda, a partir do bit 5 a direção (0 norte, 1 leste, 2 sul,\n");
+  fprintf(file, "// 3 oeste) de cada node até o seguinte, em 2 bits, bits 53-57 o tamanho e\n");
+  fprintf(file, "// bits 58-62 a célula da comida. As direções ficam em 2 bits, 4 por byte.\n\n");
+  fprintf(file, "#define SOLVER_POLICY_ROWS %i\n", board->rows);
+  fprintf(file, "#define SOLVER_POLICY_COLS %i\n", board->cols);
+  fprintf(file, "#define SOLVER_POLICY_STATES %zu\n\n", count);
+  fprintf(file, "static const uint64_t solver_policy_keys[SOLVER_POLICY_STATES] = {");
+
+  for (size_t i = 0; i < count; i++) {
+    fprintf(file, "%s0x%016llx,", i % 4 == 0 ? "\n  " : " ", (unsigned long long) keys[i]);
+  }
+
+  fprintf(file, "\n};\n\n");
+  fprintf(file, "static const uint8_t solver_policy_moves[(SOLVER_POLICY_STATES + 3) / 4] = {");
+
+  for (size_t i = 0; i < count; i += 4) {
+    uint8_t packed = 0;
+
+    for (size_t j = 0; j < 4 && i + j < count; j++) {
+      packed |= (uint8_t) (moves[i + j] << 2 * j);
+    }
+
+    fprintf(file, "%s0x%02x,", i % 48 == 0 ? "\n  " : " ", packed);
+  }
+
+  fprintf(file, "\n};\n");
+  fclose(file);
+}
+
+// =============================================================
+// CONFERÊNCIA
+// =============================================================
+
+static int position_cell(const Board* board, Position position, Position start) {
+  int row = (position[0] - start[0] + board->rows) % board->rows;
+  int col = (position[1] - start[1] + 1 + board->cols) % board->cols;
+  return row * board->cols + col;
+}
+
+// chave do estado de um jogo, transladado para a cabeça começar em (0, 1)
+static uint64_t game_key(const Board* board, GameState* state, Position start) {
+  Snake* snake = state->snake;
+  Body body = { .length = 0 };
+
+  body.length = snake->size;
+  body.food = position_cell(board, state->food->position, start);
+
+  for (int i = 0; i < snake->size; i++) {
+    Position position;
+    snake_get_node_position(snake, snake->size - 1 - i, position);
+    body.cells[i] = (uint8_t) position_cell(board, position, start);
+  }
+
+  for (int i = 0; i < body.length - 1; i++) {
+    for (int d = 0; d < DIRECTIONS; d++) {
+      if (board->neighbors[body.cells[i]][d] == body.cells[i + 1]) {
+        body.directions[i] = (uint8_t) d;
+      }
+    }
+  }
+
+  return body_key(&body);
+}
+
+// joga VALIDATION_GAMES jogos com game_step seguindo a política e confere que
+// cada um alcança o tamanho garantido para a sua primeira comida
+static bool policy_reaches_value(Worker* worker, const uint64_t* keys, const uint8_t* moves, size_t count) {
+  const Board* board = &worker->solver->board;
+  GameState* state = game_state_init(board->rows, board->cols, 1);
+  bool reaches = true;
+
+  for (uint64_t seed = 1; seed <= VALIDATION_GAMES && reaches; seed++) {
+    game_state_reset(state, seed);
+
+    Position start;
+    snake_get_head_position(state->snake, start);
+
+    uint64_t start_key = game_key(board, state, start);
+    int value = solve_entry(worker, start_key, key_hash(start_key));
+
+    while (!state->over && state->ticks < 100ul * board->cells) {
+      uint64_t key = game_key(board, state, start);
+      uint64_t* found = bsearch(&key, keys, count, sizeof(uint64_t), compare_keys);
+      Direction direction = DIRECTION_NONE;
+
+      if (found != NULL) {
+        size_t index = (size_t) (found - keys);
+        direction = DIRECTION_NORTH + moves[index];
+      }
+
+      game_step(state, (GameInput) { .direction = direction });
+    }
+
+    reaches = state->snake->size >= value;
+  }
+
+  game_state_free(state);
+
+  return reaches;
+}
+
+// =============================================================
+// MAIN
+// =============================================================
+
+static void usage(const char* program) {
+  fprintf(stderr, "usage: %s [--rows N] [--cols N] [--threads N] [--export FILE]\n", program);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  int rows = 3, cols = 4;
+  int threads = cores > 0 ? (int) cores : 1;
+  const char* export_path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+
+    if (strcmp(argv[i], "--rows") == 0 && has_value) {
+      rows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--cols") == 0 && has_value) {
+      cols = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--export") == 0 && has_value) {
+      export_path = argv[++i];
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  // com 2 linhas ou colunas, norte e sul (ou leste e oeste) levam à mesma
+  // célula e a direção de um node não fica definida pelas células
+  if (rows < 3 || cols < 3 || rows * cols > MAX_CELLS || threads < 1) {
+    usage(argv[0]);
+  }
+
+  Solver* solver = allocate(sizeof(Solver));
+  board_init(&solver->board, rows, cols);
+  hash_board = &solver->board;
+  solver->value = solver->board.cells;
+  solver->threads = threads;
+  solver->workers = allocate(sizeof(Worker) * threads);
+  pthread_mutex_init(&solver->tasks_lock, NULL);
+
+  for (int i = 0; i < SHARDS; i++) {
+    pthread_mutex_init(&solver->shards[i].lock, NULL);
+    table_init(&solver->shards[i].table, INITIAL_TABLE_SLOTS);
+  }
+
+  uint64_t start = now_ns();
+
+  for (int i = 0; i < threads; i++) {
+    solver->workers[i].solver = solver;
+    pthread_create(&solver->workers[i].thread, NULL, worker_run, &solver->workers[i]);
+  }
+
+  unsigned long long states = 0, entries = 0;
+  size_t search_bytes = 0;
+
+  for (int i = 0; i < threads; i++) {
+    Worker* worker = &solver->workers[i];
+    pthread_join(worker->thread, NULL);
+    states += worker->states;
+    entries += worker->entries;
+
+    for (int length = 0; length <= MAX_CELLS; length++) {
+      search_bytes += table_bytes(&worker->searches[length].visited) + worker->searches[length].queue_capacity * sizeof(QueueItem);
+    }
+  }
+
+  double seconds = (now_ns() - start) / 1e9;
+  size_t table_entries = 0, bytes = 0;
+
+  for (int i = 0; i < SHARDS; i++) {
+    table_entries += solver->shards[i].table.count;
+    bytes += table_bytes(&solver->shards[i].table);
+  }
+
+  int cells = solver->board.cells;
+  printf("board: %ix%i, %i threads, %.2f s\n", rows, cols, threads, seconds);
+  printf("states expanded: %llu (%.0f states/s)\n", states, states / seconds);
+  printf("entries solved: %llu (%llu solved twice by different threads)\n", entries, entries - table_entries);
+  printf("transposition table: %zu entries, %zu bytes, %.1f bytes/entry, %.2f bytes/expanded state\n",
+      table_entries, bytes, (double) bytes / table_entries, (double) bytes / states);
+  printf("search buffers: %zu bytes\n", search_bytes);
+  printf("guaranteed length: %i of %i\n", solver->value, cells);
+  printf("guaranteed win: %s\n", solver->value == cells ? "yes" : "no");
+
+  bool valid = true;
+
+  if (export_path != NULL) {
+    Worker* worker = &solver->workers[0];
+    Policy policy;
+    uint64_t* keys;
+    uint8_t* moves;
+    table_init(&policy.moves, INITIAL_TABLE_SLOTS);
+    table_init(&policy.entries, INITIAL_TABLE_SLOTS);
+
+    for (int food = 0; food < cells; food++) {
+      Body body;
+      start_body(&solver->board, &body, food);
+
+      if (!(body.occupied & 1u << food)) {
+        policy_visit(worker, &policy, body_key(&body), body_hash(&solver->board, &body));
+      }
+    }
+
+    size_t count = policy_sorted(&policy, &keys, &moves);
+    policy_export(export_path, &solver->board, keys, moves, count);
+    valid = policy_reaches_value(worker, keys, moves, count);
+
+    printf("policy: %zu states, %zu bytes in flash, written to %s\n", count, count * sizeof(uint64_t) + (count + 3) / 4, export_path);
+    printf("policy reaches the guaranteed length in game_step: %s\n", valid ? "yes" : "no");
+
+    free(keys);
+    free(moves);
+    table_free(&policy.moves);
+    table_free(&policy.entries);
+  }
+
+  return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}